@@ -50,6 +50,7 @@ static SymbolInfo * setSymbolInfo (TreeNode *t)
 
   if (t == NULL) return NULL;
   MALLOC(symbolInfo, sizeof(*symbolInfo));
+  memset(symbolInfo, 0, sizeof(*symbolInfo));
 
   switch (t->nodeKind)
     {
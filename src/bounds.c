@@ -0,0 +1,297 @@
+/****************************************************/
+/* File: bounds.c                                   */
+/* Array bounds checking for the C- compiler        */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "bounds.h"
+
+/* int _bound(int index, int length) */
+static SymbolInfo *boundSym;
+
+/* the checks of one length hoisted out of a loop */
+typedef struct
+{
+  int length;
+  int kMin, kMax;   /* smallest and largest offset from iv */
+} HoistedCheck;
+
+static HoistedCheck *groups;
+static int nGroups, capGroups;
+static int total;
+
+static TreeNode *boundsCheck(TreeNode *index, int length)
+{
+  TreeNode *call;
+
+  if (boundSym == NULL)
+    {
+      MALLOC(boundSym, sizeof(*boundSym));
+      memset(boundSym, 0, sizeof(*boundSym));
+      boundSym->nodeType = FuncT;
+      boundSym->attr.funcInfo.retType = IntT;
+      boundSym->attr.funcInfo.paramLen = 2;
+      MALLOC(boundSym->attr.funcInfo.paramTypeList, 2 * sizeof(ExpType));
+      boundSym->attr.funcInfo.paramTypeList[0] = IntT;
+      boundSym->attr.funcInfo.paramTypeList[1] = IntT;
+    }
+  call = newCallNode(newSymbolUseNode("_bound", boundSym),
+                     addSibling(index, newIntConstantNode(length)));
+  call->nodeType = IntT;
+  return call;
+}
+
+static void insertChecks(TreeNode *t)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **kids[3];
+      int i, n = treeChildren(t, kids);
+
+      for (i = 0; i < n; ++i)
+        insertChecks(*kids[i]);
+      if (t->nodeKind == ArrayK)
+        {
+          SymbolInfo *sym = t->attr.arr._var->symbolInfo;
+          if (!sym->attr.arrInfo.isParam && sym->attr.arrInfo.arrLen > 0)
+            t->attr.arr.arr_expr = boundsCheck(t->attr.arr.arr_expr, sym->attr.arrInfo.arrLen);
+        }
+    }
+}
+
+/* Procedure insertBoundsChecks checks the indexes of
+ * the arrays of known length in every function
+ */
+void insertBoundsChecks(TreeNode *syntaxTree)
+{
+  TreeNode *t;
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodeKind == FunctionDeclarationK)
+      insertChecks(t->attr.funcDecl.cmpd_stmt);
+}
+
+int isBoundsCheck(TreeNode *t)
+{
+  return t->nodeKind == CallK && !strcmp(t->attr.call._var->attr.ID, "_bound");
+}
+
+void removeBoundsCheck(TreeNode *check)
+{
+  TreeNode *sibling = check->sibling;
+  *check = *check->attr.call.expr_list;
+  check->sibling = sibling;
+}
+
+int countBoundsChecks(TreeNode *t)
+{
+  int count = 0;
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **kids[3];
+      int i, n = treeChildren(t, kids);
+
+      if (t->nodeKind == ArrayK && isBoundsCheck(t->attr.arr.arr_expr))
+        count++;
+      for (i = 0; i < n; ++i)
+        count += countBoundsChecks(*kids[i]);
+    }
+  return count;
+}
+
+static int hasReturn(TreeNode *t)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **kids[3];
+      int i, n = treeChildren(t, kids);
+
+      if (t->nodeKind == ReturnStatementK)
+        return TRUE;
+      for (i = 0; i < n; ++i)
+        if (hasReturn(*kids[i]))
+          return TRUE;
+    }
+  return FALSE;
+}
+
+/* TRUE if t calls a function (other than checks) */
+static int hasCall(TreeNode *t)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **kids[3];
+      int i, n = treeChildren(t, kids);
+
+      if (t->nodeKind == CallK && !isBoundsCheck(t))
+        return TRUE;
+      for (i = 0; i < n; ++i)
+        if (hasCall(*kids[i]))
+          return TRUE;
+    }
+  return FALSE;
+}
+
+static int isScalar(TreeNode *t)
+{
+  return t->nodeKind == VariableK && t->symbolInfo->nodeType == IntT;
+}
+
+/* Removes the checks of iv + k in an expression,
+ * recording k under the array length
+ */
+static void collectChecks(TreeNode *t, SymbolInfo *iv)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **kids[3];
+      int i, n = treeChildren(t, kids), k;
+
+      for (i = 0; i < n; ++i)
+        collectChecks(*kids[i], iv);
+      if (t->nodeKind == ArrayK && isBoundsCheck(t->attr.arr.arr_expr)
+          && indexOffset(t->attr.arr.arr_expr->attr.call.expr_list, iv, &k))
+        {
+          int length = t->attr.arr.arr_expr->attr.call.expr_list->sibling->attr.NUM;
+          for (i = 0; i < nGroups && groups[i].length != length; ++i)
+            ;
+          if (i == nGroups)
+            {
+              GROW(groups, nGroups, capGroups);
+              groups[nGroups].length = length;
+              groups[nGroups].kMin = groups[nGroups].kMax = k;
+              nGroups++;
+            }
+          if (k < groups[i].kMin) groups[i].kMin = k;
+          if (k > groups[i].kMax) groups[i].kMax = k;
+          removeBoundsCheck(t->attr.arr.arr_expr);
+          total++;
+        }
+    }
+}
+
+/* e + k, folded when e is a constant */
+static TreeNode *plus(TreeNode *e, int k)
+{
+  TreeNode *t;
+  if (e->nodeKind == ConstantK)
+    return newIntConstantNode(e->attr.NUM + k);
+  e = newSymbolUseNode(e->attr.ID, e->symbolInfo);
+  if (k == 0)
+    return e;
+  t = newAdditiveExpressionNode(e, newTokenTypeNode(k > 0 ? PLUS : MINUS),
+                                newIntConstantNode(k > 0 ? k : -k));
+  t->nodeType = IntT;
+  return t;
+}
+
+static TreeNode *checkStmt(TreeNode *index, int length)
+{
+  TreeNode *t = newExpressionStatementNode(boundsCheck(index, length));
+  t->nodeType = NoneT;
+  return t;
+}
+
+/* For the loop at *link when it is
+ *   while (iv < bound) { ...; iv = iv + 1; }
+ * (or <=), with neither iv nor bound assigned
+ * anywhere else in it and no return or call in it, puts
+ *   if (iv < bound) { _bound(iv + kMin, n); _bound(bound - 1 + kMax, n); }
+ * in front of it for the checks of iv + k in the
+ * expression statements of its body, which run in
+ * every iteration. Returns the link of the loop.
+ */
+static TreeNode **hoistLoop(TreeNode **link)
+{
+  TreeNode *loop = *link, *test = loop->attr.iterStmt.expr, *body = loop->attr.iterStmt.loop_stmt;
+  TreeNode *ivUse, *bound, *s, *last, *checks = NULL, *guard;
+  TokenType op;
+  int i, step;
+
+  if (test->nodeKind != ComparisonExpressionK)
+    return link;
+  op = test->attr.cmpExpr.op->attr.TOK;
+  ivUse = test->attr.cmpExpr.lexpr;
+  bound = test->attr.cmpExpr.rexpr;
+  if ((op != LT && op != LE) || !isScalar(ivUse)
+      || (bound->nodeKind != ConstantK
+          && (!isScalar(bound) || bound->symbolInfo == ivUse->symbolInfo)))
+    return link;
+  // without calls nothing the loop does before a failing
+  // check can be seen, so failing ahead of it is the same
+  if (body == NULL || body->nodeKind != CompoundStatementK
+      || body->attr.cmpdStmt.stmt_list == NULL || hasReturn(body) || hasCall(body))
+    return link;
+  if (bound->nodeKind == VariableK && assignsSymbol(body, bound->symbolInfo))
+    return link;
+  for (last = body->attr.cmpdStmt.stmt_list; last->sibling != NULL; last = last->sibling)
+    if (assignsSymbol(last, ivUse->symbolInfo))
+      return link;
+  if (!constantStep(last, ivUse->symbolInfo, &step) || step != 1)
+    return link;
+
+  nGroups = 0;
+  for (s = body->attr.cmpdStmt.stmt_list; s != last; s = s->sibling)
+    if (s->nodeKind == ExpressionStatementK)
+      collectChecks(s->attr.exprStmt.expr, ivUse->symbolInfo);
+  if (nGroups == 0)
+    return link;
+
+  // iv runs from its value here up to bound - 1 (or bound)
+  for (i = 0; i < nGroups; ++i)
+    {
+      checks = addSibling(checks, checkStmt(plus(ivUse, groups[i].kMin), groups[i].length));
+      checks = addSibling(checks, checkStmt(plus(bound, groups[i].kMax - (op == LT)),
+                                            groups[i].length));
+    }
+  checks = newCompoundStatementNode(NULL, checks);
+  checks->nodeType = NoneT;
+  test = newComparisonExpressionNode(plus(ivUse, 0), newTokenTypeNode(op), plus(bound, 0));
+  test->nodeType = IntT;
+  guard = newSelectionStatementNode(test, checks, NULL);
+  guard->nodeType = NoneT;
+  guard->sibling = loop;
+  *link = guard;
+  return &guard->sibling;
+}
+
+static void walkStmts(TreeNode **link)
+{
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          walkStmts(&t->attr.cmpdStmt.stmt_list);
+          break;
+        case SelectionStatementK:
+          walkStmts(&t->attr.selectStmt.if_stmt);
+          walkStmts(&t->attr.selectStmt.else_stmt);
+          break;
+        case IterationStatementK:
+          walkStmts(&t->attr.iterStmt.loop_stmt);
+          link = hoistLoop(link);
+          break;
+        default:
+          break;
+        }
+    }
+}
+
+int hoistBoundsChecks(TreeNode *func)
+{
+  total = 0;
+  walkStmts(&func->attr.funcDecl.cmpd_stmt);
+  return total;
+}
+
+void reportBoundsChecks(TreeNode *func, int before, int hoisted)
+{
+  int gone = before - countBoundsChecks(func->attr.funcDecl.cmpd_stmt);
+
+  if (TraceOptimize && before > 0)
+    fprintf(listing, "\nBounds checks in %s: %d of %d eliminated (%d%%), "
+            "%d of them hoisted out of loops\n",
+            func->attr.funcDecl._var->attr.ID, gone, before, 100 * gone / before, hoisted);
+}
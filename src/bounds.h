@@ -0,0 +1,48 @@
+/****************************************************/
+/* File: bounds.h                                   */
+/* Array bounds checking for the C- compiler        */
+/****************************************************/
+
+#ifndef _BOUNDS_H_
+#define _BOUNDS_H_
+
+/* Procedure insertBoundsChecks wraps the index of
+ * every access to an array of known length (not an
+ * array parameter) in a call of the _bound runtime
+ * check, which cgen expands inline: the index is
+ * passed through, and the program stops with an
+ * error if it is not below the length.
+ */
+void insertBoundsChecks(TreeNode *syntaxTree);
+
+/* Function isBoundsCheck returns TRUE if the node is
+ * a check made by insertBoundsChecks
+ */
+int isBoundsCheck(TreeNode *t);
+
+/* Procedure removeBoundsCheck replaces a check by
+ * the index it checks
+ */
+void removeBoundsCheck(TreeNode *check);
+
+/* Function countBoundsChecks returns the number of
+ * array accesses in the tree whose index is checked
+ */
+int countBoundsChecks(TreeNode *t);
+
+/* Function hoistBoundsChecks moves the checks of the
+ * indexes iv + k that every iteration of a counted
+ * loop without calls makes into one check of the
+ * first and the last index ahead of the loop.
+ * Returns the number of accesses left without a
+ * check.
+ */
+int hoistBoundsChecks(TreeNode *func);
+
+/* Procedure reportBoundsChecks reports to the
+ * listing how many of the given number of checks of
+ * a function are gone, when TraceOptimize is set
+ */
+void reportBoundsChecks(TreeNode *func, int before, int hoisted);
+
+#endif
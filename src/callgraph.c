@@ -0,0 +1,235 @@
+/****************************************************/
+/* File: callgraph.c                                */
+/* Call graph of a C- program, derived from the     */
+/* CallK nodes of the decorated syntax tree         */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "callgraph.h"
+
+static CallGraph graph;
+
+/* Function cgLookup returns the node of the function
+ * with the given symbol, or NULL (input/output)
+ */
+CgNode cgLookup(CallGraph cg, SymbolInfo *symbolInfo)
+{
+  int i;
+  for (i = 0; i < cg->nNodes; ++i)
+    if (cg->nodes[i]->symbolInfo == symbolInfo)
+      return cg->nodes[i];
+  return NULL;
+}
+
+static void collectCalls(CgNode caller, TreeNode *t, int loopDepth)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **slots[3];
+      int i, n = treeChildren(t, slots);
+
+      if (t->nodeKind == CallK)
+        {
+          CallSite site;
+          MALLOC(site, sizeof(*site));
+          site->call = t;
+          site->caller = caller;
+          site->callee = cgLookup(graph, t->attr.call._var->symbolInfo);
+          site->loopDepth = loopDepth;
+          GROW(caller->calls, caller->nCalls, caller->capCalls);
+          caller->calls[caller->nCalls++] = site;
+          if (site->callee != NULL)
+            {
+              GROW(site->callee->callers, site->callee->nCallers, site->callee->capCallers);
+              site->callee->callers[site->callee->nCallers++] = site;
+            }
+        }
+
+      for (i = 0; i < n; ++i)
+        collectCalls(caller, *slots[i],
+                     loopDepth + (t->nodeKind == IterationStatementK
+                                  && slots[i] == &t->attr.iterStmt.loop_stmt));
+    }
+}
+
+/* Function cgMayModify returns TRUE if a call to the
+ * node may assign the global scalar
+ */
+int cgMayModify(CgNode node, SymbolInfo *global)
+{
+  int i;
+  for (i = 0; i < node->nMods; ++i)
+    if (node->mods[i] == global)
+      return TRUE;
+  return FALSE;
+}
+
+static int addMod(CgNode node, SymbolInfo *global)
+{
+  if (cgMayModify(node, global))
+    return FALSE;
+  GROW(node->mods, node->nMods, node->capMods);
+  node->mods[node->nMods++] = global;
+  return TRUE;
+}
+
+/* Records the globals and arrays a function body
+ * assigns itself
+ */
+static void collectMods(CgNode node, TreeNode *t)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **slots[3];
+      int i, n = treeChildren(t, slots);
+
+      if (t->nodeKind == AssignExpressionK)
+        {
+          TreeNode *var = t->attr.assignStmt._var;
+          if (var->nodeKind == VariableK && var->symbolInfo->nodeType == IntT
+              && var->symbolInfo->attr.intInfo.globalFlag)
+            addMod(node, var->symbolInfo);
+          else if (var->nodeKind == ArrayK
+                   && (var->attr.arr._var->symbolInfo->attr.arrInfo.globalFlag
+                       || var->attr.arr._var->symbolInfo->attr.arrInfo.isParam))
+            node->storesArrays = TRUE;
+        }
+      else if (t->nodeKind == CallK && cgLookup(graph, t->attr.call._var->symbolInfo) == NULL
+               && t->attr.call._var->symbolInfo->attr.funcInfo.paramLen > 0
+               && t->attr.call._var->symbolInfo->attr.funcInfo.paramTypeList[0] == IntArrayT)
+        // a runtime routine storing through its first argument
+        node->storesArrays = TRUE;
+
+      for (i = 0; i < n; ++i)
+        collectMods(node, *slots[i]);
+    }
+}
+
+/* Tarjan's algorithm; marks the members of every
+ * cycle (including self calls) as recursive
+ */
+static void strongConnect(CgNode v, CgNode *stack, int *sp, int *counter)
+{
+  int i;
+  v->index = v->lowlink = (*counter)++;
+  stack[(*sp)++] = v;
+  v->onStack = TRUE;
+
+  for (i = 0; i < v->nCalls; ++i)
+    {
+      CgNode w = v->calls[i]->callee;
+      if (w == NULL)
+        continue;
+      if (w == v)
+        v->recursive = TRUE;
+      if (w->index < 0)
+        {
+          strongConnect(w, stack, sp, counter);
+          if (w->lowlink < v->lowlink)
+            v->lowlink = w->lowlink;
+        }
+      else if (w->onStack && w->index < v->lowlink)
+        v->lowlink = w->index;
+    }
+
+  if (v->lowlink == v->index)
+    {
+      CgNode w;
+      int size = 0;
+      int base = *sp;
+      do
+        {
+          w = stack[--base];
+          size++;
+        }
+      while (w != v);
+      while (*sp > base)
+        {
+          w = stack[--(*sp)];
+          w->onStack = FALSE;
+          if (size > 1)
+            w->recursive = TRUE;
+        }
+    }
+}
+
+/* Function cgBuild constructs the call graph of
+ * every function declared in the program
+ */
+CallGraph cgBuild(TreeNode *syntaxTree)
+{
+  TreeNode *t;
+  CgNode *stack;
+  int i, sp = 0, counter = 0, cap = 0, changed;
+
+  MALLOC(graph, sizeof(*graph));
+  graph->nNodes = 0;
+  graph->nodes = NULL;
+
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodeKind == FunctionDeclarationK)
+      {
+        CgNode node;
+        MALLOC(node, sizeof(*node));
+        memset(node, 0, sizeof(*node));
+        node->func = t;
+        node->symbolInfo = t->attr.funcDecl._var->symbolInfo;
+        node->index = -1;
+        GROW(graph->nodes, graph->nNodes, cap);
+        graph->nodes[graph->nNodes++] = node;
+      }
+
+  for (i = 0; i < graph->nNodes; ++i)
+    collectCalls(graph->nodes[i], graph->nodes[i]->func->attr.funcDecl.cmpd_stmt, 0);
+
+  MALLOC(stack, (graph->nNodes + 1) * sizeof(CgNode));
+  for (i = 0; i < graph->nNodes; ++i)
+    if (graph->nodes[i]->index < 0)
+      strongConnect(graph->nodes[i], stack, &sp, &counter);
+  free(stack);
+
+  // a call has the effects of everything its callee calls
+  for (i = 0; i < graph->nNodes; ++i)
+    collectMods(graph->nodes[i], graph->nodes[i]->func->attr.funcDecl.cmpd_stmt);
+  do
+    {
+      changed = FALSE;
+      for (i = 0; i < graph->nNodes; ++i)
+        {
+          CgNode v = graph->nodes[i];
+          int j, k;
+          for (j = 0; j < v->nCalls; ++j)
+            {
+              CgNode w = v->calls[j]->callee;
+              if (w == NULL)
+                continue;
+              for (k = 0; k < w->nMods; ++k)
+                changed |= addMod(v, w->mods[k]);
+              if (w->storesArrays && !v->storesArrays)
+                changed = v->storesArrays = TRUE;
+            }
+        }
+    }
+  while (changed);
+
+  return graph;
+}
+
+/* Procedure cgFree releases a graph built by cgBuild */
+void cgFree(CallGraph cg)
+{
+  int i, j;
+  if (cg == NULL) return;
+  for (i = 0; i < cg->nNodes; ++i)
+    {
+      for (j = 0; j < cg->nodes[i]->nCalls; ++j)
+        free(cg->nodes[i]->calls[j]);
+      free(cg->nodes[i]->calls);
+      free(cg->nodes[i]->callers);
+      free(cg->nodes[i]->mods);
+      free(cg->nodes[i]);
+    }
+  free(cg->nodes);
+  free(cg);
+}
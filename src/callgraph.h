@@ -0,0 +1,71 @@
+/****************************************************/
+/* File: callgraph.h                                */
+/* Call graph of a C- program, derived from the     */
+/* CallK nodes of the decorated syntax tree         */
+/****************************************************/
+
+#ifndef _CALLGRAPH_H_
+#define _CALLGRAPH_H_
+
+#include "globals.h"
+
+/* A CallK node and the functions on both ends.
+ * callee is NULL for the built-in input/output.
+ */
+typedef struct CallSiteRec
+{
+  TreeNode *call;
+  struct CgNodeRec *caller;
+  struct CgNodeRec *callee;
+  int loopDepth;          /* number of enclosing while loops */
+} * CallSite;
+
+typedef struct CgNodeRec
+{
+  TreeNode *func;         /* FunctionDeclarationK */
+  SymbolInfo *symbolInfo;
+
+  int nCalls, capCalls;
+  CallSite *calls;        /* call sites inside this function */
+
+  int nCallers, capCallers;
+  CallSite *callers;      /* call sites that reach this function */
+
+  int recursive;          /* TRUE if it can reach itself */
+
+  /* side effects, those of its callees included */
+  int nMods, capMods;
+  SymbolInfo **mods;      /* global scalars it may assign */
+  int storesArrays;       /* TRUE if it may store to a caller's or a global array */
+
+  int mark;               /* scratch flag for passes */
+
+  /* Tarjan's SCC bookkeeping */
+  int index, lowlink, onStack;
+} * CgNode;
+
+typedef struct CallGraphRec
+{
+  int nNodes;
+  CgNode *nodes;          /* in program order */
+} * CallGraph;
+
+/* Function cgBuild constructs the call graph of
+ * every function declared in the program
+ */
+CallGraph cgBuild(TreeNode *syntaxTree);
+
+/* Procedure cgFree releases a graph built by cgBuild */
+void cgFree(CallGraph cg);
+
+/* Function cgLookup returns the node of the function
+ * with the given symbol, or NULL (input/output)
+ */
+CgNode cgLookup(CallGraph cg, SymbolInfo *symbolInfo);
+
+/* Function cgMayModify returns TRUE if a call to the
+ * node may assign the global scalar
+ */
+int cgMayModify(CgNode node, SymbolInfo *global);
+
+#endif
@@ -0,0 +1,306 @@
+/****************************************************/
+/* File: cfg.c                                      */
+/* Per-function control-flow graph built from the   */
+/* decorated syntax tree of the C- compiler         */
+/****************************************************/
+
+#include "globals.h"
+#include "cfg.h"
+
+static CfgBlock newBlock(Cfg cfg)
+{
+  CfgBlock b;
+  MALLOC(b, sizeof(*b));
+  memset(b, 0, sizeof(*b));
+  b->id = cfg->nBlocks;
+  b->term = CfgJump;
+  GROW(cfg->blocks, cfg->nBlocks, cfg->capBlocks);
+  cfg->blocks[cfg->nBlocks++] = b;
+  return b;
+}
+
+static void addEdge(CfgBlock from, int slot, CfgBlock to)
+{
+  from->succ[slot] = to;
+  GROW(to->preds, to->nPreds, to->capPreds);
+  to->preds[to->nPreds++] = from;
+}
+
+static void jumpTo(CfgBlock from, CfgBlock to)
+{
+  from->term = CfgJump;
+  addEdge(from, 0, to);
+}
+
+static void addItem(CfgBlock b, TreeNode *expr, TreeNode *stmt)
+{
+  if (b->nItems >= b->capItems)
+    {
+      GROW(b->items, b->nItems, b->capItems);
+      REALLOC(b->itemStmts, b->capItems * sizeof(*b->itemStmts));
+    }
+  b->items[b->nItems] = expr;
+  b->itemStmts[b->nItems] = stmt;
+  b->nItems++;
+}
+
+static void addStmt(Cfg cfg, TreeNode *stmt, CfgBlock b)
+{
+  GROW(cfg->stmts, cfg->nStmts, cfg->capStmts);
+  cfg->stmts[cfg->nStmts].stmt = stmt;
+  cfg->stmts[cfg->nStmts].block = b;
+  cfg->nStmts++;
+}
+
+static void addVar(Cfg cfg, SymbolInfo *symbolInfo)
+{
+  if (symbolInfo == NULL || symbolInfo->nodeType != IntT)
+    return;
+  GROW(cfg->vars, cfg->nVars, cfg->capVars);
+  cfg->vars[cfg->nVars++] = symbolInfo;
+}
+
+/* Builds the statement list starting at t into the graph.
+ * Control enters at block cur; the returned block is where
+ * it continues after the last statement.
+ */
+static CfgBlock buildStmts(Cfg cfg, TreeNode *t, CfgBlock cur)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+        {
+          TreeNode *decl;
+          for (decl = t->attr.cmpdStmt.local_decl; decl != NULL; decl = decl->sibling)
+            if (decl->nodeKind == VariableDeclarationK)
+              addVar(cfg, decl->attr.varDecl._var->symbolInfo);
+          cur = buildStmts(cfg, t->attr.cmpdStmt.stmt_list, cur);
+          break;
+        }
+        case ExpressionStatementK:
+          addItem(cur, t->attr.exprStmt.expr, t);
+          addStmt(cfg, t, cur);
+          break;
+        case SelectionStatementK:
+        {
+          CfgBlock thenBlock = newBlock(cfg), join = newBlock(cfg);
+
+          cur->term = CfgBranch;
+          cur->cond = t->attr.selectStmt.expr;
+          cur->termStmt = t;
+          addStmt(cfg, t, cur);
+
+          addEdge(cur, 0, thenBlock);
+          jumpTo(buildStmts(cfg, t->attr.selectStmt.if_stmt, thenBlock), join);
+          if (t->attr.selectStmt.else_stmt != NULL)
+            {
+              CfgBlock elseBlock = newBlock(cfg);
+              addEdge(cur, 1, elseBlock);
+              jumpTo(buildStmts(cfg, t->attr.selectStmt.else_stmt, elseBlock), join);
+            }
+          else
+            addEdge(cur, 1, join);
+          cur = join;
+          break;
+        }
+        case IterationStatementK:
+        {
+          CfgBlock header = newBlock(cfg), body = newBlock(cfg), exit;
+
+          jumpTo(cur, header);
+          header->term = CfgBranch;
+          header->cond = t->attr.iterStmt.expr;
+          header->termStmt = t;
+          addStmt(cfg, t, header);
+
+          addEdge(header, 0, body);
+          jumpTo(buildStmts(cfg, t->attr.iterStmt.loop_stmt, body), header);
+          exit = newBlock(cfg);
+          addEdge(header, 1, exit);
+          cur = exit;
+          break;
+        }
+        case ReturnStatementK:
+          if (t->attr.retStmt.expr != NULL)
+            addItem(cur, t->attr.retStmt.expr, t);
+          cur->term = CfgReturn;
+          cur->termStmt = t;
+          addStmt(cfg, t, cur);
+          // anything after a return starts a block without predecessors
+          cur = newBlock(cfg);
+          break;
+        default:
+          DONT_OCCUR_PRINT;
+        }
+    }
+  return cur;
+}
+
+/* Function cfgBuild constructs the control-flow
+ * graph of a FunctionDeclarationK node
+ */
+Cfg cfgBuild(TreeNode *func)
+{
+  Cfg cfg;
+  TreeNode *param;
+  CfgBlock last;
+
+  MALLOC(cfg, sizeof(*cfg));
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->func = func;
+
+  for (param = func->attr.funcDecl.params; param != NULL; param = param->sibling)
+    if (param->nodeKind == VariableParameterK)
+      addVar(cfg, param->attr.varParam._var->symbolInfo);
+
+  last = buildStmts(cfg, func->attr.funcDecl.cmpd_stmt, newBlock(cfg));
+  // falling off the end of the body returns
+  last->term = CfgReturn;
+
+  return cfg;
+}
+
+/* Procedure cfgFree releases a graph built by cfgBuild */
+void cfgFree(Cfg cfg)
+{
+  int i;
+  if (cfg == NULL) return;
+  for (i = 0; i < cfg->nBlocks; ++i)
+    {
+      free(cfg->blocks[i]->items);
+      free(cfg->blocks[i]->itemStmts);
+      free(cfg->blocks[i]->preds);
+      free(cfg->blocks[i]);
+    }
+  free(cfg->blocks);
+  free(cfg->stmts);
+  free(cfg->vars);
+  free(cfg);
+}
+
+/* Function cfgVarIndex returns the index of a tracked
+ * scalar in cfg->vars, or -1 if it is not tracked
+ */
+int cfgVarIndex(Cfg cfg, SymbolInfo *symbolInfo)
+{
+  int i;
+  for (i = 0; i < cfg->nVars; ++i)
+    if (cfg->vars[i] == symbolInfo)
+      return i;
+  return -1;
+}
+
+/* Function cfgStmtBlock returns the block recorded
+ * for a statement, or NULL if it is not in the graph
+ */
+CfgBlock cfgStmtBlock(Cfg cfg, TreeNode *stmt)
+{
+  int i;
+  for (i = 0; i < cfg->nStmts; ++i)
+    if (cfg->stmts[i].stmt == stmt)
+      return cfg->stmts[i].block;
+  return NULL;
+}
+
+static void postorder(CfgBlock b, CfgBlock *order, int *n)
+{
+  int i;
+  if (b == NULL || b->mark)
+    return;
+  b->mark = TRUE;
+  if (b->term != CfgReturn)
+    for (i = 1; i >= 0; --i)
+      postorder(b->succ[i], order, n);
+  order[(*n)++] = b;
+}
+
+static CfgBlock intersect(CfgBlock a, CfgBlock b)
+{
+  while (a != b)
+    {
+      while (a->rpo > b->rpo) a = a->idom;
+      while (b->rpo > a->rpo) b = b->idom;
+    }
+  return a;
+}
+
+/* Procedure cfgDominators sets idom and rpo of every
+ * block (Cooper, Harvey and Kennedy's iterative scheme)
+ */
+void cfgDominators(Cfg cfg)
+{
+  CfgBlock *order, entry = cfg->blocks[0];
+  int i, j, n = 0, changed = TRUE;
+
+  MALLOC(order, (cfg->nBlocks + 1) * sizeof(CfgBlock));
+  for (i = 0; i < cfg->nBlocks; ++i)
+    {
+      cfg->blocks[i]->mark = FALSE;
+      cfg->blocks[i]->idom = NULL;
+      cfg->blocks[i]->rpo = -1;
+    }
+  postorder(entry, order, &n);
+  for (i = 0; i < n; ++i)
+    {
+      order[i]->rpo = n - 1 - i;
+      order[i]->mark = FALSE;
+    }
+
+  entry->idom = entry;
+  while (changed)
+    {
+      changed = FALSE;
+      for (i = n - 2; i >= 0; --i)
+        {
+          CfgBlock b = order[i], idom = NULL;
+          for (j = 0; j < b->nPreds; ++j)
+            {
+              CfgBlock p = b->preds[j];
+              if (p->rpo < 0 || p->idom == NULL)
+                continue;
+              idom = idom == NULL ? p : intersect(p, idom);
+            }
+          if (idom != b->idom)
+            {
+              b->idom = idom;
+              changed = TRUE;
+            }
+        }
+    }
+  entry->idom = NULL;
+  free(order);
+}
+
+/* Function cfgDominates returns TRUE if every path
+ * from the entry to block b passes through block a
+ */
+int cfgDominates(CfgBlock a, CfgBlock b)
+{
+  if (a->rpo < 0 || b->rpo < 0)
+    return FALSE;
+  for (; b != NULL; b = b->idom)
+    if (b == a)
+      return TRUE;
+  return FALSE;
+}
+
+/* Function cfgExprSlot returns the link in the tree
+ * holding the expression a block evaluates for a
+ * statement
+ */
+TreeNode **cfgExprSlot(TreeNode *stmt)
+{
+  switch (stmt->nodeKind)
+    {
+    case ExpressionStatementK: return &stmt->attr.exprStmt.expr;
+    case ReturnStatementK: return &stmt->attr.retStmt.expr;
+    case SelectionStatementK: return &stmt->attr.selectStmt.expr;
+    case IterationStatementK: return &stmt->attr.iterStmt.expr;
+    default:
+      DONT_OCCUR_PRINT;
+      return NULL;
+    }
+}
+
@@ -0,0 +1,110 @@
+/****************************************************/
+/* File: cfg.h                                      */
+/* Per-function control-flow graph built from the   */
+/* decorated syntax tree of the C- compiler         */
+/****************************************************/
+
+#ifndef _CFG_H_
+#define _CFG_H_
+
+#include "globals.h"
+
+/* How control leaves a basic block */
+typedef enum {
+    CfgJump,    /* falls/jumps to succ[0] */
+    CfgBranch,  /* cond != 0 goes to succ[0], otherwise succ[1] */
+    CfgReturn,  /* leaves the function */
+} CfgTermKind;
+
+/* A basic block is a run of expression statements
+ * evaluated in order. The items point into the
+ * syntax tree, so a pass that rewrites an item
+ * rewrites the program.
+ */
+typedef struct CfgBlockRec
+{
+  int id;
+
+  int nItems, capItems;
+  TreeNode **items;     /* expression roots, in evaluation order */
+  TreeNode **itemStmts; /* ExpressionStatementK / ReturnStatementK owning each item */
+
+  CfgTermKind term;
+  TreeNode *cond;       /* CfgBranch: condition expression */
+  TreeNode *termStmt;   /* SelectionStatementK / IterationStatementK / ReturnStatementK */
+
+  struct CfgBlockRec *succ[2];
+  int nPreds, capPreds;
+  struct CfgBlockRec **preds;
+
+  struct CfgBlockRec *idom; /* immediate dominator (cfgDominators) */
+  int rpo;              /* reverse postorder number, -1 if unreachable */
+
+  int mark;             /* scratch flag for passes */
+} * CfgBlock;
+
+/* Statements of the function body and the block
+ * that evaluates them (for a selection/iteration
+ * statement: the block that evaluates its condition)
+ */
+typedef struct CfgStmtRec
+{
+  TreeNode *stmt;
+  CfgBlock block;
+} CfgStmt;
+
+typedef struct CfgRec
+{
+  TreeNode *func;
+
+  int nBlocks, capBlocks;
+  CfgBlock *blocks;     /* blocks[0] is the entry block */
+
+  int nStmts, capStmts;
+  CfgStmt *stmts;
+
+  /* scalar parameters and locals of the function;
+   * these cannot be aliased in C-, so passes may
+   * track their values across the whole graph */
+  int nVars, capVars;
+  SymbolInfo **vars;
+} * Cfg;
+
+/* Function cfgBuild constructs the control-flow
+ * graph of a FunctionDeclarationK node
+ */
+Cfg cfgBuild(TreeNode *func);
+
+/* Procedure cfgFree releases a graph built by cfgBuild */
+void cfgFree(Cfg cfg);
+
+/* Function cfgVarIndex returns the index of a tracked
+ * scalar in cfg->vars, or -1 if it is not tracked
+ * (globals, arrays, functions)
+ */
+int cfgVarIndex(Cfg cfg, SymbolInfo *symbolInfo);
+
+/* Function cfgStmtBlock returns the block recorded
+ * for a statement, or NULL if it is not in the graph
+ */
+CfgBlock cfgStmtBlock(Cfg cfg, TreeNode *stmt);
+
+/* Procedure cfgDominators sets idom and rpo of every
+ * block; the entry and the blocks control cannot
+ * reach have no immediate dominator
+ */
+void cfgDominators(Cfg cfg);
+
+/* Function cfgDominates returns TRUE if every path
+ * from the entry to block b passes through block a
+ */
+int cfgDominates(CfgBlock a, CfgBlock b);
+
+/* Function cfgExprSlot returns the link in the tree
+ * holding the expression a block evaluates for a
+ * statement (its value, return value or condition),
+ * so a pass can replace that expression
+ */
+TreeNode **cfgExprSlot(TreeNode *stmt);
+
+#endif
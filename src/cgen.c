@@ -1,143 +1,601 @@
 #include "globals.h"
+#include "util.h"
 #include "cgen.h"
+#include "lir.h"
+#include "regalloc.h"
 #include <string.h>
+#include <limits.h>
 
 static int regSize = 4;
 
-static int globalMemAlloc(int);
+static void layoutGlobals(TreeNode *, FILE *);
+static const char *globalLabel(SymbolInfo *);
 static int labelAlloc(void);
-static int localCodeGen(TreeNode *, FILE *, int, int);
+static const char *labelName(int);
+static int localCodeGen(TreeNode *, int, int);
+static int exprCodeGen(TreeNode *);
+static int argRegister(int);
+static void pushArguments(TreeNode *, int *);
+static int isTailCallable(TreeNode *);
+static void emitFunction(FILE *, const char *);
+static void emitRuntime(FILE *);
+static LirInstr *emit(LirKind, const char *, int, int, int, int, const char *);
+static int symbolReg(SymbolInfo *);
+static int refersTo(TreeNode *, SymbolInfo *);
+static int keepValue(int, TreeNode *);
 
 static int L_cleanup;
+static int paramSize; // bytes of parameters of the current function
+static int usesFill, usesCopy, usesBound; // runtime routines called by the module
+static int localBytes, outBytes; // local arrays and outgoing arguments of the current function
+
+// Function bodies are generated into an instruction list over
+// virtual registers, which allocateRegisters then maps onto
+// the machine registers
+static Lir lir;
+static struct { SymbolInfo *sym; int reg; } *symRegs; // register of each scalar
+static int nSymRegs, capSymRegs;
 
 // Global decls
 void codeGen(TreeNode *syntaxTree, FILE *codeStream)
 {
-  int i;
   TreeNode *t;
 
   fprintf(codeStream, ".data\n");
   fprintf(codeStream, "newline: .asciiz \"\\n\"\n");
   fprintf(codeStream, "output_str: .asciiz \"Output : \"\n");
   fprintf(codeStream, "input_str: .asciiz \"Input : \"\n");
-
+  if (BoundsCheck)
+    fprintf(codeStream, "bound_str: .asciiz \"Error : array index out of bounds\\n\"\n");
+  layoutGlobals(syntaxTree, codeStream);
 
   fprintf(codeStream, "\n.text\n");
   for(t = syntaxTree;
       t != NULL;
       t = t->sibling)
     {
-      if(t->nodeKind == VariableDeclarationK)
-        {
-          t->attr.varDecl._var->symbolInfo->attr.intInfo.memloc = globalMemAlloc(sizeof(int));
-          t->attr.varDecl._var->symbolInfo->attr.intInfo.globalFlag = TRUE;
-        }
-      else if(t->nodeKind == ArrayDeclarationK)
-        {
-          t->attr.arrDecl._var->symbolInfo->attr.arrInfo.memloc =
-            globalMemAlloc(sizeof(int) * t->attr.arrDecl._var->symbolInfo->attr.arrInfo.arrLen);
-          t->attr.arrDecl._var->symbolInfo->attr.arrInfo.globalFlag = TRUE;
-        }
+      if(t->nodeKind == VariableDeclarationK || t->nodeKind == ArrayDeclarationK)
+        continue;
       else if(t->nodeKind == FunctionDeclarationK)
         {
-          // Function labeling
-          fprintf(codeStream, "# Function declaration\n");
-          fprintf(codeStream, "%s:\n", t->attr.funcDecl._var->attr.ID);
-
-          // Function parameter's total memory
+          // Function parameter's total memory on the stack
           TreeNode *param;
-          int accLoc = 0;
-          for(param = t->attr.funcDecl.params;
+          int accLoc = 0, n;
+          for(param = t->attr.funcDecl.params, n = 0;
               param != NULL;
-              param = param->sibling)
+              param = param->sibling, n++)
             {
               TreeNode *var = param->attr.funcDecl._var;
+              if(argRegister(n) >= 0)
+                continue;
               if(var->symbolInfo->nodeType == IntT)
                 accLoc += sizeof(int);
               else if(var->nodeType == IntArrayT)
                 accLoc += regSize;
             }
 
+          paramSize = accLoc;
+          lir = lirNew();
+          nSymRegs = 0;
+          localBytes = outBytes = 0;
+
           // real location
           // ex. f(a, b, c)
           // a: 8(fp), b: 4(fp), c:0(fp)
           // pushed early <--> pushed late
-          for(param = t->attr.funcDecl.params;
+          // (with RegisterArgs the first four come in $a0-$a3
+          // and only the rest are on the stack)
+          // the parameters read are moved into registers on entry
+          lirEmit(lir, LirComment, NULL, -1, -1, -1, 0, "\n# Load parameters");
+          for(param = t->attr.funcDecl.params, n = 0;
               param != NULL;
-              param = param->sibling)
+              param = param->sibling, n++)
             {
+              SymbolInfo *sym;
+              int size;
               switch(param->nodeType)
                 {
                 case VariableParameterK:
-                  accLoc -= sizeof(int);
-                  param->attr.varParam._var->symbolInfo->attr.intInfo.memloc = accLoc;
+                  size = sizeof(int);
+                  sym = param->attr.varParam._var->symbolInfo;
                   break;
                 case ArrayParameterK:
-                  accLoc -= regSize;
-                  // TODO:
-                  param->attr.arrParam._var->symbolInfo->attr.arrInfo.memloc = accLoc;
+                  size = regSize;
+                  sym = param->attr.arrParam._var->symbolInfo;
                   break;
                 default:
                   DONT_OCCUR_PRINT;
                 }
+              if(argRegister(n) >= 0)
+                {
+                  if(refersTo(t->attr.funcDecl.cmpd_stmt, sym))
+                    lirEmit(lir, LirRR, "move", symbolReg(sym), argRegister(n), -1, 0, NULL);
+                  continue;
+                }
+              accLoc -= size;
+              sym->attr.intInfo.memloc = accLoc;
+              if(refersTo(t->attr.funcDecl.cmpd_stmt, sym))
+                lirEmit(lir, LirLoad, "lw", symbolReg(sym), REG_FP, -1, accLoc, NULL);
             }
 
-          // allocate stack
-          fprintf(codeStream, "\n# Allocate stack\n");
-          fprintf(codeStream, "addiu $sp, $sp, %d\n", -10 * regSize);
+          L_cleanup = labelAlloc();
+
+          // cmpd statement generation
+          lirEmit(lir, LirComment, NULL, -1, -1, -1, 0, "\n# Compound statement for function");
+          int updateStack = localCodeGen(t->attr.funcDecl.cmpd_stmt, 0, 1);
+          if(updateStack != 0)
+            DONT_OCCUR_PRINT;
+          allocateRegisters(lir);
+
+          // Function labeling
+          fprintf(codeStream, "# Function declaration\n");
+          emitFunction(codeStream, t->attr.funcDecl._var->attr.ID);
+          lirFree(lir);
+          lir = NULL;
+        }
+      else
+        DONT_OCCUR_PRINT;
+    }
+
+  emitRuntime(codeStream);
+}
+
+#define BIT(r) (1u << (r))
+#define SAVED_REGS (0xffu << REG_S0) // $s0-$s7
+
+// TRUE if an instruction uses one of the registers
+static int usesRegister(LirInstr *in, unsigned regs)
+{
+  return (in->dst >= 0 && (regs & BIT(in->dst)))
+    || (in->src[0] >= 0 && (regs & BIT(in->src[0])))
+    || (in->src[1] >= 0 && (regs & BIT(in->src[1])));
+}
+
+// The position of a label of the body, -1 if it is elsewhere
+static int labelIndex(const char *label)
+{
+  int i;
+  for(i = 0; i < lir->n; ++i)
+    if(lir->code[i].kind == LirLabel && !strcmp(lir->code[i].label, label))
+      return i;
+  return -1;
+}
+
+// The registers saved in the frame, at its top
+static int saved[9], nSaved, frameBytes;
+
+static void restoreFrame(FILE *codeStream)
+{
+  int k;
+  if(frameBytes == 0)
+    return;
+  for(k = 0; k < nSaved; ++k)
+    fprintf(codeStream, "lw %s, %d($sp)\n", lirRegName(saved[k]), frameBytes - (k + 1) * regSize);
+  fprintf(codeStream, "addiu $sp, $sp, %d\n", frameBytes);
+}
+
+// Writes a function from its allocated body. The frame is
+// laid out once: from the $sp on entry down, the registers
+// saved, the spill slots, the local arrays and the outgoing
+// arguments, allocated by one $sp adjustment. $sp does not
+// move in the body, so everything is addressed from it at
+// fixed offsets; the body's $fp offsets are rewritten to $sp
+// ones. Only the $s registers the body uses are saved, and
+// $ra only if it calls. Shrink-wrapping: the frame is set up
+// after the longest entry part of the body that does not
+// need it, so returns from that part skip it; tail calls
+// leave the frame before they jump.
+static void emitFunction(FILE *codeStream, const char *name)
+{
+  unsigned sRegs = lir->usedRegs & SAVED_REGS, frameRegs;
+  int saveBytes, split, changed, earlyLabel = -1, last, calls = FALSE, i, k;
+  char cleanup[16];
+
+  strcpy(cleanup, labelName(L_cleanup));
+  nSaved = 0;
+  for(i = 0; i < lir->n; ++i)
+    if(lir->code[i].kind == LirCall)
+      calls = TRUE;
+  if(calls)
+    saved[nSaved++] = REG_RA;
+  for(k = REG_S0; k < REG_S0 + 8; ++k)
+    if(sRegs & BIT(k))
+      saved[nSaved++] = k;
+  saveBytes = nSaved * regSize;
+  frameBytes = saveBytes + lir->spillBytes + localBytes + outBytes;
+
+  // place the frame areas; $fp is $sp + frameBytes
+  for(i = 0; i < lir->n; ++i)
+    {
+      LirInstr *in = &lir->code[i];
+      if(in->area == FrameSpill)
+        in->imm -= saveBytes;
+      else if(in->area == FrameLocal)
+        in->imm -= saveBytes + lir->spillBytes;
+      if(((in->kind == LirLoad || in->kind == LirRRI) && in->src[0] == REG_FP)
+         || (in->kind == LirStore && in->src[1] == REG_FP))
+        {
+          if(in->kind == LirStore)
+            in->src[1] = REG_SP;
+          else
+            in->src[0] = REG_SP;
+          in->imm += frameBytes;
+        }
+    }
+
+  // the entry part: no calls, no saved register or frame
+  // slot, and no branch between it and the rest but into the
+  // start of the rest
+  frameRegs = sRegs | BIT(REG_SP);
+  for(split = 0; split < lir->n; ++split)
+    if(lir->code[split].kind == LirCall || usesRegister(&lir->code[split], frameRegs))
+      break;
+  do
+    {
+      changed = FALSE;
+      for(i = 0; i < lir->n; ++i)
+        {
+          LirInstr *in = &lir->code[i];
+          int target = in->kind == LirBranch || in->kind == LirJump ? labelIndex(in->label) : -1;
+          if(target < 0)
+            continue;
+          if(i < split && target >= split)
+            split = i, changed = TRUE;
+          else if(i >= split && target < split)
+            split = target, changed = TRUE;
+        }
+    }
+  while(changed);
+
+  // a jump to the epilogue right before it is left out
+  for(last = lir->n - 1; last >= 0 && lir->code[last].kind == LirComment; --last)
+    ;
+  if(last >= 0 && !(lir->code[last].kind == LirJump && !strcmp(lir->code[last].label, cleanup)))
+    last = -1;
 
-          // save register $fp
+  fprintf(codeStream, "%s:\n", name);
+  for(i = 0; i <= lir->n; ++i)
+    {
+      LirInstr *in = &lir->code[i];
+
+      if(i == split && frameBytes > 0)
+        {
+          fprintf(codeStream, "\n# Allocate stack\n");
+          fprintf(codeStream, "addiu $sp, $sp, %d\n", -frameBytes);
           fprintf(codeStream, "# Save registers\n");
-          fprintf(codeStream, "sw $fp, %d($sp)\n", 0 * regSize);
-          // save registers $s0~$s7
-          for(i=0; i<8; ++i)
-            fprintf(codeStream, "sw $s%d, %d($sp)\n", i, (i+1) * regSize);
-          // save register $ra
-          fprintf(codeStream, "sw $ra, %d($sp)\n", 9 * regSize);
+          for(k = 0; k < nSaved; ++k)
+            fprintf(codeStream, "sw %s, %d($sp)\n", lirRegName(saved[k]), frameBytes - (k + 1) * regSize);
+        }
+      if(i == lir->n)
+        break;
+      if(i == last)
+        continue;
+      if(i < split && (in->kind == LirJump || in->kind == LirBranch)
+         && !strcmp(in->label, cleanup))
+        {
+          // a return before the frame is set up
+          if(in->kind == LirJump)
+            {
+              fprintf(codeStream, "jr $ra\n");
+              continue;
+            }
+          if(earlyLabel < 0)
+            earlyLabel = labelAlloc();
+          free(in->label);
+          in->label = copyString(labelName(earlyLabel));
+        }
+      if(in->kind == LirTailCall && i >= split)
+        restoreFrame(codeStream);
+      lirPrintInstr(in, codeStream);
+    }
 
-          // set frame
-          fprintf(codeStream, "addiu $fp, $sp, %d\n", 10 * regSize);
+  // cleanup for function with no return
+  fprintf(codeStream, "\n# Stack cleanup\n");
+  fprintf(codeStream, "%s:\n", cleanup);
+  restoreFrame(codeStream);
 
-          L_cleanup = labelAlloc();
+  // return
+  fprintf(codeStream, "\n# Return to caller\n");
+  fprintf(codeStream, "jr $ra\n\n");
+  if(earlyLabel >= 0)
+    fprintf(codeStream, "%s:\njr $ra\n\n", labelName(earlyLabel));
+}
 
-          // cmpd statement generation
-          fprintf(codeStream, "\n# Compound statement for function\n");
-          int updateStack = localCodeGen(t->attr.funcDecl.cmpd_stmt, codeStream, 10 * regSize, 1);
-          if(updateStack != 10 * regSize)
-            DONT_OCCUR_PRINT;
+// The fill and copy loops recognized by the optimizer call
+// these leaf routines; failed bounds checks jump to the last.
+// Arguments come as for any call, in $a0-$a2 or on the
+// stack; they use only those and $t registers and keep no
+// frame. Both store one word after another in ascending
+// order, eight words per iteration after the odd ones.
+static void emitRuntime(FILE *codeStream)
+{
+  if (usesFill)
+    {
+      // _fill(addr, n, v)
+      const char *addr = RegisterArgs ? "$a0" : "$t0";
+      const char *n = RegisterArgs ? "$a1" : "$t2";
+      const char *v = RegisterArgs ? "$a2" : "$t1";
+      fprintf(codeStream, "# Runtime: fill words\n");
+      fprintf(codeStream, "_fill:\n");
+      if (!RegisterArgs)
+        {
+          fprintf(codeStream, "lw $t0, 8($sp)\n");
+          fprintf(codeStream, "lw $t2, 4($sp)\n");
+          fprintf(codeStream, "lw $t1, 0($sp)\n");
+        }
+      fprintf(codeStream, "blez %s, _fill_done\n", n);
+      fprintf(codeStream, "andi $t3, %s, 7\n", n);
+      fprintf(codeStream, "beqz $t3, _fill_blocks\n");
+      fprintf(codeStream, "_fill_one:\n");
+      fprintf(codeStream, "sw %s, 0(%s)\n", v, addr);
+      fprintf(codeStream, "addiu %s, %s, 4\n", addr, addr);
+      fprintf(codeStream, "addiu $t3, $t3, -1\n");
+      fprintf(codeStream, "bnez $t3, _fill_one\n");
+      fprintf(codeStream, "_fill_blocks:\n");
+      fprintf(codeStream, "srl %s, %s, 3\n", n, n);
+      fprintf(codeStream, "beqz %s, _fill_done\n", n);
+      fprintf(codeStream, "_fill_block:\n");
+      fprintf(codeStream, "sw %s, 0(%s)\n", v, addr);
+      fprintf(codeStream, "sw %s, 4(%s)\n", v, addr);
+      fprintf(codeStream, "sw %s, 8(%s)\n", v, addr);
+      fprintf(codeStream, "sw %s, 12(%s)\n", v, addr);
+      fprintf(codeStream, "sw %s, 16(%s)\n", v, addr);
+      fprintf(codeStream, "sw %s, 20(%s)\n", v, addr);
+      fprintf(codeStream, "sw %s, 24(%s)\n", v, addr);
+      fprintf(codeStream, "sw %s, 28(%s)\n", v, addr);
+      fprintf(codeStream, "addiu %s, %s, 32\n", addr, addr);
+      fprintf(codeStream, "addiu %s, %s, -1\n", n, n);
+      fprintf(codeStream, "bnez %s, _fill_block\n", n);
+      fprintf(codeStream, "_fill_done:\n");
+      fprintf(codeStream, "jr $ra\n\n");
+    }
+  if (usesCopy)
+    {
+      int i;
+      // _copy(dst, src, n)
+      const char *dst = RegisterArgs ? "$a0" : "$t0";
+      const char *src = RegisterArgs ? "$a1" : "$t1";
+      const char *n = RegisterArgs ? "$a2" : "$t2";
+      fprintf(codeStream, "# Runtime: copy words\n");
+      fprintf(codeStream, "_copy:\n");
+      if (!RegisterArgs)
+        {
+          fprintf(codeStream, "lw $t0, 8($sp)\n");
+          fprintf(codeStream, "lw $t1, 4($sp)\n");
+          fprintf(codeStream, "lw $t2, 0($sp)\n");
+        }
+      fprintf(codeStream, "blez %s, _copy_done\n", n);
+      fprintf(codeStream, "andi $t3, %s, 7\n", n);
+      fprintf(codeStream, "beqz $t3, _copy_blocks\n");
+      fprintf(codeStream, "_copy_one:\n");
+      fprintf(codeStream, "lw $t4, 0(%s)\n", src);
+      fprintf(codeStream, "sw $t4, 0(%s)\n", dst);
+      fprintf(codeStream, "addiu %s, %s, 4\n", src, src);
+      fprintf(codeStream, "addiu %s, %s, 4\n", dst, dst);
+      fprintf(codeStream, "addiu $t3, $t3, -1\n");
+      fprintf(codeStream, "bnez $t3, _copy_one\n");
+      fprintf(codeStream, "_copy_blocks:\n");
+      fprintf(codeStream, "srl %s, %s, 3\n", n, n);
+      fprintf(codeStream, "beqz %s, _copy_done\n", n);
+      fprintf(codeStream, "_copy_block:\n");
+      // each word is stored before the next is loaded, as the
+      // loop did, in case the arrays overlap
+      for (i = 0; i < 8; ++i)
+        {
+          fprintf(codeStream, "lw $t4, %d(%s)\n", i * regSize, src);
+          fprintf(codeStream, "sw $t4, %d(%s)\n", i * regSize, dst);
+        }
+      fprintf(codeStream, "addiu %s, %s, 32\n", src, src);
+      fprintf(codeStream, "addiu %s, %s, 32\n", dst, dst);
+      fprintf(codeStream, "addiu %s, %s, -1\n", n, n);
+      fprintf(codeStream, "bnez %s, _copy_block\n", n);
+      fprintf(codeStream, "_copy_done:\n");
+      fprintf(codeStream, "jr $ra\n\n");
+    }
 
-          // cleanup for function with no return
-          fprintf(codeStream, "\n# Stack cleanup\n");
-          fprintf(codeStream, "L%d:\n", L_cleanup);
+  if (usesBound)
+    {
+      // a failed bounds check stops the program
+      fprintf(codeStream, "# Runtime: index out of bounds\n");
+      fprintf(codeStream, "_bound_fail:\n");
+      fprintf(codeStream, "li $v0, 4\n");
+      fprintf(codeStream, "la $a0, bound_str\n");
+      fprintf(codeStream, "syscall\n");
+      fprintf(codeStream, "li $v0, 10\n");
+      fprintf(codeStream, "syscall\n\n");
+    }
+}
 
-          // cleanup remained local stack.
-          fprintf(codeStream, "addiu $sp, $fp, %d\n", -10 * regSize);
+// The small data area: 64K bytes from $gp - 32768 (SPIM's
+// .extern area at 0x10000000), where any byte is one
+// instruction away at an offset from $gp
+#define GP_AREA_START (-0x8000)
+#define GP_AREA_BYTES 0x10000
 
-          // load registers
-          fprintf(codeStream, "lw $fp, %d($sp)\n", 0 * regSize);
-          // load registers $s0~$s7
-          for(i=0; i<8; ++i)
-            fprintf(codeStream, "lw $s%d, %d($sp)\n", i, (i+1) * regSize);
-          // load register $ra
-          fprintf(codeStream, "lw $ra, %d($sp)\n", 9 * regSize);
-          fprintf(codeStream, "addiu $sp, $sp, %d\n", 10 * regSize);
+static struct { SymbolInfo *sym; const char *name; int size, weight; char *label; } *globals;
+static int nGlobals, capGlobals;
 
-          // return
-          fprintf(codeStream, "\n# Return to caller\n");
-          fprintf(codeStream, "jr $ra\n\n");
+// Weighs the uses of globals in a tree, eight times more
+// for each loop around them
+static void countGlobalUses(TreeNode *t, int weight)
+{
+  for(; t != NULL; t = t->sibling)
+    {
+      TreeNode **slots[3];
+      int i, n = treeChildren(t, slots);
+
+      if(t->nodeKind == VariableK)
+        for(i = 0; i < nGlobals; ++i)
+          if(globals[i].sym == t->symbolInfo)
+            globals[i].weight += weight;
+      for(i = 0; i < n; ++i)
+        countGlobalUses(*slots[i], t->nodeKind == IterationStatementK && weight < (1 << 12)
+                                   ? weight * 8 : weight);
+    }
+}
+
+// TRUE if global a goes before global b: more uses per byte,
+// then declaration order
+static int hotterGlobal(int a, int b)
+{
+  long long wa = (long long) globals[a].weight * globals[b].size;
+  long long wb = (long long) globals[b].weight * globals[a].size;
+  return wa != wb ? wa > wb : a < b;
+}
+
+// Lays out the globals of the module and declares them in
+// .data. The most used per byte go into the small data area
+// in that order, their memloc the offset from $gp; those
+// that do not fit are .data labels, zeroed by .space (SPIM
+// has no .bss).
+static void layoutGlobals(TreeNode *syntaxTree, FILE *codeStream)
+{
+  TreeNode *t;
+  int *order, off = GP_AREA_START, i, j;
+
+  nGlobals = 0;
+  for(t = syntaxTree; t != NULL; t = t->sibling)
+    {
+      SymbolInfo *sym;
+      if(t->nodeKind != VariableDeclarationK && t->nodeKind != ArrayDeclarationK)
+        continue;
+      GROW(globals, nGlobals, capGlobals);
+      if(t->nodeKind == VariableDeclarationK)
+        {
+          sym = t->attr.varDecl._var->symbolInfo;
+          sym->attr.intInfo.globalFlag = TRUE;
+          globals[nGlobals].name = t->attr.varDecl._var->attr.ID;
+          globals[nGlobals].size = sizeof(int);
         }
       else
-        DONT_OCCUR_PRINT;
+        {
+          sym = t->attr.arrDecl._var->symbolInfo;
+          sym->attr.arrInfo.globalFlag = TRUE;
+          globals[nGlobals].name = t->attr.arrDecl._var->attr.ID;
+          globals[nGlobals].size = sizeof(int) * sym->attr.arrInfo.arrLen;
+        }
+      globals[nGlobals].sym = sym;
+      globals[nGlobals].weight = 0;
+      globals[nGlobals].label = NULL;
+      nGlobals++;
     }
+  if(nGlobals == 0)
+    return;
+  for(t = syntaxTree; t != NULL; t = t->sibling)
+    if(t->nodeKind == FunctionDeclarationK)
+      countGlobalUses(t->attr.funcDecl.cmpd_stmt, 1);
+
+  MALLOC(order, nGlobals * sizeof(int));
+  for(i = 0; i < nGlobals; ++i)
+    {
+      for(j = i; j > 0 && hotterGlobal(i, order[j - 1]); --j)
+        order[j] = order[j - 1];
+      order[j] = i;
+    }
+
+  fprintf(codeStream, "\n# Globals: the small data area from $gp - 32768, most used first\n");
+  for(i = 0; i < nGlobals; ++i)
+    {
+      int g = order[i];
+      SymbolInfo *sym = globals[g].sym;
+      char label[64];
+
+      // names have letters only, so g_ cannot clash with a runtime label
+      snprintf(label, sizeof(label), "g_%s", globals[g].name);
+      if(off + globals[g].size <= GP_AREA_START + GP_AREA_BYTES)
+        {
+          fprintf(codeStream, ".extern %s %d\n", label, globals[g].size);
+          if(sym->nodeType == IntT)
+            sym->attr.intInfo.memloc = off;
+          else
+            sym->attr.arrInfo.memloc = off;
+          off += globals[g].size;
+        }
+      else
+        globals[g].label = copyString(label);
+    }
+  for(i = 0; i < nGlobals; ++i)
+    if(globals[order[i]].label != NULL)
+      fprintf(codeStream, ".align 2\n%s: .space %d\n",
+              globals[order[i]].label, globals[order[i]].size);
+  free(order);
+}
+
+// The .data label of a global outside the small data area,
+// NULL for one at an offset from $gp
+static const char *globalLabel(SymbolInfo *sym)
+{
+  int i;
+  for(i = 0; i < nGlobals; ++i)
+    if(globals[i].sym == sym)
+      return globals[i].label;
+  DONT_OCCUR_PRINT;
+  return NULL;
 }
 
-// Global memory always starts with 0x10000000
-static int globalMemAlloc(int size)
+// The register an argument is passed in, or -1 if it is
+// passed on the stack
+static int argRegister(int i)
 {
-  if (size <= 0) DONT_OCCUR_PRINT;
-  static int addr = 0x10000000;
-  addr += size;
-  return addr-size;
+  return RegisterArgs && i < 4 ? REG_A0 + i : -1;
+}
+
+// Evaluates the arguments of a call, first to last. Those
+// passed on the stack are stored in the outgoing area at the
+// bottom of the frame, first argument highest, and the
+// others are moved into $a0-$a3; both after all of them are
+// evaluated, so that a call among the arguments cannot
+// overwrite them. Sets nRegArgs to the number in registers.
+static void pushArguments(TreeNode *call, int *nRegArgs)
+{
+  TreeNode *expr;
+  int *args = NULL, nArgs = 0, capArgs = 0, off = 0, i;
+  for(expr = call->attr.call.expr_list; expr != NULL; expr = expr->sibling)
+    {
+      TreeNode *later;
+      int v = exprCodeGen(expr);
+      for(later = expr->sibling; later != NULL; later = later->sibling)
+        v = keepValue(v, later);
+      GROW(args, nArgs, capArgs);
+      args[nArgs++] = v;
+    }
+  for(i = nArgs - 1; i >= 0 && argRegister(i) < 0; --i, off += regSize)
+    emit(LirStore, "sw", -1, args[i], REG_SP, off, NULL);
+  if(off > outBytes)
+    outBytes = off;
+  for(*nRegArgs = 0; *nRegArgs < nArgs && argRegister(*nRegArgs) >= 0; ++*nRegArgs)
+    emit(LirRR, "move", argRegister(*nRegArgs), args[*nRegArgs], -1, 0, NULL);
+  free(args);
+}
+
+// A returned call can reuse the frame when its stack
+// arguments fit in our parameter slots and none of them points into the
+// locals the callee is about to overwrite
+static int isTailCallable(TreeNode *expr)
+{
+  TreeNode *arg;
+  SymbolInfo *callee;
+  int size = 0, i;
+
+  if(expr == NULL || expr->nodeKind != CallK)
+    return FALSE;
+  if(!strcmp(expr->attr.call._var->attr.ID, "input")
+     || !strcmp(expr->attr.call._var->attr.ID, "output"))
+    return FALSE;
+
+  callee = expr->attr.call._var->symbolInfo;
+  for(i = 0; i < callee->attr.funcInfo.paramLen; ++i)
+    if(argRegister(i) < 0)
+      size += callee->attr.funcInfo.paramTypeList[i] == IntT ? (int) sizeof(int) : regSize;
+  if(size > paramSize)
+    return FALSE;
+
+  for(arg = expr->attr.call.expr_list; arg != NULL; arg = arg->sibling)
+    if(arg->nodeType == IntArrayT
+       && !arg->symbolInfo->attr.arrInfo.isParam
+       && !arg->symbolInfo->attr.arrInfo.globalFlag)
+      return FALSE;
+  return TRUE;
 }
 
 // Label generator
@@ -147,8 +605,579 @@ static int labelAlloc(void)
   return label++;
 }
 
-// Local decls
-static int localCodeGen(TreeNode *syntaxTree, FILE *codeStream, int currStack, int travSibling)
+static const char *labelName(int label)
+{
+  static char name[16];
+  sprintf(name, "L%d", label);
+  return name;
+}
+
+static LirInstr *emit(LirKind kind, const char *op, int dst, int src0, int src1,
+                      int imm, const char *label)
+{
+  return lirEmit(lir, kind, op, dst, src0, src1, imm, label);
+}
+
+static void comment(const char *text)
+{
+  emit(LirComment, NULL, -1, -1, -1, 0, text);
+}
+
+// Scalars and pointers of the function (parameters, locals
+// and the optimizer's temporaries) live in registers; arrays
+// and globals stay in memory
+static int inRegister(SymbolInfo *sym)
+{
+  if(sym->nodeType == IntT)
+    return !sym->attr.intInfo.globalFlag;
+  return sym->nodeType == IntArrayT && sym->attr.arrInfo.isParam
+    && !sym->attr.arrInfo.globalFlag;
+}
+
+// The virtual register of a symbol in a register
+static int symbolReg(SymbolInfo *sym)
+{
+  int i;
+  for(i = 0; i < nSymRegs; ++i)
+    if(symRegs[i].sym == sym)
+      return symRegs[i].reg;
+  GROW(symRegs, nSymRegs, capSymRegs);
+  symRegs[nSymRegs].sym = sym;
+  symRegs[nSymRegs].reg = lirReg(lir);
+  return symRegs[nSymRegs++].reg;
+}
+
+static int isSymbolReg(int reg)
+{
+  int i;
+  for(i = 0; i < nSymRegs; ++i)
+    if(symRegs[i].reg == reg)
+      return TRUE;
+  return FALSE;
+}
+
+// TRUE if the nodes or their subtrees use the symbol
+static int refersTo(TreeNode *t, SymbolInfo *sym)
+{
+  for(; t != NULL; t = t->sibling)
+    {
+      TreeNode **kids[3];
+      int i, n = treeChildren(t, kids);
+
+      if(t->nodeKind == VariableK && t->symbolInfo == sym)
+        return TRUE;
+      for(i = 0; i < n; ++i)
+        if(refersTo(*kids[i], sym))
+          return TRUE;
+    }
+  return FALSE;
+}
+
+// The value of a variable in a register changes when it is
+// assigned; one evaluated before an expression that assigns
+// it is copied first
+static int keepValue(int v, TreeNode *later)
+{
+  int i;
+  for(i = 0; i < nSymRegs; ++i)
+    if(symRegs[i].reg == v && assignsSymbol(later, symRegs[i].sym))
+      {
+        int r = lirReg(lir);
+        emit(LirRR, "move", r, v, -1, 0, NULL);
+        return r;
+      }
+  return v;
+}
+
+// Sethi-Ullman labeling: the number of registers the
+// evaluation of an expression needs at once. A constant
+// right operand of + and - goes into the instruction.
+static int registerNeed(TreeNode *t)
+{
+  int l, r;
+  TreeNode *arg;
+
+  switch(t->nodeKind)
+    {
+    case ConstantK:
+    case VariableK:
+      return 1;
+    case ArrayK:
+      if(t->attr.arr.arr_expr->nodeKind == ConstantK)
+        return 1;
+      l = registerNeed(t->attr.arr.arr_expr);
+      return l > 2 ? l : 2;
+    case AssignExpressionK:
+      return registerNeed(t->attr.assignStmt.expr);
+    case CallK:
+      for(l = 1, arg = t->attr.call.expr_list; arg != NULL; arg = arg->sibling)
+        if(registerNeed(arg) > l)
+          l = registerNeed(arg);
+      return l;
+    case AdditiveExpressionK:
+      l = registerNeed(t->attr.addExpr.lexpr);
+      r = t->attr.addExpr.rexpr->nodeKind == ConstantK ? 0 : registerNeed(t->attr.addExpr.rexpr);
+      break;
+    case ComparisonExpressionK:
+      l = registerNeed(t->attr.cmpExpr.lexpr);
+      r = registerNeed(t->attr.cmpExpr.rexpr);
+      break;
+    case MultiplicativeExpressionK:
+      l = registerNeed(t->attr.multExpr.lexpr);
+      r = registerNeed(t->attr.multExpr.rexpr);
+      break;
+    default:
+      return 1;
+    }
+  return l == r ? l + 1 : (l > r ? l : r);
+}
+
+// TRUE if evaluating t may change what evaluating other
+// gives: t calls a function, stores to memory or assigns a
+// register variable other reads (failed bounds checks stop
+// the program the same way whichever runs first)
+static int interferes(TreeNode *t, TreeNode *other)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  if(t == NULL)
+    return FALSE;
+  if(t->nodeKind == AssignExpressionK
+     && (t->attr.assignStmt._var->nodeKind != VariableK
+         || !inRegister(t->attr.assignStmt._var->symbolInfo)
+         || refersTo(other, t->attr.assignStmt._var->symbolInfo)))
+    return TRUE;
+  if(t->nodeKind == CallK && strcmp(t->attr.call._var->attr.ID, "_bound"))
+    return TRUE;
+  n = treeChildren(t, kids);
+  for(i = 0; i < n; ++i)
+    {
+      TreeNode *k;
+      for(k = *kids[i]; k != NULL; k = k->sibling)
+        if(interferes(k, other))
+          return TRUE;
+    }
+  return FALSE;
+}
+
+// Evaluates the operands of a binary operator, the one that
+// needs more registers first when the order cannot be seen,
+// so that the value of the other is not held meanwhile
+static void evalOperands(TreeNode *lexpr, TreeNode *rexpr, int *lhs, int *rhs)
+{
+  if(registerNeed(rexpr) > registerNeed(lexpr)
+     && !interferes(lexpr, rexpr) && !interferes(rexpr, lexpr))
+    {
+      *rhs = exprCodeGen(rexpr);
+      *lhs = exprCodeGen(lexpr);
+      return;
+    }
+  *lhs = keepValue(exprCodeGen(lexpr), rexpr);
+  *rhs = exprCodeGen(rexpr);
+}
+
+// x << k, or x itself when k is 0
+static int shiftLeft(int x, int k)
+{
+  int r;
+  if(k == 0)
+    return x;
+  r = lirReg(lir);
+  emit(LirRRI, "sll", r, x, -1, k, NULL);
+  return r;
+}
+
+static int negate(int x)
+{
+  int r = lirReg(lir);
+  emit(LirRRR, "subu", r, REG_ZERO, x, 0, NULL);
+  return r;
+}
+
+static int log2Exact(unsigned m)
+{
+  int k = 0;
+  if(m == 0 || (m & (m - 1)) != 0)
+    return -1;
+  while(m >>= 1)
+    k++;
+  return k;
+}
+
+// x * c with shifts and adds when c (or -c) is 2^a, 2^a + 2^b
+// or 2^a - 2^b, which is cheaper than mul; -1 otherwise.
+// The low word of the product is the same, so it wraps
+// around the same way.
+static int timesConstant(int x, int c)
+{
+  unsigned m = c < 0 ? -(unsigned) c : (unsigned) c, low = m & -m;
+  int r;
+
+  if(c == 0)
+    {
+      r = lirReg(lir);
+      emit(LirRI, "li", r, -1, -1, 0, NULL);
+      return r;
+    }
+  if(log2Exact(m) >= 0)
+    r = shiftLeft(x, log2Exact(m));
+  else if(log2Exact(m - low) >= 0)
+    {
+      r = lirReg(lir);
+      emit(LirRRR, "addu", r, shiftLeft(x, log2Exact(m - low)), shiftLeft(x, log2Exact(low)), 0, NULL);
+    }
+  else if(log2Exact(m + low) >= 0)
+    {
+      r = lirReg(lir);
+      emit(LirRRR, "subu", r, shiftLeft(x, log2Exact(m + low)), shiftLeft(x, log2Exact(low)), 0, NULL);
+    }
+  else
+    return -1;
+  if(c < 0 && c != INT_MIN)
+    r = negate(r);
+  return r;
+}
+
+// The magic multiplier M and shift s of signed division by
+// d >= 2: x / d is the high word of M * x (plus x when M is
+// negative), shifted right by s, plus 1 when negative
+// (Hacker's Delight, 10-1)
+static void magicNumber(int d, int *M, int *s)
+{
+  const unsigned two31 = 0x80000000u;
+  unsigned ad = d, anc = two31 - 1 - two31 % ad;
+  unsigned q1 = two31 / anc, r1 = two31 - q1 * anc;
+  unsigned q2 = two31 / ad, r2 = two31 - q2 * ad, delta;
+  int p = 31;
+
+  do
+    {
+      p++;
+      q1 *= 2; r1 *= 2;
+      if(r1 >= anc) { q1++; r1 -= anc; }
+      q2 *= 2; r2 *= 2;
+      if(r2 >= ad) { q2++; r2 -= ad; }
+      delta = ad - r2;
+    }
+  while(q1 < delta || (q1 == delta && r1 == 0));
+  *M = (int) (q2 + 1);
+  *s = p - 32;
+}
+
+// x / c rounded toward zero like div, for c other than 0
+// and INT_MIN
+static int overConstant(int x, int c)
+{
+  int ad = c < 0 ? -c : c, k = log2Exact(ad), q, t;
+
+  if(ad == 1)
+    q = x;
+  else if(k > 0)
+    {
+      // a negative x is biased by 2^k - 1 so the shift rounds up
+      t = lirReg(lir);
+      if(k == 1)
+        emit(LirRRI, "srl", t, x, -1, 31, NULL);
+      else
+        {
+          int sign = lirReg(lir);
+          emit(LirRRI, "sra", sign, x, -1, 31, NULL);
+          emit(LirRRI, "srl", t, sign, -1, 32 - k, NULL);
+        }
+      q = lirReg(lir);
+      emit(LirRRR, "addu", q, x, t, 0, NULL);
+      t = q;
+      q = lirReg(lir);
+      emit(LirRRI, "sra", q, t, -1, k, NULL);
+    }
+  else
+    {
+      int M, s, m = lirReg(lir);
+      magicNumber(ad, &M, &s);
+      emit(LirRI, "li", m, -1, -1, M, NULL);
+      q = lirReg(lir);
+      emit(LirMulHi, NULL, q, x, m, 0, NULL);
+      if(M < 0)
+        {
+          t = q;
+          q = lirReg(lir);
+          emit(LirRRR, "addu", q, t, x, 0, NULL);
+        }
+      if(s > 0)
+        {
+          t = q;
+          q = lirReg(lir);
+          emit(LirRRI, "sra", q, t, -1, s, NULL);
+        }
+      t = lirReg(lir);
+      emit(LirRRI, "srl", t, q, -1, 31, NULL);
+      m = q;
+      q = lirReg(lir);
+      emit(LirRRR, "addu", q, m, t, 0, NULL);
+    }
+  return c < 0 ? negate(q) : q;
+}
+
+// Address of an array element: the register holding it,
+// with the constant part of the offset in *offset. An array
+// in the small data area is based at $gp.
+static int elementAddress(TreeNode *arr, int *offset)
+{
+  SymbolInfo *sym = arr->attr.arr._var->symbolInfo;
+  int gpBased = sym->attr.arrInfo.globalFlag && globalLabel(sym) == NULL;
+  int index, scaled, base, addr;
+
+  *offset = gpBased ? sym->attr.arrInfo.memloc : 0;
+  if(arr->attr.arr.arr_expr->nodeKind == ConstantK)
+    {
+      // a constant index goes into the offset of the load/store
+      *offset += arr->attr.arr.arr_expr->attr.NUM * (int) sizeof(int);
+      return gpBased ? REG_GP : exprCodeGen(arr->attr.arr._var);
+    }
+  index = exprCodeGen(arr->attr.arr.arr_expr);
+  scaled = shiftLeft(index, 2);
+  base = gpBased ? REG_GP : exprCodeGen(arr->attr.arr._var);
+  addr = lirReg(lir);
+  emit(LirRRR, "addu", addr, base, scaled, 0, NULL);
+  return addr;
+}
+
+// Evaluates a condition to a register that is nonzero
+// exactly when the condition holds, or zero exactly when it
+// holds if whenZero is set: slt for the orderings and the
+// xor of the operands for == and !=
+static int testValue(TreeNode *cond, int *whenZero)
+{
+  TreeNode *rexpr;
+  TokenType op;
+  int lhs, rhs, d;
+
+  *whenZero = FALSE;
+  if(cond->nodeKind != ComparisonExpressionK)
+    return exprCodeGen(cond);
+  op = cond->attr.cmpExpr.op->attr.TOK;
+  rexpr = cond->attr.cmpExpr.rexpr;
+  *whenZero = op == GE || op == LE || op == EQ;
+  if(rexpr->nodeKind == ConstantK
+     && (((op == LT || op == GE) && rexpr->attr.NUM >= -32768 && rexpr->attr.NUM <= 32767)
+         || ((op == EQ || op == NE) && rexpr->attr.NUM >= 0 && rexpr->attr.NUM <= 65535)))
+    {
+      lhs = exprCodeGen(cond->attr.cmpExpr.lexpr);
+      if((op == EQ || op == NE) && rexpr->attr.NUM == 0)
+        return lhs;
+      d = lirReg(lir);
+      emit(LirRRI, op == EQ || op == NE ? "xori" : "slti", d, lhs, -1, rexpr->attr.NUM, NULL);
+      return d;
+    }
+  evalOperands(cond->attr.cmpExpr.lexpr, rexpr, &lhs, &rhs);
+  d = lirReg(lir);
+  switch(op)
+    {
+    case LT: case GE: emit(LirRRR, "slt", d, lhs, rhs, 0, NULL); break;
+    case GT: case LE: emit(LirRRR, "slt", d, rhs, lhs, 0, NULL); break;
+    case EQ: case NE: emit(LirRRR, "xor", d, lhs, rhs, 0, NULL); break;
+    default: DONT_OCCUR_PRINT;
+    }
+  return d;
+}
+
+// position of a comparison in the branch tables
+static int branchIndex(TokenType op)
+{
+  switch(op)
+    {
+    case LT: return 0;
+    case LE: return 1;
+    case GT: return 2;
+    case GE: return 3;
+    case EQ: return 4;
+    case NE: return 5;
+    default: DONT_OCCUR_PRINT;
+    }
+  return 0;
+}
+
+static TokenType negateComparison(TokenType op)
+{
+  switch(op)
+    {
+    case LT: return GE;
+    case LE: return GT;
+    case GT: return LE;
+    case GE: return LT;
+    case EQ: return NE;
+    case NE: return EQ;
+    default: DONT_OCCUR_PRINT;
+    }
+  return op;
+}
+
+// the comparison with its operands exchanged
+static TokenType swapComparison(TokenType op)
+{
+  switch(op)
+    {
+    case LT: return GT;
+    case LE: return GE;
+    case GT: return LT;
+    case GE: return LE;
+    default: return op;
+    }
+}
+
+// Jumps to label when the condition is true (sense TRUE) or
+// false. A comparison becomes one compare-and-branch, with
+// the single-register forms against zero; its 0/1 value is
+// never built.
+static void branchOn(TreeNode *cond, int sense, const char *label)
+{
+  static const char *branch[] = { "blt", "ble", "bgt", "bge", "beq", "bne" };
+  static const char *branchZero[] = { "bltz", "blez", "bgtz", "bgez", "beqz", "bnez" };
+  TreeNode *lexpr, *rexpr;
+  TokenType op;
+  int lhs, rhs;
+
+  if(cond->nodeKind != ComparisonExpressionK)
+    {
+      emit(LirBranch, sense ? "bnez" : "beqz", -1, exprCodeGen(cond), -1, 0, label);
+      return;
+    }
+  op = cond->attr.cmpExpr.op->attr.TOK;
+  if(!sense)
+    op = negateComparison(op);
+  lexpr = cond->attr.cmpExpr.lexpr;
+  rexpr = cond->attr.cmpExpr.rexpr;
+  if(lexpr->nodeKind == ConstantK && lexpr->attr.NUM == 0)
+    {
+      lexpr = rexpr;
+      rexpr = cond->attr.cmpExpr.lexpr;
+      op = swapComparison(op);
+    }
+  if(rexpr->nodeKind == ConstantK && rexpr->attr.NUM == 0)
+    {
+      lhs = exprCodeGen(lexpr);
+      emit(LirBranch, branchZero[branchIndex(op)], -1, lhs, -1, 0, label);
+      return;
+    }
+  evalOperands(lexpr, rexpr, &lhs, &rhs);
+  emit(LirBranch, branch[branchIndex(op)], -1, lhs, rhs, 0, label);
+}
+
+// Local decls and statements
+// The instructions evaluating an expression takes, roughly,
+// or -1 if it may not run when its branch is not taken: it
+// loads array elements, calls, assigns or divides by
+// anything but a nonzero constant
+static int selectCost(TreeNode *t)
+{
+  int l, r;
+
+  switch(t->nodeKind)
+    {
+    case ConstantK:
+      return 1;
+    case VariableK:
+      return t->symbolInfo->nodeType == IntT && inRegister(t->symbolInfo) ? 0 : 1;
+    case AdditiveExpressionK:
+      l = selectCost(t->attr.addExpr.lexpr);
+      r = t->attr.addExpr.rexpr->nodeKind == ConstantK ? 0 : selectCost(t->attr.addExpr.rexpr);
+      break;
+    case ComparisonExpressionK:
+      l = selectCost(t->attr.cmpExpr.lexpr);
+      r = selectCost(t->attr.cmpExpr.rexpr);
+      if(l >= 0 && r >= 0)
+        ++l;
+      break;
+    case MultiplicativeExpressionK:
+      if(t->attr.multExpr.op->attr.TOK == OVER
+         && (t->attr.multExpr.rexpr->nodeKind != ConstantK
+             || t->attr.multExpr.rexpr->attr.NUM == 0))
+        return -1;
+      l = selectCost(t->attr.multExpr.lexpr);
+      r = selectCost(t->attr.multExpr.rexpr);
+      break;
+    default:
+      return -1;
+    }
+  return l < 0 || r < 0 ? -1 : l + r + 1;
+}
+
+// The assignment to a variable in a register that is all a
+// statement does, or NULL
+static TreeNode *soleAssignment(TreeNode *s)
+{
+  TreeNode *e;
+
+  while(s != NULL && s->sibling == NULL && s->nodeKind == CompoundStatementK
+        && s->attr.cmpdStmt.local_decl == NULL)
+    s = s->attr.cmpdStmt.stmt_list;
+  if(s == NULL || s->sibling != NULL || s->nodeKind != ExpressionStatementK)
+    return NULL;
+  e = s->attr.exprStmt.expr;
+  if(e == NULL || e->nodeKind != AssignExpressionK
+     || e->attr.assignStmt._var->nodeKind != VariableK
+     || !inRegister(e->attr.assignStmt._var->symbolInfo))
+    return NULL;
+  return e;
+}
+
+// If-conversion: if (c) x = a; else x = b; and if (c) x = a;
+// with a and b cheap and safe to evaluate either way become
+// x = b; movn x, a, c (movz for a test that is zero when it
+// holds), with no branch to mispredict. FALSE if the
+// statement is not of that shape or over IfConvertLimit.
+static int ifConvert(TreeNode *t)
+{
+  TreeNode *thenA = soleAssignment(t->attr.selectStmt.if_stmt), *elseA = NULL;
+  int x, a, b, d, whenZero, thenCost, elseCost = 0;
+
+  if(thenA == NULL)
+    return FALSE;
+  if(t->attr.selectStmt.else_stmt != NULL)
+    {
+      elseA = soleAssignment(t->attr.selectStmt.else_stmt);
+      if(elseA == NULL || elseA->attr.assignStmt._var->symbolInfo
+         != thenA->attr.assignStmt._var->symbolInfo)
+        return FALSE;
+      elseCost = selectCost(elseA->attr.assignStmt.expr);
+    }
+  thenCost = selectCost(thenA->attr.assignStmt.expr);
+  if(thenCost < 0 || elseCost < 0 || thenCost + elseCost > IfConvertLimit)
+    return FALSE;
+
+  comment("# Selection Statement (if-converted)");
+  x = symbolReg(thenA->attr.assignStmt._var->symbolInfo);
+  d = testValue(t->attr.selectStmt.expr, &whenZero);
+  a = exprCodeGen(thenA->attr.assignStmt.expr);
+  if(elseA != NULL)
+    {
+      b = exprCodeGen(elseA->attr.assignStmt.expr);
+      if(a == x)
+        {
+          // if (c) x = x; else x = b; moves b when c fails
+          a = b;
+          whenZero = !whenZero;
+        }
+      else if(b != x)
+        {
+          // x is written before the test and a are read
+          if(d == x || a == x)
+            {
+              int keep = lirReg(lir);
+              emit(LirRR, "move", keep, x, -1, 0, NULL);
+              if(d == x) d = keep;
+              if(a == x) a = keep;
+            }
+          emit(LirRR, "move", x, b, -1, 0, NULL);
+        }
+    }
+  if(a != x)
+    emit(LirCondMove, whenZero ? "movz" : "movn", x, a, d, 0, NULL);
+  return TRUE;
+}
+
+static int localCodeGen(TreeNode *syntaxTree, int currStack, int travSibling)
 {
   TreeNode *t;
   for(t = syntaxTree;
@@ -160,360 +1189,389 @@ static int localCodeGen(TreeNode *syntaxTree, FILE *codeStream, int currStack, i
 
         case VariableDeclarationK:
         {
-          int size = sizeof(int);
-
-          fprintf(codeStream, "\n# Local variable declaration\n");
-          fprintf(codeStream, "addiu $sp, $sp, %d\n", -size);
-          currStack += size;
-          t->attr.varDecl._var->symbolInfo->attr.intInfo.memloc = -currStack;
+          // no stack: a scalar or pointer local gets a register
+          if(!inRegister(t->attr.varDecl._var->symbolInfo))
+            DONT_OCCUR_PRINT;
+          symbolReg(t->attr.varDecl._var->symbolInfo);
           break;
         }
         case ArrayDeclarationK:
         {
+          // a fixed slot in the local area of the frame
           int size = regSize * t->attr.varDecl._var->symbolInfo->attr.arrInfo.arrLen;
-          fprintf(codeStream, "\n# Local array declaration\n");
-          fprintf(codeStream, "addiu $sp, $sp, %d\n", -size);
           t->attr.varDecl._var->symbolInfo->attr.arrInfo.memloc = -currStack-size;
           currStack += size;
+          if(currStack > localBytes)
+            localBytes = currStack;
           break;
         }
 
         case CompoundStatementK:
         {
-          fprintf(codeStream, "\n# Compound Statement\n");
+          comment("\n# Compound Statement");
           int updateStack = currStack;
 
-          updateStack = localCodeGen(t->attr.cmpdStmt.local_decl, codeStream, updateStack, 1);
-          if(localCodeGen(t->attr.cmpdStmt.stmt_list, codeStream, updateStack, 1) != updateStack, 1)
+          // the arrays of the scope go below those of the enclosing
+          // ones; the next scope reuses their slots
+          updateStack = localCodeGen(t->attr.cmpdStmt.local_decl, updateStack, 1);
+          if(localCodeGen(t->attr.cmpdStmt.stmt_list, updateStack, 1) != updateStack)
             DONT_OCCUR_PRINT;
-
-          // stack cleanup
           if(updateStack < currStack)
             DONT_OCCUR_PRINT;
-
-          fprintf(codeStream, "\n# Local stack cleanup\n");
-          fprintf(codeStream, "addiu $sp, $sp, %d\n", updateStack - currStack);
-
-          /*
-          if(updateStack > 0) // it does not have return stmt
-            {
-              fprintf(codeStream, "\n# Local stack cleanup\n");
-              fprintf(codeStream, "addiu $sp, $sp, %d\n", updateStack - currStack);
-            }
-          */
           break;
         }
         case ExpressionStatementK:
         {
-          if(localCodeGen(t->attr.exprStmt.expr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
+          if(t->attr.exprStmt.expr != NULL)
+            exprCodeGen(t->attr.exprStmt.expr);
           break;
         }
         case SelectionStatementK:
         {
-          fprintf(codeStream, "\n# Selection Statement\n");
-          fprintf(codeStream, "# Selection Statement Expression\n");
-          if(localCodeGen(t->attr.selectStmt.expr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
+          comment("\n# Selection Statement");
+          if(t->attr.selectStmt.expr->nodeKind == ConstantK)
+            {
+              // known condition: only the taken branch is emitted
+              TreeNode *taken = t->attr.selectStmt.expr->attr.NUM ?
+                t->attr.selectStmt.if_stmt : t->attr.selectStmt.else_stmt;
+              if(localCodeGen(taken, currStack, 1) != currStack)
+                DONT_OCCUR_PRINT;
+              break;
+            }
+          if(IfConvertLimit > 0 && ifConvert(t))
+            break;
+          comment("# Selection Statement Expression");
           int L_exit = labelAlloc(), L_false = labelAlloc();
-          fprintf(codeStream, "beqz $v0, L%d\n", L_false);
-          fprintf(codeStream, "# Selection Statement If Statement\n");
-          if(localCodeGen(t->attr.selectStmt.if_stmt, codeStream, currStack, 1) != currStack)
+          branchOn(t->attr.selectStmt.expr, FALSE, labelName(L_false));
+          comment("# Selection Statement If Statement");
+          if(localCodeGen(t->attr.selectStmt.if_stmt, currStack, 1) != currStack)
             DONT_OCCUR_PRINT;
-          fprintf(codeStream, "j L%d\n", L_exit);
-          fprintf(codeStream, "L%d:\n", L_false);
-          fprintf(codeStream, "# Selection Statement Else Statement\n");
-          if(localCodeGen(t->attr.selectStmt.else_stmt, codeStream, currStack, 1) != currStack)
+          emit(LirJump, "j", -1, -1, -1, 0, labelName(L_exit));
+          emit(LirLabel, NULL, -1, -1, -1, 0, labelName(L_false));
+          comment("# Selection Statement Else Statement");
+          if(localCodeGen(t->attr.selectStmt.else_stmt, currStack, 1) != currStack)
             DONT_OCCUR_PRINT;
-          fprintf(codeStream, "L%d:\n", L_exit);
+          emit(LirLabel, NULL, -1, -1, -1, 0, labelName(L_exit));
           break;
         }
         case IterationStatementK:
         {
-          fprintf(codeStream, "\n# Iteration Statement\n");
+          comment("\n# Iteration Statement");
+          if(t->attr.iterStmt.expr->nodeKind == ConstantK
+             && t->attr.iterStmt.expr->attr.NUM == 0)
+            break;
           int L_cmp = labelAlloc(), L_loop = labelAlloc();
-          fprintf(codeStream, "j L%d\n", L_cmp);
-          fprintf(codeStream, "L%d:\n", L_loop);
-          fprintf(codeStream, "# Iteration Statement Loop Statement\n");
-          if(localCodeGen(t->attr.iterStmt.loop_stmt, codeStream, currStack, 1) != currStack)
+          emit(LirJump, "j", -1, -1, -1, 0, labelName(L_cmp));
+          emit(LirLabel, NULL, -1, -1, -1, 0, labelName(L_loop));
+          comment("# Iteration Statement Loop Statement");
+          if(localCodeGen(t->attr.iterStmt.loop_stmt, currStack, 1) != currStack)
             DONT_OCCUR_PRINT;
-          fprintf(codeStream, "L%d:\n", L_cmp);
-          fprintf(codeStream, "# Iteration Statement Expression\n");
-          if(localCodeGen(t->attr.iterStmt.expr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          fprintf(codeStream, "bnez $v0, L%d\n", L_loop);
+          emit(LirLabel, NULL, -1, -1, -1, 0, labelName(L_cmp));
+          comment("# Iteration Statement Expression");
+          if(t->attr.iterStmt.expr->nodeKind == ConstantK)
+            {
+              // known true condition: loop until a return
+              emit(LirJump, "j", -1, -1, -1, 0, labelName(L_loop));
+              break;
+            }
+          branchOn(t->attr.iterStmt.expr, TRUE, labelName(L_loop));
           break;
         }
         case ReturnStatementK:
         {
-          // TODO: review this
-          // ex) have to jr immediatly (but have to clean stack with prev value
-          // of registers. no need to load. just roll up the stack.)
-          // int f(int i) {
-          //   if(i) {
-          //     int j;
-          //     return 1;
-          //   }
-          //   return 0;
-          // }
-          if(t->attr.retStmt.expr != NULL)
-            if(localCodeGen(t->attr.retStmt.expr, codeStream, currStack, 0) != currStack)
-              DONT_OCCUR_PRINT;
+          if(Optimize && isTailCallable(t->attr.retStmt.expr))
+            {
+              // tail call: the arguments overwrite our own parameter
+              // slots, and the callee returns straight to our caller
+              TreeNode *call = t->attr.retStmt.expr, *arg;
+              int *args = NULL, nArgs = 0, capArgs = 0, off = 0, i, nRegArgs;
+              comment("\n# Tail call");
+              for(arg = call->attr.call.expr_list; arg != NULL; arg = arg->sibling)
+                {
+                  TreeNode *later;
+                  int v = exprCodeGen(arg);
+                  for(later = arg->sibling; later != NULL; later = later->sibling)
+                    v = keepValue(v, later);
+                  GROW(args, nArgs, capArgs);
+                  args[nArgs++] = v;
+                }
+              // the last argument goes to 0($fp), the first four
+              // into $a0-$a3 with RegisterArgs
+              for(i = nArgs - 1; i >= 0 && argRegister(i) < 0; --i, off += regSize)
+                emit(LirStore, "sw", -1, args[i], REG_FP, off, NULL);
+              for(nRegArgs = 0; nRegArgs < nArgs && argRegister(nRegArgs) >= 0; ++nRegArgs)
+                emit(LirRR, "move", argRegister(nRegArgs), args[nRegArgs], -1, 0, NULL);
+              free(args);
+              emit(LirTailCall, "j", -1, -1, -1, nRegArgs, call->attr.call._var->attr.ID);
+              break;
+            }
 
-          fprintf(codeStream, "j L%d\n", L_cleanup);
+          if(t->attr.retStmt.expr != NULL)
+            {
+              int v = exprCodeGen(t->attr.retStmt.expr);
+              if(v >= 0)
+                emit(LirRR, "move", REG_V0, v, -1, 0, NULL);
+            }
 
+          emit(LirJump, "j", -1, -1, -1, 0, labelName(L_cleanup));
           break;
+        }
 
-          /*
-          // cleanup
-          fprintf(codeStream, "\n# Stack cleanup\n");
-
-          // return to original sp
-          fprintf(codeStream, "addiu $sp, $sp, %d\n", currStack - 10 * regSize);
-
-          // load register $fp
-          fprintf(codeStream, "lw $fp, %d($sp)\n", 0 * regSize);
-          // load registers $s0~$s7
-          int i;
-          for(i=0; i<8; ++i)
-            fprintf(codeStream, "lw $s%d, %d($sp)\n", i, (i+1) * regSize);
-          // load register $ra
-          fprintf(codeStream, "lw $ra, %d($sp)\n", 9 * regSize);
-
-          // free stack
-          fprintf(codeStream, "addiu $sp, $sp, %d\n", 10 * regSize);
+        default:
+          DONT_OCCUR_PRINT;
+        }
+    }
+  return currStack;
+}
 
-          // return
-          fprintf(codeStream, "\n# Return to caller\n");
-          fprintf(codeStream, "jr $ra\n\n");
-          */
+// Expressions: returns the register holding the value
+static int exprCodeGen(TreeNode *t)
+{
+  int r = -1;
 
-          // Optimization: do not need to check other stmts
-          //return 0;
+  switch (t->nodeKind)
+    {
+    case AssignExpressionK:
+    {
+      TreeNode *_var = t->attr.assignStmt._var;
+      if(_var->nodeKind == VariableK && inRegister(_var->symbolInfo))
+        {
+          int x = symbolReg(_var->symbolInfo), mark = lir->n, v;
+          v = exprCodeGen(t->attr.assignStmt.expr);
+          // a temporary just computed is computed into x instead
+          if(!isSymbolReg(v) && lir->n > mark && lir->code[lir->n - 1].dst == v)
+            lir->code[lir->n - 1].dst = x;
+          else
+            emit(LirRR, "move", x, v, -1, 0, NULL);
+          r = x;
         }
-
-        case AssignExpressionK:
+      else if(_var->nodeKind == VariableK)
         {
-          if(localCodeGen(t->attr.assignStmt.expr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          if (t->attr.assignStmt._var->nodeKind == VariableK)
-            {
-              fprintf(codeStream,
-                      t->attr.assignStmt._var->symbolInfo->attr.intInfo.globalFlag ?
-                      "sw $v0, %d\n" : "sw $v0, %d($fp)\n",
-                      t->attr.assignStmt._var->symbolInfo->attr.intInfo.memloc);
-            }
-          else if (t->attr.assignStmt._var->nodeKind == ArrayK)
-            {
-              fprintf(codeStream, "move $s1, $v0\n");
-              {
-                TreeNode* arr = t->attr.assignStmt._var;
-                if(localCodeGen(arr->attr.arr.arr_expr, codeStream, currStack, 0) != currStack)
-                  DONT_OCCUR_PRINT;
-                fprintf(codeStream, "li $s0, %lu\n", sizeof(int));
-                fprintf(codeStream, "mul $s0, $v0, $s0\n");
-                if(localCodeGen(arr->attr.arr._var, codeStream, currStack, 0) != currStack)
-                  DONT_OCCUR_PRINT;
-                fprintf(codeStream, "add $v0, $v0, $s0\n");
-              }
-              /*
-              if(localCodeGen(t->attr.assignStmt._var, codeStream, currStack) != currStack)
-                DONT_OCCUR_PRINT;*/
-              fprintf(codeStream, "sw $s1, 0($v0)\n");
-              fprintf(codeStream, "move $v0, $s1\n");
-            }
+          // a global
+          const char *label = globalLabel(_var->symbolInfo);
+          r = exprCodeGen(t->attr.assignStmt.expr);
+          if(label != NULL)
+            emit(LirStore, "sw", -1, r, -1, 0, label);
           else
-            DONT_OCCUR_PRINT;
-          break;
+            emit(LirStore, "sw", -1, r, REG_GP, _var->symbolInfo->attr.intInfo.memloc, NULL);
         }
-        case ComparisonExpressionK:
+      else if(_var->nodeKind == ArrayK)
         {
-          if(localCodeGen(t->attr.cmpExpr.lexpr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          fprintf(codeStream, "addiu $sp, $sp, -%lu\n", sizeof(int));
-          fprintf(codeStream, "sw $v0, 0($sp)\n");
-          currStack += sizeof(int);
-
-          if(localCodeGen(t->attr.cmpExpr.rexpr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          fprintf(codeStream, "lw $s0, 0($sp)\n");
-          fprintf(codeStream, "addiu $sp, $sp, %lu\n", sizeof(int));
-          currStack -= sizeof(int);
-
-          switch(t->attr.cmpExpr.op->attr.TOK)
-            {
-            case LT: fprintf(codeStream, "slt $v0, $s0, $v0\n"); break;
-            case LE: fprintf(codeStream, "sle $v0, $s0, $v0\n"); break;
-            case GT: fprintf(codeStream, "sgt $v0, $s0, $v0\n"); break;
-            case GE: fprintf(codeStream, "sge $v0, $s0, $v0\n"); break;
-            case EQ: fprintf(codeStream, "seq $v0, $s0, $v0\n"); break;
-            case NE: fprintf(codeStream, "sne $v0, $s0, $v0\n"); break;
-            default: DONT_OCCUR_PRINT;
-            }
+          int offset, addr;
+          r = keepValue(exprCodeGen(t->attr.assignStmt.expr),
+                        _var->attr.arr.arr_expr);
+          addr = elementAddress(_var, &offset);
+          emit(LirStore, "sw", -1, r, addr, offset, NULL);
+        }
+      else
+        DONT_OCCUR_PRINT;
+      break;
+    }
+    case ComparisonExpressionK:
+    {
+      // the 0/1 value, from slt/sltu as the set pseudo
+      // instructions other than slt expand to several
+      TokenType op = t->attr.cmpExpr.op->attr.TOK;
+      int whenZero, d = testValue(t, &whenZero);
+      if(op != EQ && op != NE && !whenZero)
+        {
+          r = d;
           break;
         }
-        case AdditiveExpressionK:
+      r = lirReg(lir);
+      if(op == EQ)
+        emit(LirRRI, "sltiu", r, d, -1, 1, NULL);
+      else if(op == NE)
+        emit(LirRRR, "sltu", r, REG_ZERO, d, 0, NULL);
+      else
+        emit(LirRRI, "xori", r, d, -1, 1, NULL);
+      break;
+    }
+    case AdditiveExpressionK:
+    {
+      int lhs, rhs;
+      if (t->attr.addExpr.rexpr->nodeKind == ConstantK)
         {
-          if(localCodeGen(t->attr.addExpr.lexpr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          fprintf(codeStream, "addiu $sp, $sp, -%lu\n", sizeof(int));
-          fprintf(codeStream, "sw $v0, 0($sp)\n");
-          currStack += sizeof(int);
-
-          if(localCodeGen(t->attr.addExpr.rexpr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          fprintf(codeStream, "lw $s0, 0($sp)\n");
-          fprintf(codeStream, "addiu $sp, $sp, %lu\n", sizeof(int));
-          currStack -= sizeof(int);
-
-          switch(t->attr.addExpr.op->attr.TOK)
+          // a constant that fits the immediate field
+          int imm = t->attr.addExpr.rexpr->attr.NUM;
+          if (t->attr.addExpr.op->attr.TOK == MINUS)
+            imm = -imm;
+          if (imm >= -32768 && imm <= 32767)
             {
-            case PLUS: fprintf(codeStream, "add $v0, $s0, $v0\n"); break;
-            case MINUS: fprintf(codeStream, "sub $v0, $s0, $v0\n"); break;
-            default: DONT_OCCUR_PRINT;
+              lhs = exprCodeGen(t->attr.addExpr.lexpr);
+              r = lirReg(lir);
+              emit(LirRRI, "addiu", r, lhs, -1, imm, NULL);
+              break;
             }
+        }
+      evalOperands(t->attr.addExpr.lexpr, t->attr.addExpr.rexpr, &lhs, &rhs);
+      r = lirReg(lir);
+      // addu/subu wrap rather than trap: reassociated sums
+      // may overflow in between where the source did not
+      switch(t->attr.addExpr.op->attr.TOK)
+        {
+        case PLUS: emit(LirRRR, "addu", r, lhs, rhs, 0, NULL); break;
+        case MINUS: emit(LirRRR, "subu", r, lhs, rhs, 0, NULL); break;
+        default: DONT_OCCUR_PRINT;
+        }
+      break;
+    }
+    case MultiplicativeExpressionK:
+    {
+      int lhs, rhs;
+      if(t->attr.multExpr.op->attr.TOK == SHR
+         && t->attr.multExpr.rexpr->nodeKind == ConstantK)
+        {
+          lhs = exprCodeGen(t->attr.multExpr.lexpr);
+          r = lirReg(lir);
+          emit(LirRRI, "sra", r, lhs, -1, t->attr.multExpr.rexpr->attr.NUM & 31, NULL);
           break;
-          //return currStack; //break;
         }
-        case MultiplicativeExpressionK:
+      if(t->attr.multExpr.op->attr.TOK == TIMES
+         && (t->attr.multExpr.lexpr->nodeKind == ConstantK
+             || t->attr.multExpr.rexpr->nodeKind == ConstantK))
         {
-          if(localCodeGen(t->attr.multExpr.lexpr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          fprintf(codeStream, "addiu $sp, $sp, -%lu\n", sizeof(int));
-          fprintf(codeStream, "sw $v0, 0($sp)\n");
-          currStack += sizeof(int);
-
-          if(localCodeGen(t->attr.multExpr.rexpr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          fprintf(codeStream, "lw $s0, 0($sp)\n");
-          fprintf(codeStream, "addiu $sp, $sp, %lu\n", sizeof(int));
-          currStack -= sizeof(int);
-
-          switch(t->attr.multExpr.op->attr.TOK)
-            {
-            case TIMES: fprintf(codeStream, "mul $v0, $s0, $v0\n"); break;
-            case OVER: fprintf(codeStream, "div $v0, $s0, $v0\n"); break;
-            default: DONT_OCCUR_PRINT;
-            }
+          // by a constant: shifts and adds where they are cheaper
+          TreeNode *c = t->attr.multExpr.lexpr, *x = t->attr.multExpr.rexpr;
+          if(x->nodeKind == ConstantK)
+            c = x, x = t->attr.multExpr.lexpr;
+          lhs = exprCodeGen(x);
+          if((r = timesConstant(lhs, c->attr.NUM)) >= 0)
+            break;
+          rhs = lirReg(lir);
+          emit(LirRI, "li", rhs, -1, -1, c->attr.NUM, NULL);
+          r = lirReg(lir);
+          emit(LirRRR, "mul", r, lhs, rhs, 0, NULL);
           break;
         }
-
-        case CallK:
+      if(t->attr.multExpr.op->attr.TOK == OVER
+         && t->attr.multExpr.rexpr->nodeKind == ConstantK
+         && t->attr.multExpr.rexpr->attr.NUM != 0
+         && t->attr.multExpr.rexpr->attr.NUM != INT_MIN)
         {
-          int accLoc = 0, i;
-          TreeNode *expr;
-          if (!strcmp(t->attr.call._var->attr.ID, "input"))
-            {
-              // print "input : "
-              fprintf(codeStream, "\n# input\n");
-              fprintf(codeStream, "li $v0, 4\n");
-              fprintf(codeStream, "la $a0, input_str\n");
-              fprintf(codeStream, "syscall\n");
-              // read_int
-              fprintf(codeStream, "li $v0, 5\n");
-              fprintf(codeStream, "syscall\n");
-            }
-          else if (!strcmp(t->attr.call._var->attr.ID, "output"))
-            {
-              // print "output : "
-              fprintf(codeStream, "\n# output\n");
-              fprintf(codeStream, "move $t0, $v0\n");
-              fprintf(codeStream, "li $v0, 4\n");
-              fprintf(codeStream, "la $a0, output_str\n");
-              fprintf(codeStream, "syscall\n");
-              fprintf(codeStream, "move $v0, $t0\n");
-              // print_int
-              if (localCodeGen(t->attr.call.expr_list, codeStream, currStack + accLoc, 1) != (currStack + accLoc))
-                DONT_OCCUR_PRINT;
-              fprintf(codeStream, "move $a0, $v0\n"); // the argument
-              fprintf(codeStream, "li $v0, 1\n");
-              fprintf(codeStream, "syscall\n");
-              // print newline
-              fprintf(codeStream, "li $v0, 4\n");
-              fprintf(codeStream, "la $a0, newline\n");
-              fprintf(codeStream, "syscall\n");
-            }
-          else
-            {
-              for(expr = t->attr.call.expr_list, i = 0;
-                  expr != NULL;
-                  expr = expr->sibling, i++)
-                {
-                  int size;
-                  switch(t->attr.call._var->symbolInfo->attr.funcInfo.paramTypeList[i])
-                    {
-                    case IntT: size = sizeof(int); break;
-                    case IntArrayT: size = regSize; break;
-                    default: DONT_OCCUR_PRINT;
-                    }
-
-                  if(localCodeGen(expr, codeStream, currStack + accLoc, 0) != (currStack + accLoc))
-                    DONT_OCCUR_PRINT;
-
-                  fprintf(codeStream, "addiu $sp, $sp, %d\n", -size);
-                  fprintf(codeStream, "sw $v0, 0($sp)\n");
-                  accLoc += size;
-                }
-              fprintf(codeStream, "jal %s\n", t->attr.call._var->attr.ID);
-              fprintf(codeStream, "addiu $sp, $sp, %d\n", accLoc);
-            }
-
+          // by a constant: multiply-high with a magic number
+          lhs = exprCodeGen(t->attr.multExpr.lexpr);
+          r = overConstant(lhs, t->attr.multExpr.rexpr->attr.NUM);
           break;
-          /* For fixing a bug about iteration of sibling in parameter passing. */
-          //return currStack;//break;
         }
+      evalOperands(t->attr.multExpr.lexpr, t->attr.multExpr.rexpr, &lhs, &rhs);
+      r = lirReg(lir);
+      switch(t->attr.multExpr.op->attr.TOK)
+        {
+        case TIMES: emit(LirRRR, "mul", r, lhs, rhs, 0, NULL); break;
+        case OVER: emit(LirRRR, "div", r, lhs, rhs, 0, NULL); break;
+        case SHR: emit(LirRRR, "srav", r, lhs, rhs, 0, NULL); break;
+        default: DONT_OCCUR_PRINT;
+        }
+      break;
+    }
 
-        case ArrayK:
+    case CallK:
+    {
+      const char *name = t->attr.call._var->attr.ID;
+      if (!strcmp(name, "input"))
         {
-          if(localCodeGen(t->attr.arr.arr_expr, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          fprintf(codeStream, "li $s0, %lu\n", sizeof(int));
-          fprintf(codeStream, "mul $s0, $v0, $s0\n");
-          if(localCodeGen(t->attr.arr._var, codeStream, currStack, 0) != currStack)
-            DONT_OCCUR_PRINT;
-          fprintf(codeStream, "add $v0, $v0, $s0\n");
-          fprintf(codeStream, "lw $v0, 0($v0)\n");
-          
-          break;
-          /* For fixing a bug about iteration of sibling in parameter passing. */
-          //return currStack;//break;
+          // print "input : "
+          comment("\n# input");
+          emit(LirRI, "li", REG_V0, -1, -1, 4, NULL);
+          emit(LirRL, "la", REG_A0, -1, -1, 0, "input_str");
+          emit(LirSyscall, NULL, -1, REG_A0, -1, 0, NULL);
+          // read_int
+          emit(LirRI, "li", REG_V0, -1, -1, 5, NULL);
+          emit(LirSyscall, NULL, -1, -1, -1, 0, NULL);
+          r = lirReg(lir);
+          emit(LirRR, "move", r, REG_V0, -1, 0, NULL);
+        }
+      else if (!strcmp(name, "output"))
+        {
+          // the argument is evaluated before anything is printed
+          int v;
+          comment("\n# output");
+          v = exprCodeGen(t->attr.call.expr_list);
+          // print "output : "
+          emit(LirRI, "li", REG_V0, -1, -1, 4, NULL);
+          emit(LirRL, "la", REG_A0, -1, -1, 0, "output_str");
+          emit(LirSyscall, NULL, -1, REG_A0, -1, 0, NULL);
+          // print_int
+          emit(LirRR, "move", REG_A0, v, -1, 0, NULL);
+          emit(LirRI, "li", REG_V0, -1, -1, 1, NULL);
+          emit(LirSyscall, NULL, -1, REG_A0, -1, 0, NULL);
+          // print newline
+          emit(LirRI, "li", REG_V0, -1, -1, 4, NULL);
+          emit(LirRL, "la", REG_A0, -1, -1, 0, "newline");
+          emit(LirSyscall, NULL, -1, REG_A0, -1, 0, NULL);
         }
-        case VariableK:
+      else if (!strcmp(name, "_bound"))
         {
-          switch(t->symbolInfo->nodeType)
+          // the index, if it is within the length (unsigned: not negative either)
+          int len = lirReg(lir);
+          r = exprCodeGen(t->attr.call.expr_list);
+          emit(LirRI, "li", len, -1, -1, t->attr.call.expr_list->sibling->attr.NUM, NULL);
+          emit(LirBranch, "bgeu", -1, r, len, 0, "_bound_fail");
+          usesBound = TRUE;
+        }
+      else
+        {
+          int nRegArgs;
+          if (!strcmp(name, "_fill"))
+            usesFill = TRUE;
+          else if (!strcmp(name, "_copy"))
+            usesCopy = TRUE;
+          pushArguments(t, &nRegArgs);
+          emit(LirCall, "jal", -1, -1, -1, nRegArgs, name);
+          if (t->attr.call._var->symbolInfo->attr.funcInfo.retType != VoidT)
             {
-            case IntT:
-              fprintf(codeStream,
-                      t->symbolInfo->attr.intInfo.globalFlag ? "lw $v0, %d\n" : "lw $v0, %d($fp)\n",
-                      t->symbolInfo->attr.intInfo.memloc);
-              break;
-            case IntArrayT:
-              fprintf(codeStream,
-                      t->symbolInfo->attr.arrInfo.globalFlag ? "li $v0, %d\n" : "addiu $v0, $fp, %d\n",
-                      t->symbolInfo->attr.arrInfo.memloc);
-              if (t->symbolInfo->attr.arrInfo.isParam)
-                fprintf(codeStream, "lw $v0, 0($v0)\n");
-              break;
-            default:
-              DONT_OCCUR_PRINT;
+              r = lirReg(lir);
+              emit(LirRR, "move", r, REG_V0, -1, 0, NULL);
             }
-
-          break;
-          /* For fixing a bug about iteration of sibling in parameter passing. */
-          //return currStack;//break;
         }
-        case ConstantK:
+      break;
+    }
+
+    case ArrayK:
+    {
+      int offset, addr = elementAddress(t, &offset);
+      r = lirReg(lir);
+      emit(LirLoad, "lw", r, addr, -1, offset, NULL);
+      break;
+    }
+    case VariableK:
+    {
+      SymbolInfo *sym = t->symbolInfo;
+      if(inRegister(sym))
+        return symbolReg(sym);
+      r = lirReg(lir);
+      switch(sym->nodeType)
         {
-          fprintf(codeStream, "li $v0, %d\n", t->attr.NUM);
-          
+        case IntT:
+          if(globalLabel(sym) != NULL)
+            emit(LirLoad, "lw", r, -1, -1, 0, globalLabel(sym));
+          else
+            emit(LirLoad, "lw", r, REG_GP, -1, sym->attr.intInfo.memloc, NULL);
+          break;
+        case IntArrayT:
+          if(sym->attr.arrInfo.globalFlag && globalLabel(sym) != NULL)
+            emit(LirRL, "la", r, -1, -1, 0, globalLabel(sym));
+          else if(sym->attr.arrInfo.globalFlag)
+            emit(LirRRI, "addiu", r, REG_GP, -1, sym->attr.arrInfo.memloc, NULL);
+          else
+            // below the spill slots, which are only known later
+            emit(LirRRI, "addiu", r, REG_FP, -1, sym->attr.arrInfo.memloc, NULL)->area = FrameLocal;
           break;
-          /* For fixing a bug about iteration of sibling in parameter passing. */
-          //return currStack;//break;
-        }
-
         default:
           DONT_OCCUR_PRINT;
         }
+      break;
     }
-  return currStack;
+    case ConstantK:
+    {
+      r = lirReg(lir);
+      emit(LirRI, "li", r, -1, -1, t->attr.NUM, NULL);
+      break;
+    }
+
+    default:
+      DONT_OCCUR_PRINT;
+    }
+  return r;
 }
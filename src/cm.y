@@ -25,6 +25,7 @@ int yyerror(char*);
 %token ID NUM
 %token ELSE IF INT RETURN VOID WHILE
 %token PLUS MINUS TIMES OVER
+%token SHR /* arithmetic shift right; made only by the optimizer */
 %token LT LE GT GE EQ NE
 %token ASSIGN SEMI COMMA
 %token LPAREN RPAREN LBRACK RBRACK LBRACE RBRACE
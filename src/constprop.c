@@ -0,0 +1,395 @@
+/****************************************************/
+/* File: constprop.c                                */
+/* Conditional constant propagation for the         */
+/* C- compiler                                      */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "cfg.h"
+#include "constprop.h"
+
+/* Lattice value of a scalar:
+ * Top (no value seen yet) > Const > Bottom (varies)
+ */
+typedef enum { LatTop, LatConst, LatBottom } LatKind;
+
+typedef struct
+{
+  LatKind kind;
+  int value;
+} LatVal;
+
+static const LatVal latTop = { LatTop, 0 };
+static const LatVal latBottom = { LatBottom, 0 };
+
+/* state of one run of the pass */
+static Cfg cfg;
+static LatVal **blockIn;   /* block id -> values on entry, NULL if not yet reached */
+static LatVal *condVal;    /* block id -> value of its branch condition */
+static int rewrites;
+
+static LatVal latConst(int value)
+{
+  LatVal v;
+  v.kind = LatConst;
+  v.value = value;
+  return v;
+}
+
+static LatVal meet(LatVal a, LatVal b)
+{
+  if (a.kind == LatTop) return b;
+  if (b.kind == LatTop) return a;
+  if (a.kind == LatConst && b.kind == LatConst && a.value == b.value)
+    return a;
+  return latBottom;
+}
+
+/* Folds a binary operator with C- (32-bit wraparound)
+ * semantics. Division by zero and the one overflowing
+ * quotient are left to run time.
+ */
+static LatVal foldBinary(TokenType op, LatVal l, LatVal r)
+{
+  unsigned int a = (unsigned int) l.value, b = (unsigned int) r.value;
+
+  if (l.kind == LatBottom || r.kind == LatBottom)
+    return latBottom;
+  if (l.kind == LatTop || r.kind == LatTop)
+    return latTop;
+
+  switch (op)
+    {
+    case PLUS: return latConst((int) (a + b));
+    case MINUS: return latConst((int) (a - b));
+    case TIMES: return latConst((int) (a * b));
+    case OVER:
+      if (r.value == 0 || (l.value == (int) 0x80000000 && r.value == -1))
+        return latBottom;
+      return latConst(l.value / r.value);
+    case SHR: return latConst(l.value >> (r.value & 31));
+    case LT: return latConst(l.value < r.value);
+    case LE: return latConst(l.value <= r.value);
+    case GT: return latConst(l.value > r.value);
+    case GE: return latConst(l.value >= r.value);
+    case EQ: return latConst(l.value == r.value);
+    case NE: return latConst(l.value != r.value);
+    default:
+      DONT_OCCUR_PRINT;
+      return latBottom;
+    }
+}
+
+/* Evaluates an expression in the order cgen emits it,
+ * updating env for assignments to tracked scalars.
+ * With rewrite set, uses of scalars with a known value
+ * and side-effect free subtrees with a known value are
+ * replaced by constants.
+ */
+static LatVal evalExpr(TreeNode *t, LatVal *env, int rewrite)
+{
+  LatVal v = latBottom;
+  int idx;
+
+  switch (t->nodeKind)
+    {
+    case ConstantK:
+      return latConst(t->attr.NUM);
+
+    case VariableK:
+      idx = cfgVarIndex(cfg, t->symbolInfo);
+      if (idx < 0)
+        return latBottom;
+      v = env[idx];
+      if (rewrite && v.kind == LatConst)
+        {
+          setConstantNode(t, v.value);
+          rewrites++;
+        }
+      return v;
+
+    case ArrayK:
+      evalExpr(t->attr.arr.arr_expr, env, rewrite);
+      return latBottom;
+
+    case AssignExpressionK:
+    {
+      TreeNode *var = t->attr.assignStmt._var;
+      v = evalExpr(t->attr.assignStmt.expr, env, rewrite);
+      if (var->nodeKind == VariableK)
+        {
+          idx = cfgVarIndex(cfg, var->symbolInfo);
+          if (idx >= 0)
+            env[idx] = v;
+        }
+      else if (var->nodeKind == ArrayK)
+        evalExpr(var->attr.arr.arr_expr, env, rewrite);
+      else
+        DONT_OCCUR_PRINT;
+      return v;
+    }
+
+    case ComparisonExpressionK:
+    {
+      LatVal l = evalExpr(t->attr.cmpExpr.lexpr, env, rewrite);
+      LatVal r = evalExpr(t->attr.cmpExpr.rexpr, env, rewrite);
+      v = foldBinary(t->attr.cmpExpr.op->attr.TOK, l, r);
+      break;
+    }
+    case AdditiveExpressionK:
+    {
+      LatVal l = evalExpr(t->attr.addExpr.lexpr, env, rewrite);
+      LatVal r = evalExpr(t->attr.addExpr.rexpr, env, rewrite);
+      v = foldBinary(t->attr.addExpr.op->attr.TOK, l, r);
+      break;
+    }
+    case MultiplicativeExpressionK:
+    {
+      LatVal l = evalExpr(t->attr.multExpr.lexpr, env, rewrite);
+      LatVal r = evalExpr(t->attr.multExpr.rexpr, env, rewrite);
+      v = foldBinary(t->attr.multExpr.op->attr.TOK, l, r);
+      break;
+    }
+
+    case CallK:
+    {
+      TreeNode *arg;
+      for (arg = t->attr.call.expr_list; arg != NULL; arg = arg->sibling)
+        evalExpr(arg, env, rewrite);
+      return latBottom;
+    }
+
+    default:
+      DONT_OCCUR_PRINT;
+      return latBottom;
+    }
+
+  if (rewrite && v.kind == LatConst && !hasSideEffect(t))
+    {
+      setConstantNode(t, v.value);
+      rewrites++;
+    }
+  return v;
+}
+
+/* Merges env into the entry values of block b.
+ * Returns TRUE if b has to be (re)visited.
+ */
+static int propagate(CfgBlock b, LatVal *env)
+{
+  int i, changed = FALSE;
+
+  if (blockIn[b->id] == NULL)
+    {
+      MALLOC(blockIn[b->id], (cfg->nVars + 1) * sizeof(LatVal));
+      memcpy(blockIn[b->id], env, cfg->nVars * sizeof(LatVal));
+      return TRUE;
+    }
+  for (i = 0; i < cfg->nVars; ++i)
+    {
+      LatVal m = meet(blockIn[b->id][i], env[i]);
+      if (m.kind != blockIn[b->id][i].kind)
+        {
+          blockIn[b->id][i] = m;
+          changed = TRUE;
+        }
+    }
+  return changed;
+}
+
+/* Evaluates block b from its entry values, leaving the
+ * exit values in env and the branch condition in condVal
+ */
+static void evalBlock(CfgBlock b, LatVal *env, int rewrite)
+{
+  int i;
+  memcpy(env, blockIn[b->id], cfg->nVars * sizeof(LatVal));
+  for (i = 0; i < b->nItems; ++i)
+    evalExpr(b->items[i], env, rewrite);
+  if (b->term == CfgBranch)
+    condVal[b->id] = evalExpr(b->cond, env, rewrite);
+}
+
+static void solve(void)
+{
+  CfgBlock *worklist;
+  int *queued, nWork = 0, i;
+  LatVal *env;
+
+  MALLOC(worklist, cfg->nBlocks * sizeof(CfgBlock));
+  MALLOC(queued, cfg->nBlocks * sizeof(int));
+  MALLOC(env, (cfg->nVars + 1) * sizeof(LatVal));
+  memset(queued, 0, cfg->nBlocks * sizeof(int));
+
+  // parameters and fresh locals may hold anything on entry
+  for (i = 0; i < cfg->nVars; ++i)
+    env[i] = latBottom;
+  propagate(cfg->blocks[0], env);
+  worklist[nWork++] = cfg->blocks[0];
+  queued[0] = TRUE;
+
+  while (nWork > 0)
+    {
+      CfgBlock b = worklist[--nWork], succ[2] = { NULL, NULL };
+      queued[b->id] = FALSE;
+
+      evalBlock(b, env, FALSE);
+      switch (b->term)
+        {
+        case CfgJump:
+          succ[0] = b->succ[0];
+          break;
+        case CfgBranch:
+          if (condVal[b->id].kind == LatConst)
+            succ[0] = b->succ[condVal[b->id].value ? 0 : 1];
+          else if (condVal[b->id].kind == LatBottom)
+            {
+              succ[0] = b->succ[0];
+              succ[1] = b->succ[1];
+            }
+          break;
+        case CfgReturn:
+          break;
+        }
+
+      for (i = 0; i < 2; ++i)
+        if (succ[i] != NULL && propagate(succ[i], env) && !queued[succ[i]->id])
+          {
+            worklist[nWork++] = succ[i];
+            queued[succ[i]->id] = TRUE;
+          }
+    }
+
+  free(worklist);
+  free(queued);
+  free(env);
+}
+
+/* TRUE if the statement's block was found executable */
+static int reached(TreeNode *stmt)
+{
+  CfgBlock b = cfgStmtBlock(cfg, stmt);
+  return b != NULL && blockIn[b->id] != NULL;
+}
+
+/* Keeps the side effects of a folded condition */
+static TreeNode *keepCondition(TreeNode *cond, TreeNode *rest)
+{
+  if (!hasSideEffect(cond))
+    return rest;
+  return addSibling(newExpressionStatementNode(cond), rest);
+}
+
+static void pruneStmts(TreeNode **link)
+{
+  while (*link != NULL)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          pruneStmts(&t->attr.cmpdStmt.stmt_list);
+          break;
+
+        case ExpressionStatementK:
+        case ReturnStatementK:
+          if (!reached(t))
+            {
+              link = replaceStmt(link, NULL);
+              rewrites++;
+              continue;
+            }
+          break;
+
+        case SelectionStatementK:
+        {
+          LatVal c;
+          if (!reached(t))
+            {
+              link = replaceStmt(link, NULL);
+              rewrites++;
+              continue;
+            }
+          pruneStmts(&t->attr.selectStmt.if_stmt);
+          pruneStmts(&t->attr.selectStmt.else_stmt);
+          c = condVal[cfgStmtBlock(cfg, t)->id];
+          if (c.kind == LatConst)
+            {
+              TreeNode *taken = c.value ? t->attr.selectStmt.if_stmt
+                                        : t->attr.selectStmt.else_stmt;
+              link = replaceStmt(link, keepCondition(t->attr.selectStmt.expr, taken));
+              rewrites++;
+              continue;
+            }
+          break;
+        }
+
+        case IterationStatementK:
+        {
+          LatVal c;
+          if (!reached(t))
+            {
+              link = replaceStmt(link, NULL);
+              rewrites++;
+              continue;
+            }
+          pruneStmts(&t->attr.iterStmt.loop_stmt);
+          c = condVal[cfgStmtBlock(cfg, t)->id];
+          if (c.kind == LatConst && c.value == 0)
+            {
+              // the body never runs; the condition is evaluated once
+              link = replaceStmt(link, keepCondition(t->attr.iterStmt.expr, NULL));
+              rewrites++;
+              continue;
+            }
+          break;
+        }
+
+        default:
+          DONT_OCCUR_PRINT;
+        }
+      link = &t->sibling;
+    }
+}
+
+/* Function constantPropagation propagates constants
+ * assigned to scalar locals over the control-flow
+ * graph of a function, folds the branches whose
+ * condition becomes known and removes statements
+ * that can no longer be reached.
+ */
+int constantPropagation(TreeNode *func)
+{
+  int i;
+  LatVal *env;
+
+  cfg = cfgBuild(func);
+  rewrites = 0;
+  MALLOC(blockIn, cfg->nBlocks * sizeof(LatVal *));
+  MALLOC(condVal, cfg->nBlocks * sizeof(LatVal));
+  MALLOC(env, (cfg->nVars + 1) * sizeof(LatVal));
+  for (i = 0; i < cfg->nBlocks; ++i)
+    {
+      blockIn[i] = NULL;
+      condVal[i] = latTop;
+    }
+
+  solve();
+
+  // rewrite the reached blocks with the final entry values
+  for (i = 0; i < cfg->nBlocks; ++i)
+    if (blockIn[i] != NULL)
+      evalBlock(cfg->blocks[i], env, TRUE);
+  pruneStmts(&func->attr.funcDecl.cmpd_stmt);
+
+  for (i = 0; i < cfg->nBlocks; ++i)
+    free(blockIn[i]);
+  free(blockIn);
+  free(condVal);
+  free(env);
+  cfgFree(cfg);
+  cfg = NULL;
+
+  return rewrites;
+}
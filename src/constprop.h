@@ -0,0 +1,19 @@
+/****************************************************/
+/* File: constprop.h                                */
+/* Conditional constant propagation for the         */
+/* C- compiler                                      */
+/****************************************************/
+
+#ifndef _CONSTPROP_H_
+#define _CONSTPROP_H_
+
+/* Function constantPropagation propagates constants
+ * assigned to scalar locals over the control-flow
+ * graph of a function, folds the branches whose
+ * condition becomes known and removes statements
+ * that can no longer be reached.
+ * Returns the number of rewrites made.
+ */
+int constantPropagation(TreeNode *func);
+
+#endif
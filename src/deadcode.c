@@ -0,0 +1,348 @@
+/****************************************************/
+/* File: deadcode.c                                 */
+/* Liveness-driven dead code elimination for the    */
+/* C- compiler                                      */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "cfg.h"
+#include "deadcode.h"
+
+/* state of one run of the pass */
+static Cfg cfg;
+static char **liveIn;     /* block id -> scalars live on entry */
+static char **liveOut;    /* block id -> scalars live on exit */
+static int rewrites;
+
+/* Marks the blocks control can reach from the entry.
+ * A branch on a constant only reaches the side taken.
+ */
+static void markReachable(CfgBlock b)
+{
+  int i;
+  if (b == NULL || b->mark)
+    return;
+  b->mark = TRUE;
+  if (b->term == CfgBranch && b->cond->nodeKind == ConstantK)
+    {
+      markReachable(b->succ[b->cond->attr.NUM ? 0 : 1]);
+      return;
+    }
+  for (i = 0; i < 2; ++i)
+    if (b->term != CfgReturn)
+      markReachable(b->succ[i]);
+}
+
+static void liveExpr(TreeNode **slot, char *live, int rewrite);
+
+/* a sibling list is evaluated first to last, so it is
+ * walked last to first */
+static void liveList(TreeNode **slot, char *live, int rewrite)
+{
+  if (*slot == NULL)
+    return;
+  liveList(&(*slot)->sibling, live, rewrite);
+  liveExpr(slot, live, rewrite);
+}
+
+/* Steps live backwards over the expression at *slot.
+ * With rewrite set, an assignment to a scalar that is
+ * dead afterwards is replaced by its value.
+ */
+static void liveExpr(TreeNode **slot, char *live, int rewrite)
+{
+  TreeNode *t = *slot, **kids[3];
+  int idx, i, n;
+
+  switch (t->nodeKind)
+    {
+    case ConstantK:
+      return;
+
+    case VariableK:
+      idx = cfgVarIndex(cfg, t->symbolInfo);
+      if (idx >= 0)
+        live[idx] = TRUE;
+      return;
+
+    case AssignExpressionK:
+    {
+      TreeNode *var = t->attr.assignStmt._var;
+      if (var->nodeKind == VariableK)
+        {
+          idx = cfgVarIndex(cfg, var->symbolInfo);
+          if (idx >= 0 && !live[idx] && rewrite)
+            {
+              // dead store: only the value (and its side effects) remains
+              *slot = t->attr.assignStmt.expr;
+              (*slot)->sibling = t->sibling;
+              rewrites++;
+              liveExpr(slot, live, rewrite);
+              return;
+            }
+          if (idx >= 0)
+            live[idx] = FALSE;
+        }
+      else if (var->nodeKind == ArrayK)
+        liveExpr(&var->attr.arr.arr_expr, live, rewrite);
+      else
+        DONT_OCCUR_PRINT;
+      liveExpr(&t->attr.assignStmt.expr, live, rewrite);
+      return;
+    }
+
+    case CallK:
+      // a callee cannot reach the scalars of its caller
+      liveList(&t->attr.call.expr_list, live, rewrite);
+      return;
+
+    default:
+      n = treeChildren(t, kids);
+      for (i = n - 1; i >= 0; --i)
+        if (*kids[i] != NULL)
+          liveExpr(kids[i], live, rewrite);
+      return;
+    }
+}
+
+/* Steps live backwards over block b */
+static void liveBlock(CfgBlock b, char *live, int rewrite)
+{
+  int i;
+  if (b->term == CfgBranch)
+    {
+      liveExpr(cfgExprSlot(b->termStmt), live, rewrite);
+      b->cond = *cfgExprSlot(b->termStmt);
+    }
+  for (i = b->nItems - 1; i >= 0; --i)
+    {
+      liveExpr(cfgExprSlot(b->itemStmts[i]), live, rewrite);
+      b->items[i] = *cfgExprSlot(b->itemStmts[i]);
+    }
+}
+
+static void solve(void)
+{
+  int i, j, changed = TRUE;
+  char *live;
+
+  MALLOC(live, cfg->nVars + 1);
+  while (changed)
+    {
+      changed = FALSE;
+      for (i = cfg->nBlocks - 1; i >= 0; --i)
+        {
+          CfgBlock b = cfg->blocks[i];
+          if (!b->mark)
+            continue;
+          memset(liveOut[i], 0, cfg->nVars);
+          if (b->term != CfgReturn)
+            for (j = 0; j < 2; ++j)
+              if (b->succ[j] != NULL)
+                {
+                  int k;
+                  for (k = 0; k < cfg->nVars; ++k)
+                    liveOut[i][k] |= liveIn[b->succ[j]->id][k];
+                }
+          memcpy(live, liveOut[i], cfg->nVars);
+          liveBlock(b, live, FALSE);
+          if (memcmp(live, liveIn[i], cfg->nVars) != 0)
+            {
+              memcpy(liveIn[i], live, cfg->nVars);
+              changed = TRUE;
+            }
+        }
+    }
+  free(live);
+}
+
+/* TRUE if the statement's block can be reached */
+static int reached(TreeNode *stmt)
+{
+  CfgBlock b = cfgStmtBlock(cfg, stmt);
+  return b != NULL && b->mark;
+}
+
+/* TRUE if running the statement list does nothing */
+static int emptyStmts(TreeNode *t)
+{
+  for (; t != NULL; t = t->sibling)
+    if (t->nodeKind != CompoundStatementK || !emptyStmts(t->attr.cmpdStmt.stmt_list))
+      return FALSE;
+  return TRUE;
+}
+
+static void pruneStmts(TreeNode **link)
+{
+  while (*link != NULL)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          pruneStmts(&t->attr.cmpdStmt.stmt_list);
+          break;
+
+        case ExpressionStatementK:
+          if (!reached(t) || t->attr.exprStmt.expr == NULL
+              || !hasSideEffect(t->attr.exprStmt.expr))
+            {
+              link = replaceStmt(link, NULL);
+              rewrites++;
+              continue;
+            }
+          break;
+
+        case ReturnStatementK:
+          if (!reached(t))
+            {
+              link = replaceStmt(link, NULL);
+              rewrites++;
+              continue;
+            }
+          break;
+
+        case SelectionStatementK:
+        {
+          TreeNode *cond = t->attr.selectStmt.expr;
+          if (!reached(t))
+            {
+              link = replaceStmt(link, NULL);
+              rewrites++;
+              continue;
+            }
+          pruneStmts(&t->attr.selectStmt.if_stmt);
+          pruneStmts(&t->attr.selectStmt.else_stmt);
+          if (cond->nodeKind == ConstantK)
+            {
+              link = replaceStmt(link, cond->attr.NUM ? t->attr.selectStmt.if_stmt
+                                                      : t->attr.selectStmt.else_stmt);
+              rewrites++;
+              continue;
+            }
+          if (!hasSideEffect(cond)
+              && emptyStmts(t->attr.selectStmt.if_stmt)
+              && emptyStmts(t->attr.selectStmt.else_stmt))
+            {
+              link = replaceStmt(link, NULL);
+              rewrites++;
+              continue;
+            }
+          break;
+        }
+
+        case IterationStatementK:
+          if (!reached(t)
+              || (t->attr.iterStmt.expr->nodeKind == ConstantK
+                  && t->attr.iterStmt.expr->attr.NUM == 0))
+            {
+              link = replaceStmt(link, NULL);
+              rewrites++;
+              continue;
+            }
+          pruneStmts(&t->attr.iterStmt.loop_stmt);
+          break;
+
+        default:
+          DONT_OCCUR_PRINT;
+        }
+      link = &t->sibling;
+    }
+}
+
+/* TRUE if some VariableK in the tree refers to the symbol */
+static int usesSymbol(TreeNode *t, SymbolInfo *symbolInfo)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == VariableK && t->symbolInfo == symbolInfo)
+        return TRUE;
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        if (usesSymbol(*kids[i], symbolInfo))
+          return TRUE;
+    }
+  return FALSE;
+}
+
+/* Drops the declarations of locals nothing refers to,
+ * which also drops their stack allocation
+ */
+static void pruneDecls(TreeNode *t, TreeNode *body)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == CompoundStatementK)
+        {
+          TreeNode **link = &t->attr.cmpdStmt.local_decl;
+          while (*link != NULL)
+            if (!usesSymbol(body, (*link)->attr.varDecl._var->symbolInfo))
+              {
+                *link = (*link)->sibling;
+                rewrites++;
+              }
+            else
+              link = &(*link)->sibling;
+          pruneDecls(t->attr.cmpdStmt.stmt_list, body);
+          continue;
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        pruneDecls(*kids[i], body);
+    }
+}
+
+/* Function eliminateDeadCode removes unreachable
+ * statements, dead stores and dead pure computations
+ * of a function
+ */
+int eliminateDeadCode(TreeNode *func)
+{
+  int i;
+  char *live;
+
+  cfg = cfgBuild(func);
+  rewrites = 0;
+  MALLOC(liveIn, cfg->nBlocks * sizeof(char *));
+  MALLOC(liveOut, cfg->nBlocks * sizeof(char *));
+  MALLOC(live, cfg->nVars + 1);
+  for (i = 0; i < cfg->nBlocks; ++i)
+    {
+      MALLOC(liveIn[i], cfg->nVars + 1);
+      MALLOC(liveOut[i], cfg->nVars + 1);
+      memset(liveIn[i], 0, cfg->nVars + 1);
+      memset(liveOut[i], 0, cfg->nVars + 1);
+    }
+
+  markReachable(cfg->blocks[0]);
+  solve();
+
+  for (i = 0; i < cfg->nBlocks; ++i)
+    if (cfg->blocks[i]->mark)
+      {
+        memcpy(live, liveOut[i], cfg->nVars);
+        liveBlock(cfg->blocks[i], live, TRUE);
+      }
+  pruneStmts(&func->attr.funcDecl.cmpd_stmt);
+  pruneDecls(func->attr.funcDecl.cmpd_stmt, func->attr.funcDecl.cmpd_stmt);
+
+  for (i = 0; i < cfg->nBlocks; ++i)
+    {
+      free(liveIn[i]);
+      free(liveOut[i]);
+    }
+  free(liveIn);
+  free(liveOut);
+  free(live);
+  cfgFree(cfg);
+  cfg = NULL;
+
+  return rewrites;
+}
@@ -0,0 +1,20 @@
+/****************************************************/
+/* File: deadcode.h                                 */
+/* Liveness-driven dead code elimination for the    */
+/* C- compiler                                      */
+/****************************************************/
+
+#ifndef _DEADCODE_H_
+#define _DEADCODE_H_
+
+/* Function eliminateDeadCode removes the statements
+ * of a function that cannot be reached, the
+ * assignments to scalar locals whose value is never
+ * read and the side-effect free expression statements
+ * left behind, then the declarations of locals no
+ * longer referenced. Calls, input and output are kept.
+ * Returns the number of rewrites made.
+ */
+int eliminateDeadCode(TreeNode *func);
+
+#endif
@@ -0,0 +1,545 @@
+/****************************************************/
+/* File: fusion.c                                   */
+/* Loop fusion and fission for the C- compiler      */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "fusion.h"
+
+/* Largest body, in tree nodes, fusion builds or fission
+ * leaves when loops are unrolled: unrolling takes bodies
+ * up to 48 nodes, after strength reduction has added its
+ * pointer steps. Two loops that unroll beat one that
+ * does not, so fusion stays below it.
+ */
+#define PART_SIZE 32
+
+/* largest body fusion builds when nothing is unrolled */
+#define FUSED_MAX_SIZE 100
+
+/* An array element a body reads or writes */
+typedef struct
+{
+  SymbolInfo *arr;
+  int write;
+  int affine;      /* the index is iv + k */
+  int k;
+} Access;
+
+/* What a part of a loop body touches */
+typedef struct
+{
+  int nAccs, capAccs;
+  Access *accs;
+  int nReads, capReads;
+  SymbolInfo **reads;
+  int nWrites, capWrites;
+  SymbolInfo **writes;
+  int impure;      /* has a call or a return */
+} Effects;
+
+/* while (iv op bound) { ...; iv = iv + step; } */
+typedef struct
+{
+  SymbolInfo *iv;
+  char *name;
+  TokenType op;
+  TreeNode *bound;
+  int step;
+  TreeNode *start;       /* the constant iv holds on entry, or NULL */
+  TreeNode **stepLink;   /* the link to the step, last in the body */
+} Counted;
+
+static SymbolInfo *iv;   /* the counter of the body being collected */
+static int total;
+
+static void addSymbol(SymbolInfo ***syms, int *n, int *cap, SymbolInfo *sym)
+{
+  int i;
+  for (i = 0; i < *n; ++i)
+    if ((*syms)[i] == sym)
+      return;
+  GROW(*syms, *n, *cap);
+  (*syms)[(*n)++] = sym;
+}
+
+static int hasSymbol(SymbolInfo **syms, int n, SymbolInfo *sym)
+{
+  int i;
+  for (i = 0; i < n; ++i)
+    if (syms[i] == sym)
+      return TRUE;
+  return FALSE;
+}
+
+static void addAccess(Effects *e, TreeNode *arr, int write)
+{
+  Access *a;
+
+  GROW(e->accs, e->nAccs, e->capAccs);
+  a = &e->accs[e->nAccs++];
+  a->arr = arr->attr.arr._var->symbolInfo;
+  a->write = write;
+  a->affine = indexOffset(arr->attr.arr.arr_expr, iv, &a->k);
+}
+
+/* Collects the effects of t (not its siblings) */
+static void collect(TreeNode *t, Effects *e)
+{
+  TreeNode **kids[3], *kid;
+  int i, n;
+
+  switch (t->nodeKind)
+    {
+    case CallK:
+    case ReturnStatementK:
+      e->impure = TRUE;
+      break;
+    case VariableK:
+      if (t->symbolInfo->nodeType == IntT)
+        addSymbol(&e->reads, &e->nReads, &e->capReads, t->symbolInfo);
+      return;
+    case ArrayK:
+      addAccess(e, t, FALSE);
+      collect(t->attr.arr.arr_expr, e);
+      return;
+    case AssignExpressionK:
+    {
+      TreeNode *var = t->attr.assignStmt._var;
+      if (var->nodeKind == ArrayK)
+        {
+          addAccess(e, var, TRUE);
+          collect(var->attr.arr.arr_expr, e);
+        }
+      else
+        addSymbol(&e->writes, &e->nWrites, &e->capWrites, var->symbolInfo);
+      collect(t->attr.assignStmt.expr, e);
+      return;
+    }
+    default:
+      break;
+    }
+  n = treeChildren(t, kids);
+  for (i = 0; i < n; ++i)
+    for (kid = *kids[i]; kid != NULL; kid = kid->sibling)
+      collect(kid, e);
+}
+
+/* Collects the statements from first up to (not
+ * including) stop
+ */
+static void collectStmts(TreeNode *first, TreeNode *stop, SymbolInfo *counter, Effects *e)
+{
+  iv = counter;
+  for (; first != stop; first = first->sibling)
+    collect(first, e);
+}
+
+static void freeEffects(Effects *e)
+{
+  free(e->accs);
+  free(e->reads);
+  free(e->writes);
+}
+
+static int mayAlias(SymbolInfo *a, SymbolInfo *b)
+{
+  return a == b || a->attr.arrInfo.isParam || b->attr.arrInfo.isParam;
+}
+
+/* TRUE if running each iteration of second right after
+ * the same iteration of first gives what running all of
+ * first and then all of second gave. An element first
+ * touches at iteration q and second at iteration p < q
+ * would be touched in the other order; with subscripts
+ * iv + k1 and iv + k2 that happens for q - p = (k2 - k1) / step.
+ */
+static int independent(Effects *first, Effects *second, int step)
+{
+  int i, j;
+
+  if (first->impure || second->impure)
+    return FALSE;
+  for (i = 0; i < first->nWrites; ++i)
+    if (hasSymbol(second->reads, second->nReads, first->writes[i])
+        || hasSymbol(second->writes, second->nWrites, first->writes[i]))
+      return FALSE;
+  for (i = 0; i < second->nWrites; ++i)
+    if (hasSymbol(first->reads, first->nReads, second->writes[i]))
+      return FALSE;
+
+  for (i = 0; i < first->nAccs; ++i)
+    for (j = 0; j < second->nAccs; ++j)
+      {
+        Access *a = &first->accs[i], *b = &second->accs[j];
+        int d;
+        if (!a->write && !b->write)
+          continue;
+        if (!mayAlias(a->arr, b->arr))
+          continue;
+        if (a->arr != b->arr || !a->affine || !b->affine)
+          return FALSE;
+        d = b->k - a->k;
+        if (d % step == 0 && d / step > 0)
+          return FALSE;
+      }
+  return TRUE;
+}
+
+/* Recognizes a loop counted by a local scalar with a
+ * fixed bound and a single constant step at its end
+ */
+static int countedLoop(TreeNode *head, TreeNode *loop, Counted *c)
+{
+  TreeNode *test = loop->attr.iterStmt.expr, *body = loop->attr.iterStmt.loop_stmt, **link, *t;
+
+  if (test->nodeKind != ComparisonExpressionK || test->attr.cmpExpr.op->attr.TOK == EQ
+      || test->attr.cmpExpr.lexpr->nodeKind != VariableK)
+    return FALSE;
+  c->iv = test->attr.cmpExpr.lexpr->symbolInfo;
+  c->name = test->attr.cmpExpr.lexpr->attr.ID;
+  c->op = test->attr.cmpExpr.op->attr.TOK;
+  c->bound = test->attr.cmpExpr.rexpr;
+  if (c->iv->nodeType != IntT || c->iv->attr.intInfo.globalFlag)
+    return FALSE;
+  if (c->bound->nodeKind != ConstantK
+      && (c->bound->nodeKind != VariableK || c->bound->symbolInfo->nodeType != IntT
+          || c->bound->symbolInfo == c->iv))
+    return FALSE;
+
+  if (body == NULL || body->nodeKind != CompoundStatementK
+      || body->attr.cmpdStmt.local_decl != NULL || body->attr.cmpdStmt.stmt_list == NULL)
+    return FALSE;
+  for (link = &body->attr.cmpdStmt.stmt_list; (*link)->sibling != NULL; link = &(*link)->sibling)
+    if (assignsSymbol(*link, c->iv))
+      return FALSE;
+  if (!constantStep(*link, c->iv, &c->step) || c->step == 0)
+    return FALSE;
+  c->stepLink = link;
+  if (c->bound->nodeKind == VariableK)
+    for (t = body->attr.cmpdStmt.stmt_list; t != NULL; t = t->sibling)
+      if (assignsSymbol(t, c->bound->symbolInfo))
+        return FALSE;
+  c->start = constantOnEntry(head, loop, c->iv);
+  return TRUE;
+}
+
+static int sameBound(TreeNode *a, TreeNode *b)
+{
+  if (a->nodeKind == ConstantK)
+    return b->nodeKind == ConstantK && a->attr.NUM == b->attr.NUM;
+  return b->nodeKind == VariableK && a->symbolInfo == b->symbolInfo;
+}
+
+static void renameCounter(TreeNode *t, SymbolInfo *from, SymbolInfo *to, char *name)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == VariableK && t->symbolInfo == from)
+        {
+          t->symbolInfo = to;
+          t->attr.ID = name;
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        renameCounter(*kids[i], from, to, name);
+    }
+}
+
+/* Fuses the loop at *link with the loop second. What is
+ * in between may only assign constants: to the counter
+ * of second, or to scalars the first loop does not use,
+ * which move in front of it.
+ *   while (i < n) { A; i = i + 1; } s = 0; j = 0; while (j < n) { B; j = j + 1; }
+ * becomes
+ *   s = 0; while (i < n) { A; B[j := i]; i = i + 1; } j = i;
+ */
+static int fusePair(TreeNode *head, TreeNode **link, TreeNode *second)
+{
+  Counted c1, c2;
+  Effects e1 = { 0 }, e2 = { 0 };
+  TreeNode *first = *link, *body1, *body2, *stmts, *t, *moved = NULL, *next;
+  int ok;
+
+  if (!countedLoop(head, first, &c1) || !countedLoop(head, second, &c2))
+    return FALSE;
+  if (c1.start == NULL || c2.start == NULL || c1.start->attr.NUM != c2.start->attr.NUM
+      || c1.op != c2.op || c1.step != c2.step || !sameBound(c1.bound, c2.bound))
+    return FALSE;
+  body1 = first->attr.iterStmt.loop_stmt->attr.cmpdStmt.stmt_list;
+  body2 = second->attr.iterStmt.loop_stmt->attr.cmpdStmt.stmt_list;
+  if (countTreeNodes(body1) - countTreeNodes(*c1.stepLink) + countTreeNodes(body2)
+      > (UnrollFactor > 1 ? PART_SIZE : FUSED_MAX_SIZE))
+    return FALSE;
+
+  collectStmts(body1, *c1.stepLink, c1.iv, &e1);
+  collectStmts(body2, *c2.stepLink, c2.iv, &e2);
+  ok = independent(&e1, &e2, c1.step);
+  if (c1.iv != c2.iv)
+    ok = ok && !hasSymbol(e1.reads, e1.nReads, c2.iv) && !hasSymbol(e1.writes, e1.nWrites, c2.iv)
+      && !hasSymbol(e2.reads, e2.nReads, c1.iv) && !hasSymbol(e2.writes, e2.nWrites, c1.iv);
+  for (t = first->sibling; ok && t != second; t = t->sibling)
+    {
+      SymbolInfo *var = t->attr.exprStmt.expr->attr.assignStmt._var->symbolInfo;
+      ok = var == c2.iv
+        || (var != c1.iv && (c1.bound->nodeKind != VariableK || var != c1.bound->symbolInfo)
+            && !hasSymbol(e1.reads, e1.nReads, var) && !hasSymbol(e1.writes, e1.nWrites, var));
+    }
+  freeEffects(&e1);
+  freeEffects(&e2);
+  if (!ok)
+    return FALSE;
+
+  // B goes between A and the step
+  if (body2 != *c2.stepLink)
+    {
+      stmts = body2;
+      *c2.stepLink = NULL;
+      renameCounter(stmts, c2.iv, c1.iv, c1.name);
+      while (body2->sibling != NULL)
+        body2 = body2->sibling;
+      body2->sibling = *c1.stepLink;
+      *c1.stepLink = stmts;
+    }
+
+  // the other constants are set before the loop
+  for (t = first->sibling; t != second; t = next)
+    {
+      next = t->sibling;
+      if (t->attr.exprStmt.expr->attr.assignStmt._var->symbolInfo != c2.iv)
+        {
+          t->sibling = NULL;
+          moved = addSibling(moved, t);
+        }
+    }
+  if (moved != NULL)
+    {
+      *link = moved;
+      while (moved->sibling != NULL)
+        moved = moved->sibling;
+      moved->sibling = first;
+    }
+
+  // both counters leave at the same value
+  first->sibling = second->sibling;
+  if (c1.iv != c2.iv)
+    {
+      TreeNode *assign = newAssignExpressionNode(newSymbolUseNode(c2.name, c2.iv),
+                                                 newSymbolUseNode(c1.name, c1.iv));
+      TreeNode *stmt = newExpressionStatementNode(assign);
+      assign->nodeType = IntT;
+      stmt->nodeType = NoneT;
+      stmt->sibling = first->sibling;
+      first->sibling = stmt;
+    }
+  total++;
+  return TRUE;
+}
+
+/* A statement that only assigns a constant to a scalar */
+static int constantAssign(TreeNode *t)
+{
+  TreeNode *e = t->nodeKind == ExpressionStatementK ? t->attr.exprStmt.expr : NULL;
+  return e != NULL && e->nodeKind == AssignExpressionK
+    && e->attr.assignStmt._var->nodeKind == VariableK
+    && e->attr.assignStmt.expr->nodeKind == ConstantK;
+}
+
+static void fuseStmts(TreeNode **list)
+{
+  TreeNode **link;
+
+  for (link = list; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link, *next;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          fuseStmts(&t->attr.cmpdStmt.stmt_list);
+          break;
+        case SelectionStatementK:
+          fuseStmts(&t->attr.selectStmt.if_stmt);
+          fuseStmts(&t->attr.selectStmt.else_stmt);
+          break;
+        case IterationStatementK:
+          fuseStmts(&t->attr.iterStmt.loop_stmt);
+          // a loop may take in several that follow
+          for (;;)
+            {
+              for (next = t->sibling; next != NULL && constantAssign(next); next = next->sibling)
+                ;
+              if (next == NULL || next->nodeKind != IterationStatementK)
+                break;
+              fuseStmts(&next->attr.iterStmt.loop_stmt);
+              if (!fusePair(*list, link, next))
+                break;
+              while (*link != t)
+                link = &(*link)->sibling;
+            }
+          break;
+        default:
+          break;
+        }
+    }
+}
+
+/* TRUE if stmts[lo..mid) may all run before stmts[mid..hi) */
+static int canSplit(TreeNode **stmts, int lo, int mid, int hi, Counted *c)
+{
+  Effects e1 = { 0 }, e2 = { 0 };
+  int ok;
+
+  collectStmts(stmts[lo], stmts[mid], c->iv, &e1);
+  collectStmts(stmts[mid], stmts[hi], c->iv, &e2);
+  ok = independent(&e1, &e2, c->step);
+  freeEffects(&e1);
+  freeEffects(&e2);
+  return ok;
+}
+
+/* Cuts stmts[lo..hi) where the parts are closest in size,
+ * until every part fits PART_SIZE; appends the cuts in
+ * order. FALSE if some part cannot be cut further.
+ */
+static int planSplit(TreeNode **stmts, int *sizes, int lo, int hi, Counted *c, int *cuts, int *nCuts)
+{
+  int size = 0, before = 0, best = -1, cut = -1, mid;
+
+  for (mid = lo; mid < hi; ++mid)
+    size += sizes[mid];
+  if (size <= PART_SIZE)
+    return TRUE;
+  for (mid = lo + 1; mid < hi; ++mid)
+    {
+      int diff;
+      before += sizes[mid - 1];
+      diff = before > size - before ? 2 * before - size : size - 2 * before;
+      if ((best < 0 || diff < best) && canSplit(stmts, lo, mid, hi, c))
+        {
+          best = diff;
+          cut = mid;
+        }
+    }
+  if (cut < 0 || !planSplit(stmts, sizes, lo, cut, c, cuts, nCuts))
+    return FALSE;
+  cuts[(*nCuts)++] = cut;
+  return planSplit(stmts, sizes, cut, hi, c, cuts, nCuts);
+}
+
+/* Splits a loop whose body is too large to unroll into
+ * loops over the same range that can be, when the
+ * dependence test allows and there are fewer of them
+ * than UnrollFactor, so that the loop overhead still
+ * drops:
+ *   while (i < n) { A; B; i = i + 1; }
+ * becomes
+ *   while (i < n) { A; i = i + 1; } i = start; while (i < n) { B; i = i + 1; }
+ * The counter must start at a known constant.
+ */
+static void splitLoop(TreeNode *head, TreeNode *loop)
+{
+  Counted c;
+  TreeNode **stmts, *t, *after, *last = loop;
+  int *sizes, *cuts, n = 0, nCuts = 0, i, ok;
+
+  if (UnrollFactor <= 1 || !countedLoop(head, loop, &c) || c.start == NULL)
+    return;
+  t = loop->attr.iterStmt.loop_stmt->attr.cmpdStmt.stmt_list;
+  if (countTreeNodes(t) - countTreeNodes(*c.stepLink) <= PART_SIZE)
+    return;
+
+  // stmts[n] is the step
+  for (; t != *c.stepLink; t = t->sibling)
+    n++;
+  MALLOC(stmts, (n + 1) * sizeof(*stmts));
+  MALLOC(sizes, n * sizeof(*sizes));
+  MALLOC(cuts, n * sizeof(*cuts));
+  for (i = 0, t = loop->attr.iterStmt.loop_stmt->attr.cmpdStmt.stmt_list; i <= n; ++i, t = t->sibling)
+    {
+      stmts[i] = t;
+      if (i < n)
+        sizes[i] = countTreeNodes(t) - countTreeNodes(t->sibling);
+    }
+  ok = planSplit(stmts, sizes, 0, n, &c, cuts, &nCuts) && nCuts > 0 && nCuts + 1 < UnrollFactor;
+
+  // the first part stays; each other part gets a copy
+  // of the test and the step, after resetting the counter
+  after = loop->sibling;
+  if (ok)
+    stmts[cuts[0] - 1]->sibling = stmts[n];
+  for (i = 0; ok && i < nCuts; ++i)
+    {
+      SymbolMap map = { 0, 0, NULL, NULL };
+      TreeNode *body, *next, *init, *assign;
+      int end = i + 1 < nCuts ? cuts[i + 1] : n;
+
+      stmts[end - 1]->sibling = cloneTree(stmts[n], &map);
+      body = newCompoundStatementNode(NULL, stmts[cuts[i]]);
+      body->nodeType = NoneT;
+      next = newIterationStatementNode(cloneTree(loop->attr.iterStmt.expr, &map), body);
+      next->nodeType = NoneT;
+      free(map.from);
+      free(map.to);
+
+      assign = newAssignExpressionNode(newSymbolUseNode(c.name, c.iv), newIntConstantNode(c.start->attr.NUM));
+      assign->nodeType = IntT;
+      init = newExpressionStatementNode(assign);
+      init->nodeType = NoneT;
+      last->sibling = init;
+      init->sibling = next;
+      last = next;
+      total++;
+    }
+  last->sibling = after;
+  free(stmts);
+  free(sizes);
+  free(cuts);
+}
+
+static void splitStmts(TreeNode **link)
+{
+  TreeNode *head = *link;
+
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          splitStmts(&t->attr.cmpdStmt.stmt_list);
+          break;
+        case SelectionStatementK:
+          splitStmts(&t->attr.selectStmt.if_stmt);
+          splitStmts(&t->attr.selectStmt.else_stmt);
+          break;
+        case IterationStatementK:
+          splitStmts(&t->attr.iterStmt.loop_stmt);
+          splitLoop(head, t);
+          break;
+        default:
+          break;
+        }
+    }
+}
+
+/* Function fuseLoops merges adjacent loops over the
+ * same range
+ */
+int fuseLoops(TreeNode *func)
+{
+  total = 0;
+  fuseStmts(&func->attr.funcDecl.cmpd_stmt);
+  return total;
+}
+
+/* Function splitLoops splits loops too large to unroll */
+int splitLoops(TreeNode *func)
+{
+  total = 0;
+  splitStmts(&func->attr.funcDecl.cmpd_stmt);
+  return total;
+}
@@ -0,0 +1,25 @@
+/****************************************************/
+/* File: fusion.h                                   */
+/* Loop fusion and fission for the C- compiler      */
+/****************************************************/
+
+#ifndef _FUSION_H_
+#define _FUSION_H_
+
+/* Function fuseLoops merges adjacent counted while
+ * loops with the same range into one loop when no
+ * element or scalar one of them uses would then be
+ * read or written in a different order, and the merged
+ * body is still small enough to unroll. Returns the
+ * number of loops merged away.
+ */
+int fuseLoops(TreeNode *func);
+
+/* Function splitLoops splits counted while loops too
+ * large to unroll into a few consecutive loops over the
+ * same range small enough to be, under the same
+ * dependence test. Returns the number of loops added.
+ */
+int splitLoops(TreeNode *func);
+
+#endif
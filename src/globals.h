@@ -49,6 +49,7 @@ ELSE IF INT RETURN VOID WHILE
 
 // special symbols
 PLUS(+) MINUS(-) TIMES(*) OVER(/)
+SHR(>>) (never scanned; the optimizer makes it from OVER)
 LT(<) LE (<=) GT(>) GE(>=) EQ(==) NE(!=)
 ASSIGN(=) SEMI(;) COMMA(,)
 LPAREN(() RPAREN()) LBRACK([) RBRACK(]) LBRACE({) RBRACE(})
@@ -113,14 +114,14 @@ typedef struct
       // VariableDeclarationK
       struct {
           int isParam;
-          int memloc; // real location: memloc($fp)
+          int memloc; // real location: memloc($fp), memloc($gp) for a global
           int globalFlag;
       } intInfo;
 
       // ArrayDeclarationK
       struct {
           int isParam;
-          int memloc; // real location: memloc($fp)
+          int memloc; // real location: memloc($fp), memloc($gp) for a global
           int globalFlag;
           int arrLen;
       } arrInfo;
@@ -294,6 +295,40 @@ extern int TraceAnalyze;
  */
 extern int TraceCode;
 
+/* TraceOptimize = TRUE causes the optimizer to report
+ * what it removed to the listing file
+ */
+extern int TraceOptimize;
+
+/* Optimize = TRUE runs the optimizer on the decorated
+ * syntax tree before code generation (-O0 turns it off)
+ */
+extern int Optimize;
+
+/* UnrollFactor is how many iterations an unrolled
+ * loop runs per test (-funroll=N, 1 turns it off)
+ */
+extern int UnrollFactor;
+
+/* BoundsCheck = TRUE stops the program when an array
+ * of known length is indexed out of range
+ * (-fbounds-check)
+ */
+extern int BoundsCheck;
+
+/* RegisterArgs = TRUE passes the first four arguments
+ * of a call in $a0-$a3 and only the rest on the stack
+ * (-fstack-args passes them all on the stack)
+ */
+extern int RegisterArgs;
+
+/* IfConvertLimit is the most instructions the two arms
+ * of an if that assigns one variable may take for it to
+ * become a conditional move (-fifconvert=N, 0 turns it
+ * off)
+ */
+extern int IfConvertLimit;
+
 /* Error = TRUE prevents further passes if an error occurs */
 extern int Error; 
 #endif
@@ -0,0 +1,269 @@
+/****************************************************/
+/* File: idiom.c                                    */
+/* Loop idiom recognition for the C- compiler       */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "idiom.h"
+
+/* the runtime routines cgen emits for the idioms */
+static SymbolInfo *fillSym;   /* void _fill(int a[], int n, int v) */
+static SymbolInfo *copySym;   /* void _copy(int dst[], int src[], int n) */
+
+static int total;
+
+static SymbolInfo *runtimeSymbol(ExpType p0, ExpType p1, ExpType p2)
+{
+  SymbolInfo *sym;
+
+  MALLOC(sym, sizeof(*sym));
+  memset(sym, 0, sizeof(*sym));
+  sym->nodeType = FuncT;
+  sym->attr.funcInfo.retType = VoidT;
+  sym->attr.funcInfo.paramLen = 3;
+  MALLOC(sym->attr.funcInfo.paramTypeList, 3 * sizeof(ExpType));
+  sym->attr.funcInfo.paramTypeList[0] = p0;
+  sym->attr.funcInfo.paramTypeList[1] = p1;
+  sym->attr.funcInfo.paramTypeList[2] = p2;
+  return sym;
+}
+
+/* TRUE if the stored value is the same in every iteration:
+ * no loads, calls or assignments and no use of iv
+ */
+static int fillValue(TreeNode *t, SymbolInfo *iv)
+{
+  switch (t->nodeKind)
+    {
+    case ConstantK:
+      return TRUE;
+    case VariableK:
+      return t->symbolInfo->nodeType == IntT && t->symbolInfo != iv;
+    case AdditiveExpressionK:
+      return fillValue(t->attr.addExpr.lexpr, iv) && fillValue(t->attr.addExpr.rexpr, iv);
+    case MultiplicativeExpressionK:
+      return fillValue(t->attr.multExpr.lexpr, iv) && fillValue(t->attr.multExpr.rexpr, iv);
+    case ComparisonExpressionK:
+      return fillValue(t->attr.cmpExpr.lexpr, iv) && fillValue(t->attr.cmpExpr.rexpr, iv);
+    default:
+      return FALSE;
+    }
+}
+
+static TreeNode *binaryNode(NodeKind kind, TreeNode *l, TokenType op, TreeNode *r)
+{
+  TreeNode *t;
+
+  switch (kind)
+    {
+    case AdditiveExpressionK:
+      t = newAdditiveExpressionNode(l, newTokenTypeNode(op), r);
+      break;
+    case MultiplicativeExpressionK:
+      t = newMultiplicativeExpressionNode(l, newTokenTypeNode(op), r);
+      break;
+    default:
+      t = newComparisonExpressionNode(l, newTokenTypeNode(op), r);
+      break;
+    }
+  t->nodeType = IntT;
+  return t;
+}
+
+/* e + k, folded when e is a constant */
+static TreeNode *plus(TreeNode *e, int k)
+{
+  if (e->nodeKind == ConstantK)
+    return newIntConstantNode(e->attr.NUM + k);
+  if (k == 0)
+    return e;
+  return binaryNode(AdditiveExpressionK, e, k > 0 ? PLUS : MINUS, newIntConstantNode(k > 0 ? k : -k));
+}
+
+static TreeNode *copyOf(TreeNode *e)
+{
+  return e->nodeKind == ConstantK ? newIntConstantNode(e->attr.NUM)
+    : newSymbolUseNode(e->attr.ID, e->symbolInfo);
+}
+
+/* &arr[index + k] */
+static TreeNode *addressOf(TreeNode *arr, TreeNode *index, int k)
+{
+  TreeNode *base = newSymbolUseNode(arr->attr.ID, arr->symbolInfo);
+
+  index = plus(index, k);
+  if (index->nodeKind == ConstantK)
+    return index->attr.NUM == 0 ? base
+      : binaryNode(AdditiveExpressionK, base, PLUS,
+                   newIntConstantNode(index->attr.NUM * (int) sizeof(int)));
+  return binaryNode(AdditiveExpressionK, base, PLUS,
+                    binaryNode(MultiplicativeExpressionK, index, TIMES,
+                               newIntConstantNode(sizeof(int))));
+}
+
+static TreeNode *callStmt(char *name, SymbolInfo *sym, TreeNode *args)
+{
+  TreeNode *call = newCallNode(newSymbolUseNode(name, sym), args);
+  TreeNode *stmt = newExpressionStatementNode(call);
+  call->nodeType = VoidT;
+  stmt->nodeType = NoneT;
+  return stmt;
+}
+
+/* Replaces the loop at *link when it is
+ *   while (iv < bound) { a[iv + k] = v; iv = iv + 1; }
+ * (or <=) and v does not change, or
+ *   while (iv < bound) { a[iv + k] = b[iv + j]; iv = iv + 1; }
+ * by
+ *   if (iv < bound) { _fill(&a[iv + k], bound - iv, v); iv = bound; }
+ * or the like with _copy. Both routines store in the
+ * order of the loop, so it does not matter whether the
+ * arrays overlap.
+ */
+static void replaceLoop(TreeNode *head, TreeNode **link)
+{
+  TreeNode *loop = *link, *test = loop->attr.iterStmt.expr, *body = loop->attr.iterStmt.loop_stmt;
+  TreeNode *ivUse, *bound, *store, *dst, *src, *start, *from, *count, *args, *repl, *last;
+  SymbolInfo *iv;
+  TokenType op;
+  int k, j, step, inclusive;
+
+  if (test->nodeKind != ComparisonExpressionK || body == NULL)
+    return;
+  op = test->attr.cmpExpr.op->attr.TOK;
+  if (op == LT || op == LE)
+    {
+      ivUse = test->attr.cmpExpr.lexpr;
+      bound = test->attr.cmpExpr.rexpr;
+    }
+  else if (op == GT || op == GE)
+    {
+      ivUse = test->attr.cmpExpr.rexpr;
+      bound = test->attr.cmpExpr.lexpr;
+    }
+  else
+    return;
+  inclusive = op == LE || op == GE;
+  if (ivUse->nodeKind != VariableK || ivUse->symbolInfo->nodeType != IntT)
+    return;
+  iv = ivUse->symbolInfo;
+  if (bound->nodeKind != ConstantK
+      && (bound->nodeKind != VariableK || bound->symbolInfo->nodeType != IntT || bound->symbolInfo == iv))
+    return;
+
+  // the store, then the step, and nothing else
+  if (body->nodeKind == CompoundStatementK)
+    {
+      if (body->attr.cmpdStmt.local_decl != NULL)
+        return;
+      body = body->attr.cmpdStmt.stmt_list;
+    }
+  if (body == NULL || body->sibling == NULL || body->sibling->sibling != NULL)
+    return;
+  if (body->nodeKind != ExpressionStatementK
+      || !constantStep(body->sibling, iv, &step) || step != 1)
+    return;
+  store = body->attr.exprStmt.expr;
+  if (store->nodeKind != AssignExpressionK || store->attr.assignStmt._var->nodeKind != ArrayK)
+    return;
+  dst = store->attr.assignStmt._var;
+  src = store->attr.assignStmt.expr;
+  if (!indexOffset(dst->attr.arr.arr_expr, iv, &k))
+    return;
+  if (src->nodeKind == ArrayK)
+    {
+      if (!indexOffset(src->attr.arr.arr_expr, iv, &j))
+        return;
+    }
+  else if (!fillValue(src, iv))
+    return;
+
+  start = constantOnEntry(head, loop, iv);
+  from = start != NULL ? newIntConstantNode(start->attr.NUM) : newSymbolUseNode(ivUse->attr.ID, iv);
+  if (from->nodeKind == ConstantK && bound->nodeKind == ConstantK)
+    {
+      if (bound->attr.NUM + inclusive - from->attr.NUM <= 0)
+        return;
+      count = newIntConstantNode(bound->attr.NUM + inclusive - from->attr.NUM);
+    }
+  else if (from->nodeKind == ConstantK)
+    count = plus(copyOf(bound), inclusive - from->attr.NUM);
+  else
+    count = binaryNode(AdditiveExpressionK, plus(copyOf(bound), inclusive), MINUS, from);
+
+  if (src->nodeKind == ArrayK)
+    {
+      if (copySym == NULL)
+        copySym = runtimeSymbol(IntArrayT, IntArrayT, IntT);
+      args = addressOf(dst->attr.arr._var, copyOf(from), k);
+      addSibling(args, addressOf(src->attr.arr._var, copyOf(from), j));
+      addSibling(args, count);
+      repl = callStmt("_copy", copySym, args);
+    }
+  else
+    {
+      if (fillSym == NULL)
+        fillSym = runtimeSymbol(IntArrayT, IntT, IntT);
+      args = addressOf(dst->attr.arr._var, copyOf(from), k);
+      addSibling(args, count);
+      addSibling(args, src);
+      repl = callStmt("_fill", fillSym, args);
+    }
+
+  // the counter leaves the loop at the bound
+  last = newAssignExpressionNode(newSymbolUseNode(ivUse->attr.ID, iv), plus(copyOf(bound), inclusive));
+  last->nodeType = IntT;
+  last = newExpressionStatementNode(last);
+  last->nodeType = NoneT;
+  addSibling(repl, last);
+
+  if (from->nodeKind != ConstantK || bound->nodeKind != ConstantK)
+    {
+      repl = newCompoundStatementNode(NULL, repl);
+      repl->nodeType = NoneT;
+      repl = newSelectionStatementNode(binaryNode(ComparisonExpressionK, copyOf(from),
+                                                  inclusive ? LE : LT, copyOf(bound)),
+                                       repl, NULL);
+      repl->nodeType = NoneT;
+    }
+  repl->sibling = loop->sibling;
+  *link = repl;
+  total++;
+}
+
+static void walkStmts(TreeNode **link)
+{
+  TreeNode *head = *link;
+
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          walkStmts(&t->attr.cmpdStmt.stmt_list);
+          break;
+        case SelectionStatementK:
+          walkStmts(&t->attr.selectStmt.if_stmt);
+          walkStmts(&t->attr.selectStmt.else_stmt);
+          break;
+        case IterationStatementK:
+          walkStmts(&t->attr.iterStmt.loop_stmt);
+          replaceLoop(head, link);
+          break;
+        default:
+          break;
+        }
+    }
+}
+
+/* Function recognizeIdioms turns fill and copy loops
+ * into calls of the runtime routines
+ */
+int recognizeIdioms(TreeNode *func)
+{
+  total = 0;
+  walkStmts(&func->attr.funcDecl.cmpd_stmt);
+  return total;
+}
@@ -0,0 +1,17 @@
+/****************************************************/
+/* File: idiom.h                                    */
+/* Loop idiom recognition for the C- compiler       */
+/****************************************************/
+
+#ifndef _IDIOM_H_
+#define _IDIOM_H_
+
+/* Function recognizeIdioms replaces the while loops of
+ * a function that only fill an array with one value or
+ * copy one array into another, one element per step of
+ * the counter, by calls to the _fill and _copy runtime
+ * routines. Returns the number of loops replaced.
+ */
+int recognizeIdioms(TreeNode *func);
+
+#endif
@@ -0,0 +1,468 @@
+/****************************************************/
+/* File: indvar.c                                   */
+/* Induction-variable strength reduction for the    */
+/* C- compiler                                      */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "indvar.h"
+
+/* A scalar assigned in the loop. It is an induction
+ * variable when every assignment is a step by a constant.
+ */
+typedef struct
+{
+  SymbolInfo *var;
+  char *name;
+  int nAssigns;
+  int nSteps;
+} IvCandidate;
+
+/* The pointer that walks an array along with an
+ * induction variable: it always holds &arr[iv]
+ */
+typedef struct
+{
+  TreeNode *arr;   /* a use of the array */
+  SymbolInfo *ptr;
+} IvPointer;
+
+/* What follows the end of a statement list: the rest of
+ * the enclosing list, or the next test of a loop
+ */
+typedef struct contRec
+{
+  TreeNode *rest;
+  int loopBody;
+  struct contRec *outer;
+} ContRec;
+
+/* state of one run of the pass */
+static TreeNode *func;
+static int nCands, capCands;
+static IvCandidate *cands;
+static int nArrDefs, capArrDefs;
+static SymbolInfo **arrDefs;  /* array pointers assigned or arrays declared in the loop */
+static int hasCall;
+static SymbolInfo *iv;        /* induction variable being reduced */
+static int nPtrs, capPtrs;
+static IvPointer *ptrs;
+static int total;
+
+static TreeNode *assignNode(SymbolInfo *var, TreeNode *expr)
+{
+  TreeNode *assign = newAssignExpressionNode(newSymbolUseNode(var->nodeType == IntT ? "_lim" : "_ptr", var),
+                                             expr);
+  TreeNode *stmt = newExpressionStatementNode(assign);
+  assign->nodeType = IntT;
+  stmt->nodeType = NoneT;
+  return stmt;
+}
+
+static TreeNode *binaryNode(NodeKind kind, TreeNode *l, TokenType op, TreeNode *r)
+{
+  TreeNode *t = kind == AdditiveExpressionK
+    ? newAdditiveExpressionNode(l, newTokenTypeNode(op), r)
+    : newMultiplicativeExpressionNode(l, newTokenTypeNode(op), r);
+  t->nodeType = IntT;
+  return t;
+}
+
+static int isVar(TreeNode *t, SymbolInfo *var)
+{
+  return t != NULL && t->nodeKind == VariableK && t->symbolInfo == var;
+}
+
+static IvCandidate *candidate(TreeNode *var)
+{
+  int i;
+  for (i = 0; i < nCands; ++i)
+    if (cands[i].var == var->symbolInfo)
+      return &cands[i];
+  GROW(cands, nCands, capCands);
+  cands[nCands].var = var->symbolInfo;
+  cands[nCands].name = var->attr.ID;
+  cands[nCands].nAssigns = cands[nCands].nSteps = 0;
+  return &cands[nCands++];
+}
+
+/* Records the scalars, array pointers and calls of a loop */
+static void collectLoop(TreeNode *t)
+{
+  TreeNode **kids[3];
+  int i, n, step;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == CallK)
+        hasCall = TRUE;
+      else if (t->nodeKind == ArrayDeclarationK)
+        {
+          // not in scope before the loop, where its pointer is set
+          GROW(arrDefs, nArrDefs, capArrDefs);
+          arrDefs[nArrDefs++] = t->attr.arrDecl._var->symbolInfo;
+        }
+      else if (t->nodeKind == AssignExpressionK && t->attr.assignStmt._var->nodeKind == VariableK)
+        {
+          SymbolInfo *var = t->attr.assignStmt._var->symbolInfo;
+          if (var->nodeType == IntArrayT)
+            {
+              GROW(arrDefs, nArrDefs, capArrDefs);
+              arrDefs[nArrDefs++] = var;
+            }
+          else
+            candidate(t->attr.assignStmt._var)->nAssigns++;
+        }
+      else if (t->nodeKind == ExpressionStatementK && t->attr.exprStmt.expr != NULL
+               && t->attr.exprStmt.expr->nodeKind == AssignExpressionK
+               && constantStep(t, t->attr.exprStmt.expr->attr.assignStmt._var->symbolInfo, &step))
+        candidate(t->attr.exprStmt.expr->attr.assignStmt._var)->nSteps++;
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        collectLoop(*kids[i]);
+    }
+}
+
+static int arrayDefined(SymbolInfo *arr)
+{
+  int i;
+  for (i = 0; i < nArrDefs; ++i)
+    if (arrDefs[i] == arr)
+      return TRUE;
+  return FALSE;
+}
+
+/* Counts the reads and writes of iv in t, not in its siblings */
+static void countUses(TreeNode *t, int *reads, int *writes)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  if (t->nodeKind == AssignExpressionK && isVar(t->attr.assignStmt._var, iv))
+    {
+      (*writes)++;
+      countUses(t->attr.assignStmt.expr, reads, writes);
+      return;
+    }
+  if (isVar(t, iv))
+    (*reads)++;
+  n = treeChildren(t, kids);
+  for (i = 0; i < n; ++i)
+    {
+      TreeNode *kid;
+      for (kid = *kids[i]; kid != NULL; kid = kid->sibling)
+        countUses(kid, reads, writes);
+    }
+}
+
+static int readsIn(TreeNode *t)
+{
+  int reads = 0, writes = 0;
+  for (; t != NULL; t = t->sibling)
+    countUses(t, &reads, &writes);
+  return reads;
+}
+
+static SymbolInfo *pointerFor(TreeNode *arr)
+{
+  TreeNode *decl;
+  SymbolInfo *ptr;
+  int i;
+
+  for (i = 0; i < nPtrs; ++i)
+    if (ptrs[i].arr->symbolInfo == arr->symbolInfo)
+      return ptrs[i].ptr;
+
+  // a pointer slot, read like an array parameter
+  decl = newScalarDeclarationNode("_ptr");
+  ptr = decl->attr.varDecl._var->symbolInfo;
+  ptr->nodeType = decl->attr.varDecl._var->nodeType = IntArrayT;
+  ptr->attr.arrInfo.isParam = TRUE;
+  decl->sibling = func->attr.funcDecl.cmpd_stmt->attr.cmpdStmt.local_decl;
+  func->attr.funcDecl.cmpd_stmt->attr.cmpdStmt.local_decl = decl;
+
+  GROW(ptrs, nPtrs, capPtrs);
+  ptrs[nPtrs].arr = arr;
+  ptrs[nPtrs].ptr = ptr;
+  nPtrs++;
+  return ptr;
+}
+
+/* Rewrites arr[iv + k] into ptr[k] wherever arr is not
+ * assigned or declared in the loop
+ */
+static void rewriteAccesses(TreeNode *t)
+{
+  TreeNode **kids[3];
+  int i, n, k;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == ArrayK && !arrayDefined(t->attr.arr._var->symbolInfo)
+          && indexOffset(t->attr.arr.arr_expr, iv, &k))
+        {
+          SymbolInfo *ptr = pointerFor(t->attr.arr._var);
+          t->attr.arr._var = newSymbolUseNode("_ptr", ptr);
+          t->attr.arr.arr_expr = newIntConstantNode(k);
+          total++;
+          continue;
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        rewriteAccesses(*kids[i]);
+    }
+}
+
+/* Follows each step of iv with the steps of its
+ * pointers; the step itself goes when iv is dead
+ */
+static void insertSteps(TreeNode **link, int dropStep)
+{
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link, *bumps = NULL, *next;
+      int i, step;
+
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          insertSteps(&t->attr.cmpdStmt.stmt_list, dropStep);
+          break;
+        case SelectionStatementK:
+          insertSteps(&t->attr.selectStmt.if_stmt, dropStep);
+          insertSteps(&t->attr.selectStmt.else_stmt, dropStep);
+          break;
+        case IterationStatementK:
+          insertSteps(&t->attr.iterStmt.loop_stmt, dropStep);
+          break;
+        case ExpressionStatementK:
+          if (!constantStep(t, iv, &step))
+            break;
+          for (i = 0; i < nPtrs; ++i)
+            bumps = addSibling(bumps, assignNode(ptrs[i].ptr,
+                binaryNode(AdditiveExpressionK, newSymbolUseNode("_ptr", ptrs[i].ptr),
+                           PLUS, newIntConstantNode(step * (int) sizeof(int)))));
+          // the steps stay in the list, so unrolling still finds them
+          next = t->sibling;
+          t->sibling = NULL;
+          *link = dropStep ? bumps : addSibling(t, bumps);
+          while ((*link)->sibling != NULL)
+            link = &(*link)->sibling;
+          (*link)->sibling = next;
+          break;
+        default:
+          break;
+        }
+    }
+}
+
+/* TRUE if iv is assigned before it is read on every path
+ * from rest, given what follows the list at cont
+ */
+static int deadAfter(TreeNode *rest, ContRec *cont)
+{
+  for (; rest != NULL; rest = rest->sibling)
+    {
+      int reads = 0, writes = 0;
+      countUses(rest, &reads, &writes);
+      if (reads > 0)
+        return FALSE;
+      if (rest->nodeKind == ReturnStatementK)
+        return TRUE;
+      if (writes > 0 && rest->nodeKind == ExpressionStatementK)
+        return TRUE;
+    }
+  if (cont == NULL)
+    return TRUE;
+  if (cont->loopBody)
+    return FALSE;
+  return deadAfter(cont->rest, cont->outer);
+}
+
+/* &arr[index] for a preheader, folded when index is known */
+static TreeNode *addressOf(TreeNode *arr, TreeNode *index)
+{
+  TreeNode *base = newSymbolUseNode(arr->attr.ID, arr->symbolInfo);
+  if (index->nodeKind == ConstantK)
+    return index->attr.NUM == 0 ? base
+      : binaryNode(AdditiveExpressionK, base, PLUS,
+                   newIntConstantNode(index->attr.NUM * (int) sizeof(int)));
+  return binaryNode(AdditiveExpressionK, base, PLUS,
+                    binaryNode(MultiplicativeExpressionK, index, TIMES,
+                               newIntConstantNode(sizeof(int))));
+}
+
+static int loopInvariant(TreeNode *t)
+{
+  int i;
+
+  if (t->nodeKind == ConstantK)
+    return TRUE;
+  if (t->nodeKind != VariableK || t->symbolInfo->nodeType != IntT)
+    return FALSE;
+  for (i = 0; i < nCands; ++i)
+    if (cands[i].var == t->symbolInfo)
+      return FALSE;
+  return !t->symbolInfo->attr.intInfo.globalFlag || !hasCall;
+}
+
+/* TRUE if &arr[index] is within the array or one past
+ * it, for an index that is a constant
+ */
+static int withinArray(TreeNode *arr, TreeNode *index)
+{
+  SymbolInfo *sym = arr->symbolInfo;
+  return index != NULL && index->nodeKind == ConstantK && !sym->attr.arrInfo.isParam
+    && index->attr.NUM >= 0 && index->attr.NUM <= sym->attr.arrInfo.arrLen;
+}
+
+/* Replaces iv < bound (any comparison) in the loop test
+ * by the same comparison of its first pointer with
+ * &arr[bound]; returns the preheader statement or NULL.
+ * The comparison is signed, so both the start and the
+ * bound must be known to lie within the array: an
+ * address far outside it may wrap around.
+ */
+static TreeNode *replaceTest(TreeNode *test, TreeNode *start)
+{
+  TreeNode **ivSide, **boundSide, *bound, *decl;
+  SymbolInfo *lim;
+
+  if (nPtrs == 0 || test->nodeKind != ComparisonExpressionK
+      || !withinArray(ptrs[0].arr, start))
+    return NULL;
+  if (isVar(test->attr.cmpExpr.lexpr, iv))
+    {
+      ivSide = &test->attr.cmpExpr.lexpr;
+      boundSide = &test->attr.cmpExpr.rexpr;
+    }
+  else
+    {
+      ivSide = &test->attr.cmpExpr.rexpr;
+      boundSide = &test->attr.cmpExpr.lexpr;
+    }
+  if (!isVar(*ivSide, iv) || !loopInvariant(*boundSide)
+      || !withinArray(ptrs[0].arr, *boundSide))
+    return NULL;
+
+  decl = newScalarDeclarationNode("_lim");
+  lim = decl->attr.varDecl._var->symbolInfo;
+  decl->sibling = func->attr.funcDecl.cmpd_stmt->attr.cmpdStmt.local_decl;
+  func->attr.funcDecl.cmpd_stmt->attr.cmpdStmt.local_decl = decl;
+
+  // the map i -> &arr[i] keeps the order of indexes within
+  // the array, where the addresses cannot wrap
+  bound = *boundSide;
+  *ivSide = newSymbolUseNode("_ptr", ptrs[0].ptr);
+  *boundSide = newSymbolUseNode("_lim", lim);
+  return assignNode(lim, addressOf(ptrs[0].arr, bound));
+}
+
+static void reduceLoop(TreeNode *head, TreeNode **link, ContRec *cont)
+{
+  TreeNode *loop = *link, *pre = NULL;
+  int c;
+
+  nCands = nArrDefs = 0;
+  hasCall = FALSE;
+  collectLoop(loop->attr.iterStmt.expr);
+  collectLoop(loop->attr.iterStmt.loop_stmt);
+
+  for (c = 0; c < nCands; ++c)
+    {
+      TreeNode *start, *limit = NULL, *test = loop->attr.iterStmt.expr;
+      int i, dropStep = FALSE;
+
+      if (cands[c].nAssigns != cands[c].nSteps || cands[c].var->attr.intInfo.globalFlag)
+        continue;
+      // only loops counted by iv run long enough to pay for
+      // the pointer set-up; a recursion turned into a loop
+      // (its test is a flag) mostly runs once per entry
+      iv = cands[c].var;
+      if (readsIn(test) == 0)
+        continue;
+      nPtrs = 0;
+      rewriteAccesses(loop->attr.iterStmt.expr);
+      rewriteAccesses(loop->attr.iterStmt.loop_stmt);
+      if (nPtrs == 0)
+        continue;
+
+      start = constantOnEntry(head, loop, iv);
+      for (i = 0; i < nPtrs; ++i)
+        pre = addSibling(pre, assignNode(ptrs[i].ptr,
+            addressOf(ptrs[i].arr, start != NULL ? newIntConstantNode(start->attr.NUM)
+                                                 : newSymbolUseNode(cands[c].name, iv))));
+
+      // a counter only the test and its steps read is
+      // replaced in the test and then not kept at all
+      if (readsIn(loop->attr.iterStmt.loop_stmt) == cands[c].nSteps
+          && readsIn(test) == 1 && deadAfter(loop->sibling, cont))
+        limit = replaceTest(test, start);
+      if (limit != NULL)
+        {
+          pre = addSibling(pre, limit);
+          dropStep = TRUE;
+        }
+      insertSteps(&loop->attr.iterStmt.loop_stmt, dropStep);
+    }
+
+  if (pre != NULL)
+    {
+      addSibling(pre, loop);
+      *link = pre;
+    }
+}
+
+static void walkStmts(TreeNode **link, ContRec *cont)
+{
+  TreeNode *head = *link;
+
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link;
+      ContRec inner = { t->sibling, FALSE, cont };
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          walkStmts(&t->attr.cmpdStmt.stmt_list, &inner);
+          break;
+        case SelectionStatementK:
+          walkStmts(&t->attr.selectStmt.if_stmt, &inner);
+          walkStmts(&t->attr.selectStmt.else_stmt, &inner);
+          break;
+        case IterationStatementK:
+        {
+          ContRec body = { NULL, TRUE, NULL };
+          // inner loops first; the outer one may then step their pointers' bases
+          walkStmts(&t->attr.iterStmt.loop_stmt, &body);
+          reduceLoop(head, link, cont);
+          while (*link != t)
+            link = &(*link)->sibling;
+          break;
+        }
+        default:
+          break;
+        }
+    }
+}
+
+/* Function reduceInductionVariables replaces array
+ * indexing by induction variables with stepped pointers
+ */
+int reduceInductionVariables(TreeNode *f)
+{
+  func = f;
+  total = 0;
+  walkStmts(&func->attr.funcDecl.cmpd_stmt, NULL);
+  free(cands);
+  free(arrDefs);
+  free(ptrs);
+  cands = NULL;
+  arrDefs = NULL;
+  ptrs = NULL;
+  capCands = capArrDefs = capPtrs = 0;
+  func = NULL;
+  iv = NULL;
+  return total;
+}
@@ -0,0 +1,20 @@
+/****************************************************/
+/* File: indvar.h                                   */
+/* Induction-variable strength reduction for the    */
+/* C- compiler                                      */
+/****************************************************/
+
+#ifndef _INDVAR_H_
+#define _INDVAR_H_
+
+/* Function reduceInductionVariables finds the scalars
+ * a while loop only steps by constants and turns the
+ * array elements they index into offsets from pointers
+ * stepped along with them, so no element address needs
+ * a multiply. A counter left used only by the exit test
+ * is replaced by a pointer compare and removed. Returns
+ * the number of element accesses rewritten.
+ */
+int reduceInductionVariables(TreeNode *func);
+
+#endif
@@ -0,0 +1,353 @@
+/****************************************************/
+/* File: inline.c                                   */
+/* Function inlining for the C- compiler            */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "callgraph.h"
+#include "constprop.h"
+#include "inline.h"
+
+/* Bodies up to this many tree nodes are cheaper than
+ * the call sequence (argument pushes, jal, 10 saved
+ * words) and are inlined everywhere
+ */
+#define INLINE_ALWAYS_SIZE 12
+
+/* largest body, in tree nodes, ever inlined */
+#define INLINE_MAX_SIZE 80
+
+/* tree nodes the larger inlined bodies together may
+ * add: half the program, but never less than the minimum
+ */
+#define INLINE_BUDGET_PERCENT 50
+#define INLINE_MIN_BUDGET 200
+
+/* what has been evaluated in a statement before a call */
+typedef enum { PrefixEmpty, PrefixPure, PrefixImpure } PrefixKind;
+
+static CallGraph cg;
+static int budget;
+static int inlined;
+
+static int isMain(TreeNode *func)
+{
+  return strcmp(func->attr.funcDecl._var->attr.ID, "main") == 0;
+}
+
+/* Cost model: trivial bodies always, bigger ones only
+ * when the call runs in a loop or is the only call
+ */
+static int worthInlining(CgNode callee, int size, int loopDepth)
+{
+  if (size <= INLINE_ALWAYS_SIZE)
+    return TRUE;
+  if (size > INLINE_MAX_SIZE || size > budget)
+    return FALSE;
+  return loopDepth > 0 || callee->nCallers == 1;
+}
+
+/* TRUE if evaluating the node cannot observe what a
+ * call does: constants, scalar locals (a callee
+ * cannot reach them) and array addresses
+ */
+static int callInvariant(TreeNode *t)
+{
+  switch (t->nodeKind)
+    {
+    case ConstantK:
+    case ComparisonExpressionK:
+    case AdditiveExpressionK:
+    case MultiplicativeExpressionK:
+      return TRUE;
+    case VariableK:
+      return t->nodeType == IntArrayT || !t->symbolInfo->attr.intInfo.globalFlag;
+    default:
+      return FALSE;
+    }
+}
+
+/* Walks the expression at *slot in cgen's evaluation
+ * order and returns the link holding the first call
+ * to complete, or NULL. *prefix records what the
+ * statement evaluates before that call.
+ */
+static TreeNode **firstCall(TreeNode **slot, PrefixKind *prefix)
+{
+  TreeNode *t = *slot, **found, **kids[3];
+  int i, n;
+
+  if (t->nodeKind == CallK)
+    {
+      PrefixKind before = *prefix;
+      for (kids[0] = &t->attr.call.expr_list; *kids[0] != NULL; kids[0] = &(*kids[0])->sibling)
+        if ((found = firstCall(kids[0], prefix)) != NULL)
+          return found;
+      // the arguments move along with the call
+      *prefix = before;
+      return slot;
+    }
+
+  n = treeChildren(t, kids);
+  for (i = 0; i < n; ++i)
+    if (*kids[i] != NULL && (found = firstCall(kids[i], prefix)) != NULL)
+      return found;
+
+  if (!callInvariant(t))
+    *prefix = PrefixImpure;
+  else if (*prefix == PrefixEmpty)
+    *prefix = PrefixPure;
+  return NULL;
+}
+
+/* Rewrites the returns of an inlined body so that the
+ * value goes to ret (NULL when the result is unused)
+ * and control falls off the end of the body. Returns
+ * FALSE if some return is not in tail position.
+ */
+static int rewriteReturns(TreeNode **link, SymbolInfo *ret, int tail)
+{
+  while (*link != NULL)
+    {
+      TreeNode *t = *link;
+      int last = tail && t->sibling == NULL;
+
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          if (!rewriteReturns(&t->attr.cmpdStmt.stmt_list, ret, last))
+            return FALSE;
+          break;
+        case SelectionStatementK:
+          if (!rewriteReturns(&t->attr.selectStmt.if_stmt, ret, last)
+              || !rewriteReturns(&t->attr.selectStmt.else_stmt, ret, last))
+            return FALSE;
+          break;
+        case IterationStatementK:
+          if (!rewriteReturns(&t->attr.iterStmt.loop_stmt, ret, FALSE))
+            return FALSE;
+          break;
+        case ReturnStatementK:
+        {
+          TreeNode *expr = t->attr.retStmt.expr, *repl;
+          if (!last)
+            return FALSE;
+          if (expr != NULL && ret != NULL)
+            {
+              expr = newAssignExpressionNode(newSymbolUseNode("_ret", ret), expr);
+              expr->nodeType = IntT;
+            }
+          if (expr != NULL && (ret != NULL || hasSideEffect(expr)))
+            repl = newExpressionStatementNode(expr);
+          else
+            repl = newCompoundStatementNode(NULL, NULL);
+          repl->nodeType = NoneT;
+          *link = repl;
+          return TRUE;
+        }
+        default:
+          break;
+        }
+      link = &t->sibling;
+    }
+  return TRUE;
+}
+
+/* Makes the body refer to the caller's array wherever
+ * it used the array parameter, so the base address is
+ * the one the caller would have passed
+ */
+static void substituteArray(TreeNode *t, SymbolInfo *param, TreeNode *arg)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == VariableK && t->symbolInfo == param)
+        {
+          t->symbolInfo = arg->symbolInfo;
+          t->attr.ID = arg->attr.ID;
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        substituteArray(*kids[i], param, arg);
+    }
+}
+
+/* Inlines the call at *callSlot, which is the first to
+ * run in the statement at *link. The statement becomes
+ *   { params; _ret; params = args; body; statement }
+ * with the call replaced by _ret. Returns the link to
+ * the statement inside the new block, or NULL if the
+ * call was not inlined or the statement was the call.
+ */
+static TreeNode **expandCall(TreeNode **link, TreeNode **callSlot,
+                             PrefixKind prefix, int loopDepth)
+{
+  TreeNode *stmt = *link, *call = *callSlot;
+  CgNode callee = cgLookup(cg, call->attr.call._var->symbolInfo);
+  TreeNode *clone, *body, *param, *arg, *next, *cmpd;
+  TreeNode *decls = NULL, *binds = NULL;
+  SymbolMap map = { 0, 0, NULL, NULL };
+  SymbolInfo *ret = NULL;
+  int size, used;
+
+  // input/output, recursion and the entry point stay calls
+  if (callee == NULL || callee->recursive || isMain(callee->func))
+    return NULL;
+  size = 1 + countTreeNodes(callee->func->attr.funcDecl.cmpd_stmt);
+  if (!worthInlining(callee, size, loopDepth))
+    return NULL;
+
+  // the arguments now run before what preceded the call
+  for (arg = call->attr.call.expr_list, param = callee->func->attr.funcDecl.params;
+       arg != NULL;
+       arg = arg->sibling, param = param->sibling)
+    {
+      if (prefix != PrefixEmpty && hasSideEffect(arg))
+        return NULL;
+      if (param->nodeKind == ArrayParameterK && arg->nodeKind != VariableK)
+        return NULL;
+    }
+  if (prefix == PrefixImpure)
+    return NULL;
+
+  clone = cloneTree(callee->func, &map);
+  free(map.from);
+  free(map.to);
+  body = clone->attr.funcDecl.cmpd_stmt;
+  used = !(stmt->nodeKind == ExpressionStatementK && callSlot == &stmt->attr.exprStmt.expr);
+  if (used)
+    {
+      decls = newScalarDeclarationNode("_ret");
+      ret = decls->attr.varDecl._var->symbolInfo;
+    }
+
+  sinkRest(body->attr.cmpdStmt.stmt_list);
+  if (!rewriteReturns(&body->attr.cmpdStmt.stmt_list, ret, TRUE))
+    return NULL;
+
+  // bind the parameters in argument order
+  for (arg = call->attr.call.expr_list, param = clone->attr.funcDecl.params;
+       arg != NULL;
+       arg = next, param = param->sibling)
+    {
+      TreeNode *_var = param->attr.varParam._var;
+      next = arg->sibling;
+      arg->sibling = NULL;
+      if (param->nodeKind == ArrayParameterK)
+        substituteArray(body, _var->symbolInfo, arg);
+      else
+        {
+          TreeNode *decl = newVariableDeclarationNode(param->attr.varParam.type_spec, _var);
+          TreeNode *assign = newAssignExpressionNode(newSymbolUseNode(_var->attr.ID, _var->symbolInfo), arg);
+          TreeNode *bind = newExpressionStatementNode(assign);
+
+          _var->symbolInfo->attr.intInfo.isParam = FALSE;
+          assign->nodeType = IntT;
+          decl->nodeType = bind->nodeType = NoneT;
+          decls = addSibling(decls, decl);
+          binds = addSibling(binds, bind);
+        }
+    }
+
+  cmpd = newCompoundStatementNode(decls, addSibling(binds, body));
+  cmpd->nodeType = NoneT;
+  cmpd->sibling = stmt->sibling;
+  stmt->sibling = NULL;
+  *link = cmpd;
+
+  if (size > INLINE_ALWAYS_SIZE)
+    budget -= size;
+  inlined++;
+
+  if (!used)
+    return NULL;
+  *callSlot = newSymbolUseNode("_ret", ret);
+  (*callSlot)->sibling = call->sibling;
+  addSibling(cmpd->attr.cmpdStmt.stmt_list, stmt);
+  for (link = &cmpd->attr.cmpdStmt.stmt_list; *link != stmt; link = &(*link)->sibling)
+    ;
+  return link;
+}
+
+/* Inlines the calls of one statement, first to run first */
+static void inlineStmt(TreeNode **link, int loopDepth)
+{
+  while (link != NULL)
+    {
+      TreeNode *t = *link, **expr, **callSlot;
+      PrefixKind prefix = PrefixEmpty;
+
+      switch (t->nodeKind)
+        {
+        case ExpressionStatementK: expr = &t->attr.exprStmt.expr; break;
+        case ReturnStatementK: expr = &t->attr.retStmt.expr; break;
+        case SelectionStatementK: expr = &t->attr.selectStmt.expr; break;
+        default: return;
+        }
+      if (*expr == NULL || (callSlot = firstCall(expr, &prefix)) == NULL)
+        return;
+      link = expandCall(link, callSlot, prefix, loopDepth);
+    }
+}
+
+static void inlineStmts(TreeNode **link, int loopDepth)
+{
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          inlineStmts(&t->attr.cmpdStmt.stmt_list, loopDepth);
+          break;
+        case SelectionStatementK:
+          inlineStmts(&t->attr.selectStmt.if_stmt, loopDepth);
+          inlineStmts(&t->attr.selectStmt.else_stmt, loopDepth);
+          inlineStmt(link, loopDepth);
+          break;
+        case IterationStatementK:
+          // the condition reruns every iteration, so its calls stay
+          inlineStmts(&t->attr.iterStmt.loop_stmt, loopDepth + 1);
+          break;
+        case ExpressionStatementK:
+        case ReturnStatementK:
+          inlineStmt(link, loopDepth);
+          break;
+        default:
+          DONT_OCCUR_PRINT;
+        }
+    }
+}
+
+/* Function inlineCalls substitutes the bodies of
+ * small non-recursive functions for the calls to them
+ */
+int inlineCalls(TreeNode *syntaxTree)
+{
+  int i;
+
+  budget = countTreeNodes(syntaxTree) * INLINE_BUDGET_PERCENT / 100;
+  if (budget < INLINE_MIN_BUDGET)
+    budget = INLINE_MIN_BUDGET;
+  inlined = 0;
+  cg = cgBuild(syntaxTree);
+
+  // C- declares before use, so program order visits
+  // callees first and they are inlined already simplified
+  for (i = 0; i < cg->nNodes; ++i)
+    {
+      TreeNode *func = cg->nodes[i]->func;
+      int before = inlined;
+      inlineStmts(&func->attr.funcDecl.cmpd_stmt, 0);
+      if (inlined != before)
+        constantPropagation(func);
+    }
+
+  cgFree(cg);
+  cg = NULL;
+  return inlined;
+}
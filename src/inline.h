@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: inline.h                                   */
+/* Function inlining for the C- compiler            */
+/****************************************************/
+
+#ifndef _INLINE_H_
+#define _INLINE_H_
+
+/* Function inlineCalls substitutes the bodies of
+ * small non-recursive functions for the calls to
+ * them, choosing call sites by callee size and by
+ * how often the call runs (loop nesting) within a
+ * code-size budget. Returns the number of calls
+ * inlined.
+ */
+int inlineCalls(TreeNode *syntaxTree);
+
+#endif
@@ -0,0 +1,322 @@
+/****************************************************/
+/* File: ipcp.c                                     */
+/* Interprocedural constant propagation and         */
+/* function specialization for the C- compiler      */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "callgraph.h"
+#include "constprop.h"
+#include "ipcp.h"
+
+/* A pattern is cloned only if its call sites weigh at
+ * least this much; a call weighs 1, times 10 for every
+ * while loop around it (at most 3 levels)
+ */
+#define SPECIALIZE_MIN_WEIGHT 2
+
+/* largest function, in tree nodes, worth cloning */
+#define SPECIALIZE_MAX_SIZE 300
+
+/* tree nodes all clones together may add: a quarter
+ * of the program, but never less than the minimum
+ */
+#define SPECIALIZE_BUDGET_PERCENT 25
+#define SPECIALIZE_MIN_BUDGET 100
+
+/* rounds of propagation before giving up on a fixpoint */
+#define MAX_ROUNDS 8
+
+static int budget;
+static int cloneCount;
+
+static int isMain(TreeNode *func)
+{
+  return strcmp(func->attr.funcDecl._var->attr.ID, "main") == 0;
+}
+
+static int callWeight(CallSite site)
+{
+  int weight = 1, depth;
+  for (depth = 0; depth < site->loopDepth && depth < 3; ++depth)
+    weight *= 10;
+  return weight;
+}
+
+/* TRUE if argument k of the call is a constant passed
+ * for a scalar parameter; its value goes to *value
+ */
+static int constArg(TreeNode *call, int k, int *value)
+{
+  SymbolInfo *fsym = call->attr.call._var->symbolInfo;
+  TreeNode *arg = call->attr.call.expr_list;
+
+  if (fsym->attr.funcInfo.paramTypeList[k] != IntT)
+    return FALSE;
+  while (k-- > 0)
+    arg = arg->sibling;
+  if (arg->nodeKind != ConstantK)
+    return FALSE;
+  *value = arg->attr.NUM;
+  return TRUE;
+}
+
+/* Turns the parameters selected by mask into locals
+ * initialized with values[k] and drops them from the
+ * function's signature
+ */
+static void bindParams(TreeNode *func, const int *mask, const int *values)
+{
+  SymbolInfo *fsym = func->attr.funcDecl._var->symbolInfo;
+  TreeNode *body = func->attr.funcDecl.cmpd_stmt;
+  TreeNode **link = &func->attr.funcDecl.params;
+  ExpType *typeList;
+  int k = 0, n = 0;
+
+  MALLOC(typeList, (fsym->attr.funcInfo.paramLen + 1) * sizeof(ExpType));
+  while (*link != NULL)
+    {
+      TreeNode *param = *link;
+      if (mask[k])
+        {
+          TreeNode *_var = param->attr.varParam._var;
+          TreeNode *decl = newVariableDeclarationNode(param->attr.varParam.type_spec, _var);
+          TreeNode *use = newSymbolUseNode(_var->attr.ID, _var->symbolInfo);
+          TreeNode *assign = newAssignExpressionNode(use, newIntConstantNode(values[k]));
+          TreeNode *init = newExpressionStatementNode(assign);
+
+          _var->symbolInfo->attr.intInfo.isParam = FALSE;
+          assign->nodeType = IntT;
+          decl->nodeType = init->nodeType = NoneT;
+
+          decl->sibling = body->attr.cmpdStmt.local_decl;
+          body->attr.cmpdStmt.local_decl = decl;
+          init->sibling = body->attr.cmpdStmt.stmt_list;
+          body->attr.cmpdStmt.stmt_list = init;
+
+          *link = param->sibling;
+        }
+      else
+        {
+          typeList[n++] = fsym->attr.funcInfo.paramTypeList[k];
+          link = &param->sibling;
+        }
+      k++;
+    }
+  fsym->attr.funcInfo.paramTypeList = typeList;
+  fsym->attr.funcInfo.paramLen = n;
+}
+
+/* removes the arguments selected by mask from a call */
+static void dropArgs(TreeNode *call, const int *mask)
+{
+  TreeNode **link = &call->attr.call.expr_list;
+  int k = 0;
+  while (*link != NULL)
+    {
+      if (mask[k++])
+        *link = (*link)->sibling;
+      else
+        link = &(*link)->sibling;
+    }
+}
+
+/* constant-argument pattern of a call: which scalar
+ * arguments are constants, and their values */
+static int argPattern(TreeNode *call, int nParams, int *mask, int *values)
+{
+  int k, any = FALSE;
+  for (k = 0; k < nParams; ++k)
+    {
+      mask[k] = constArg(call, k, &values[k]);
+      any |= mask[k];
+    }
+  return any;
+}
+
+static int samePattern(TreeNode *call, int nParams, const int *mask, const int *values)
+{
+  int k, v;
+  for (k = 0; k < nParams; ++k)
+    {
+      int isConst = constArg(call, k, &v);
+      if (isConst != mask[k] || (isConst && v != values[k]))
+        return FALSE;
+    }
+  return TRUE;
+}
+
+/* Binds the parameters that get the same constant at
+ * every call site. Returns TRUE if the function changed.
+ */
+static int propagateIntoCallee(CgNode node)
+{
+  int nParams = node->symbolInfo->attr.funcInfo.paramLen;
+  int *mask, *values, v, k, i, any = FALSE;
+
+  if (nParams == 0 || node->nCallers == 0)
+    return FALSE;
+
+  MALLOC(mask, nParams * sizeof(int));
+  MALLOC(values, nParams * sizeof(int));
+  argPattern(node->callers[0]->call, nParams, mask, values);
+  for (i = 1; i < node->nCallers; ++i)
+    for (k = 0; k < nParams; ++k)
+      if (mask[k] && (!constArg(node->callers[i]->call, k, &v) || v != values[k]))
+        mask[k] = FALSE;
+  for (k = 0; k < nParams; ++k)
+    any |= mask[k];
+
+  if (any)
+    {
+      bindParams(node->func, mask, values);
+      for (i = 0; i < node->nCallers; ++i)
+        dropArgs(node->callers[i]->call, mask);
+    }
+
+  free(mask);
+  free(values);
+  return any;
+}
+
+/* Points the calls of a clone to itself back at the
+ * original: their arguments, unlike those of the calls
+ * redirected to the clone, need not fit its pattern
+ */
+static void uncloneSelfCalls(TreeNode *t, SymbolInfo *cloneSym, TreeNode *orig)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **slots[3];
+      int i, n = treeChildren(t, slots);
+
+      if (t->nodeKind == CallK && t->attr.call._var->symbolInfo == cloneSym)
+        {
+          t->attr.call._var->attr.ID = orig->attr.funcDecl._var->attr.ID;
+          t->attr.call._var->symbolInfo = orig->attr.funcDecl._var->symbolInfo;
+        }
+      for (i = 0; i < n; ++i)
+        uncloneSelfCalls(*slots[i], cloneSym, orig);
+    }
+}
+
+/* Clones the function for every hot constant-argument
+ * pattern that fits in the budget and redirects the
+ * matching calls to the clone. Returns the number of
+ * clones made.
+ */
+static int specialize(CgNode node)
+{
+  int nParams = node->symbolInfo->attr.funcInfo.paramLen;
+  int size = 1 + countTreeNodes(node->func->attr.funcDecl.cmpd_stmt);
+  int *mask, *values, *done, i, j, clones = 0;
+
+  if (nParams == 0 || node->nCallers < 1 || size > SPECIALIZE_MAX_SIZE)
+    return 0;
+
+  MALLOC(mask, nParams * sizeof(int));
+  MALLOC(values, nParams * sizeof(int));
+  MALLOC(done, node->nCallers * sizeof(int));
+  memset(done, 0, node->nCallers * sizeof(int));
+
+  for (i = 0; i < node->nCallers && size <= budget; ++i)
+    {
+      int weight = 0;
+      TreeNode *clone;
+      SymbolMap map = { 0, 0, NULL, NULL };
+      SymbolInfo *cloneSym;
+      char *name;
+
+      if (done[i] || !argPattern(node->callers[i]->call, nParams, mask, values))
+        continue;
+      for (j = i; j < node->nCallers; ++j)
+        if (!done[j] && samePattern(node->callers[j]->call, nParams, mask, values))
+          weight += callWeight(node->callers[j]);
+      if (weight < SPECIALIZE_MIN_WEIGHT)
+        continue;
+
+      // '_' cannot appear in a C- identifier, so the name is fresh
+      clone = cloneTree(node->func, &map);
+      MALLOC(name, strlen(node->func->attr.funcDecl._var->attr.ID) + 16);
+      sprintf(name, "%s_%d", node->func->attr.funcDecl._var->attr.ID, ++cloneCount);
+      clones++;
+      clone->attr.funcDecl._var->attr.ID = name;
+      cloneSym = clone->attr.funcDecl._var->symbolInfo;
+      uncloneSelfCalls(clone->attr.funcDecl.cmpd_stmt, cloneSym, node->func);
+      bindParams(clone, mask, values);
+
+      for (j = i; j < node->nCallers; ++j)
+        if (!done[j] && samePattern(node->callers[j]->call, nParams, mask, values))
+          {
+            TreeNode *call = node->callers[j]->call;
+            dropArgs(call, mask);
+            call->attr.call._var->attr.ID = name;
+            call->attr.call._var->symbolInfo = cloneSym;
+            done[j] = TRUE;
+          }
+
+      clone->sibling = node->func->sibling;
+      node->func->sibling = clone;
+      constantPropagation(clone);
+      budget -= size;
+      free(map.from);
+      free(map.to);
+    }
+
+  free(mask);
+  free(values);
+  free(done);
+  return clones;
+}
+
+/* Function interproceduralConstants binds scalar
+ * parameters that receive the same constant at every
+ * call site, and clones hot functions for frequent
+ * constant-argument patterns
+ */
+int interproceduralConstants(TreeNode *syntaxTree)
+{
+  int round, i, total = 0;
+
+  budget = countTreeNodes(syntaxTree) * SPECIALIZE_BUDGET_PERCENT / 100;
+  if (budget < SPECIALIZE_MIN_BUDGET)
+    budget = SPECIALIZE_MIN_BUDGET;
+
+  for (round = 0; round < MAX_ROUNDS; ++round)
+    {
+      CallGraph cg = cgBuild(syntaxTree);
+      int changed = 0;
+
+      for (i = 0; i < cg->nNodes; ++i)
+        {
+          cg->nodes[i]->mark = FALSE;
+          if (isMain(cg->nodes[i]->func))
+            continue;
+          if (propagateIntoCallee(cg->nodes[i]))
+            {
+              cg->nodes[i]->mark = TRUE;
+              changed++;
+            }
+        }
+      // folding the bound parameters may make more arguments constant
+      for (i = 0; i < cg->nNodes; ++i)
+        if (cg->nodes[i]->mark)
+          constantPropagation(cg->nodes[i]->func);
+
+      if (changed == 0)
+        {
+          // only clone once the arguments have settled
+          for (i = 0; i < cg->nNodes; ++i)
+            if (!isMain(cg->nodes[i]->func))
+              changed += specialize(cg->nodes[i]);
+        }
+
+      cgFree(cg);
+      total += changed;
+      if (changed == 0)
+        break;
+    }
+
+  return total;
+}
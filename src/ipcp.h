@@ -0,0 +1,19 @@
+/****************************************************/
+/* File: ipcp.h                                     */
+/* Interprocedural constant propagation and         */
+/* function specialization for the C- compiler      */
+/****************************************************/
+
+#ifndef _IPCP_H_
+#define _IPCP_H_
+
+/* Function interproceduralConstants binds scalar
+ * parameters that receive the same constant at every
+ * call site inside their function, and clones hot
+ * functions for frequent constant-argument patterns
+ * within a code-size budget. Constant arguments are no
+ * longer passed. Returns the number of rewrites made.
+ */
+int interproceduralConstants(TreeNode *syntaxTree);
+
+#endif
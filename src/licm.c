@@ -0,0 +1,397 @@
+/****************************************************/
+/* File: licm.c                                     */
+/* Loop-invariant code motion for the C- compiler   */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "licm.h"
+
+/* What a loop may change */
+typedef struct
+{
+  int nDefs, capDefs;
+  SymbolInfo **defs;    /* scalars and array pointers assigned */
+  int nStores, capStores;
+  SymbolInfo **stores;  /* arrays stored to */
+  int hasCall;
+} LoopEffect;
+
+/* An invariant moved to the preheader, and its temporary */
+typedef struct
+{
+  TreeNode *expr;
+  SymbolInfo *temp;
+} Hoisted;
+
+/* state of one run of the pass */
+static TreeNode *func;
+static LoopEffect effect;
+static int nHoisted, capHoisted;
+static Hoisted *hoisted;
+static int speculative;   /* a hoisted load or division needs the guard */
+static int total;
+
+static int inList(SymbolInfo **list, int n, SymbolInfo *symbolInfo)
+{
+  int i;
+  for (i = 0; i < n; ++i)
+    if (list[i] == symbolInfo)
+      return TRUE;
+  return FALSE;
+}
+
+static void collectEffects(TreeNode *t)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == CallK)
+        effect.hasCall = TRUE;
+      else if (t->nodeKind == AssignExpressionK)
+        {
+          TreeNode *var = t->attr.assignStmt._var;
+          if (var->nodeKind == VariableK)
+            {
+              GROW(effect.defs, effect.nDefs, effect.capDefs);
+              effect.defs[effect.nDefs++] = var->symbolInfo;
+            }
+          else
+            {
+              GROW(effect.stores, effect.nStores, effect.capStores);
+              effect.stores[effect.nStores++] = var->attr.arr._var->symbolInfo;
+            }
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        collectEffects(*kids[i]);
+    }
+}
+
+/* Distinct global and local arrays never overlap; an
+ * array parameter may point at any array of a caller
+ */
+static int mayAlias(SymbolInfo *a, SymbolInfo *b)
+{
+  return a == b || a->attr.arrInfo.isParam || b->attr.arrInfo.isParam;
+}
+
+static int storedInLoop(SymbolInfo *arr)
+{
+  int i;
+  for (i = 0; i < effect.nStores; ++i)
+    if (mayAlias(effect.stores[i], arr))
+      return TRUE;
+  return FALSE;
+}
+
+/* TRUE if the expression has the same value on every
+ * iteration. Loads and divisions by a variable may
+ * fault, so they count only where always set.
+ */
+static int invariant(TreeNode *t, int always)
+{
+  switch (t->nodeKind)
+    {
+    case ConstantK:
+      return TRUE;
+    case VariableK:
+      if (inList(effect.defs, effect.nDefs, t->symbolInfo))
+        return FALSE;
+      // a callee may change any global scalar
+      return t->symbolInfo->nodeType == IntArrayT
+        || !t->symbolInfo->attr.intInfo.globalFlag || !effect.hasCall;
+    case ComparisonExpressionK:
+      return invariant(t->attr.cmpExpr.lexpr, always)
+        && invariant(t->attr.cmpExpr.rexpr, always);
+    case AdditiveExpressionK:
+      return invariant(t->attr.addExpr.lexpr, always)
+        && invariant(t->attr.addExpr.rexpr, always);
+    case MultiplicativeExpressionK:
+      if (t->attr.multExpr.op->attr.TOK == OVER && !always
+          && (t->attr.multExpr.rexpr->nodeKind != ConstantK
+              || t->attr.multExpr.rexpr->attr.NUM == 0))
+        return FALSE;
+      return invariant(t->attr.multExpr.lexpr, always)
+        && invariant(t->attr.multExpr.rexpr, always);
+    case ArrayK:
+      return always && !effect.hasCall
+        && !storedInLoop(t->attr.arr._var->symbolInfo)
+        && invariant(t->attr.arr.arr_expr, always);
+    default:
+      return FALSE;
+    }
+}
+
+/* needs the loop to run at least once to be safe */
+static int mayFault(TreeNode *t)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  if (t->nodeKind == ArrayK)
+    return TRUE;
+  if (t->nodeKind == MultiplicativeExpressionK && t->attr.multExpr.op->attr.TOK == OVER
+      && (t->attr.multExpr.rexpr->nodeKind != ConstantK || t->attr.multExpr.rexpr->attr.NUM == 0))
+    return TRUE;
+  n = treeChildren(t, kids);
+  for (i = 0; i < n; ++i)
+    if (*kids[i] != NULL && mayFault(*kids[i]))
+      return TRUE;
+  return FALSE;
+}
+
+static int sameExpr(TreeNode *a, TreeNode *b)
+{
+  if (a->nodeKind != b->nodeKind)
+    return FALSE;
+  switch (a->nodeKind)
+    {
+    case ConstantK:
+      return a->attr.NUM == b->attr.NUM;
+    case VariableK:
+      return a->symbolInfo == b->symbolInfo;
+    case ComparisonExpressionK:
+      return a->attr.cmpExpr.op->attr.TOK == b->attr.cmpExpr.op->attr.TOK
+        && sameExpr(a->attr.cmpExpr.lexpr, b->attr.cmpExpr.lexpr)
+        && sameExpr(a->attr.cmpExpr.rexpr, b->attr.cmpExpr.rexpr);
+    case AdditiveExpressionK:
+      return a->attr.addExpr.op->attr.TOK == b->attr.addExpr.op->attr.TOK
+        && sameExpr(a->attr.addExpr.lexpr, b->attr.addExpr.lexpr)
+        && sameExpr(a->attr.addExpr.rexpr, b->attr.addExpr.rexpr);
+    case MultiplicativeExpressionK:
+      return a->attr.multExpr.op->attr.TOK == b->attr.multExpr.op->attr.TOK
+        && sameExpr(a->attr.multExpr.lexpr, b->attr.multExpr.lexpr)
+        && sameExpr(a->attr.multExpr.rexpr, b->attr.multExpr.rexpr);
+    case ArrayK:
+      return a->attr.arr._var->symbolInfo == b->attr.arr._var->symbolInfo
+        && sameExpr(a->attr.arr.arr_expr, b->attr.arr.arr_expr);
+    default:
+      return FALSE;
+    }
+}
+
+/* Replaces the invariant at *slot by its temporary */
+static void hoist(TreeNode **slot)
+{
+  TreeNode *t = *slot, *use;
+  SymbolInfo *temp = NULL;
+  int i;
+
+  for (i = 0; i < nHoisted; ++i)
+    if (sameExpr(hoisted[i].expr, t))
+      temp = hoisted[i].temp;
+  if (temp == NULL)
+    {
+      TreeNode *decl = newScalarDeclarationNode("_inv");
+      temp = decl->attr.varDecl._var->symbolInfo;
+      decl->sibling = func->attr.funcDecl.cmpd_stmt->attr.cmpdStmt.local_decl;
+      func->attr.funcDecl.cmpd_stmt->attr.cmpdStmt.local_decl = decl;
+      GROW(hoisted, nHoisted, capHoisted);
+      hoisted[nHoisted].expr = t;
+      hoisted[nHoisted].temp = temp;
+      nHoisted++;
+      speculative |= mayFault(t);
+    }
+
+  use = newSymbolUseNode("_inv", temp);
+  use->sibling = t->sibling;
+  t->sibling = NULL;
+  *slot = use;
+  total++;
+}
+
+/* Hoists the largest invariant subtrees of an expression */
+static void hoistExpr(TreeNode **slot, int always)
+{
+  TreeNode *t = *slot, **kids[3];
+  int i, n;
+
+  if (t->nodeKind != ConstantK && t->nodeKind != VariableK
+      && !hasSideEffect(t) && invariant(t, always))
+    {
+      hoist(slot);
+      return;
+    }
+  if (t->nodeKind == CallK)
+    {
+      for (kids[0] = &t->attr.call.expr_list; *kids[0] != NULL; kids[0] = &(*kids[0])->sibling)
+        hoistExpr(kids[0], always);
+      return;
+    }
+  if (t->nodeKind == AssignExpressionK)
+    {
+      hoistExpr(&t->attr.assignStmt.expr, always);
+      if (t->attr.assignStmt._var->nodeKind == ArrayK)
+        hoistExpr(&t->attr.assignStmt._var->attr.arr.arr_expr, always);
+      return;
+    }
+  n = treeChildren(t, kids);
+  for (i = 0; i < n; ++i)
+    if (*kids[i] != NULL)
+      hoistExpr(kids[i], always);
+}
+
+/* TRUE if the statement may leave the function */
+static int mayReturn(TreeNode *t)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == ReturnStatementK)
+        return TRUE;
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        if (mayReturn(*kids[i]))
+          return TRUE;
+    }
+  return FALSE;
+}
+
+/* Hoists from the statements of a loop body; always is
+ * TRUE while every iteration is sure to run them. What
+ * a return may skip stays put: it is often the path of
+ * a recursion turned into a loop, run far less often
+ * than the loop is entered.
+ */
+static void hoistStmts(TreeNode *t, int always)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      int exits = mayReturn(t);
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          hoistStmts(t->attr.cmpdStmt.stmt_list, always);
+          break;
+        case ExpressionStatementK:
+          if (t->attr.exprStmt.expr != NULL)
+            hoistExpr(&t->attr.exprStmt.expr, always);
+          break;
+        case ReturnStatementK:
+          break;
+        case SelectionStatementK:
+          hoistExpr(&t->attr.selectStmt.expr, always);
+          if (!exits)
+            {
+              hoistStmts(t->attr.selectStmt.if_stmt, FALSE);
+              hoistStmts(t->attr.selectStmt.else_stmt, FALSE);
+            }
+          break;
+        case IterationStatementK:
+          hoistExpr(&t->attr.iterStmt.expr, always);
+          if (!exits)
+            hoistStmts(t->attr.iterStmt.loop_stmt, FALSE);
+          break;
+        default:
+          DONT_OCCUR_PRINT;
+        }
+      if (exits)
+        return;
+    }
+}
+
+/* Builds the preheader of the loop at *link */
+static void hoistLoop(TreeNode **link)
+{
+  TreeNode *loop = *link, *guard = NULL, *pre = NULL, *next = loop->sibling;
+  SymbolMap map = { 0, 0, NULL, NULL };
+  int i;
+
+  memset(&effect, 0, sizeof(effect));
+  collectEffects(loop->attr.iterStmt.expr);
+  collectEffects(loop->attr.iterStmt.loop_stmt);
+  nHoisted = 0;
+  speculative = FALSE;
+
+  // loads and divisions run before the loop only behind a copy
+  // of the condition, which must be free of side effects
+  if (!hasSideEffect(loop->attr.iterStmt.expr))
+    {
+      guard = cloneTree(loop->attr.iterStmt.expr, &map);
+      free(map.from);
+      free(map.to);
+    }
+  hoistExpr(&loop->attr.iterStmt.expr, guard != NULL);
+  hoistStmts(loop->attr.iterStmt.loop_stmt, guard != NULL);
+
+  if (nHoisted > 0)
+    {
+      for (i = 0; i < nHoisted; ++i)
+        {
+          TreeNode *assign = newAssignExpressionNode(newSymbolUseNode("_inv", hoisted[i].temp),
+                                                     hoisted[i].expr);
+          TreeNode *stmt = newExpressionStatementNode(assign);
+          assign->nodeType = IntT;
+          stmt->nodeType = NoneT;
+          pre = addSibling(pre, stmt);
+        }
+      loop->sibling = NULL;
+      if (speculative)
+        {
+          //   if (c) { pre; while (c) body }
+          TreeNode *cmpd = newCompoundStatementNode(NULL, addSibling(pre, loop));
+          TreeNode *sel = newSelectionStatementNode(guard, cmpd, NULL);
+          cmpd->nodeType = sel->nodeType = NoneT;
+          sel->sibling = next;
+          *link = sel;
+        }
+      else
+        {
+          //   pre; while (c) body
+          addSibling(pre, loop);
+          loop->sibling = next;
+          *link = pre;
+        }
+    }
+
+  free(effect.defs);
+  free(effect.stores);
+}
+
+static void walkStmts(TreeNode **link)
+{
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          walkStmts(&t->attr.cmpdStmt.stmt_list);
+          break;
+        case SelectionStatementK:
+          walkStmts(&t->attr.selectStmt.if_stmt);
+          walkStmts(&t->attr.selectStmt.else_stmt);
+          break;
+        case IterationStatementK:
+          // inner loops first, so their invariants can move further out
+          walkStmts(&t->attr.iterStmt.loop_stmt);
+          hoistLoop(link);
+          // skip the preheader statements just put in front
+          while (*link != t && (*link)->nodeKind != SelectionStatementK)
+            link = &(*link)->sibling;
+          break;
+        default:
+          break;
+        }
+    }
+}
+
+/* Function hoistLoopInvariants moves loop-invariant
+ * computations of a function into loop preheaders
+ */
+int hoistLoopInvariants(TreeNode *f)
+{
+  func = f;
+  total = 0;
+  walkStmts(&func->attr.funcDecl.cmpd_stmt);
+  free(hoisted);
+  hoisted = NULL;
+  nHoisted = capHoisted = 0;
+  func = NULL;
+  return total;
+}
@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: licm.h                                     */
+/* Loop-invariant code motion for the C- compiler   */
+/****************************************************/
+
+#ifndef _LICM_H_
+#define _LICM_H_
+
+/* Function hoistLoopInvariants moves the computations
+ * of every while loop of a function whose operands
+ * the loop never changes into a preheader in front of
+ * it, innermost loops first. Array loads move only if
+ * no store or call in the loop may alias them. Returns
+ * the number of expressions hoisted.
+ */
+int hoistLoopInvariants(TreeNode *func);
+
+#endif
@@ -0,0 +1,137 @@
+/****************************************************/
+/* File: lir.c                                      */
+/* MIPS instruction lists with virtual registers    */
+/* for the C- code generator                        */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "lir.h"
+
+static const char *regNames[32] = {
+    "$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3",
+    "$t0", "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7",
+    "$s0", "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7",
+    "$t8", "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra"
+};
+
+Lir lirNew(void)
+{
+  Lir lir;
+  MALLOC(lir, sizeof(*lir));
+  memset(lir, 0, sizeof(*lir));
+  lir->nRegs = VREG_BASE;
+  return lir;
+}
+
+void lirFree(Lir lir)
+{
+  int i;
+  for (i = 0; i < lir->n; ++i)
+    free(lir->code[i].label);
+  free(lir->code);
+  free(lir);
+}
+
+int lirReg(Lir lir)
+{
+  return lir->nRegs++;
+}
+
+LirInstr *lirEmit(Lir lir, LirKind kind, const char *op,
+                  int dst, int src0, int src1, int imm, const char *label)
+{
+  LirInstr *in;
+
+  GROW(lir->code, lir->n, lir->cap);
+  in = &lir->code[lir->n++];
+  in->kind = kind;
+  in->op = op;
+  in->dst = dst;
+  in->src[0] = src0;
+  in->src[1] = src1;
+  in->imm = imm;
+  in->label = label != NULL ? copyString(label) : NULL;
+  in->area = FrameNone;
+  return in;
+}
+
+const char *lirRegName(int reg)
+{
+  if (reg < 0 || IS_VREG(reg))
+    DONT_OCCUR_PRINT;
+  return regNames[reg];
+}
+
+void lirPrintInstr(LirInstr *in, FILE *out)
+{
+  switch (in->kind)
+    {
+    case LirLabel:
+      fprintf(out, "%s:\n", in->label);
+      break;
+    case LirComment:
+      fprintf(out, "%s\n", in->label);
+      break;
+    case LirRRR:
+    case LirCondMove:
+      fprintf(out, "%s %s, %s, %s\n", in->op, lirRegName(in->dst),
+              lirRegName(in->src[0]), lirRegName(in->src[1]));
+      break;
+    case LirMulHi:
+      fprintf(out, "mult %s, %s\n", lirRegName(in->src[0]), lirRegName(in->src[1]));
+      fprintf(out, "mfhi %s\n", lirRegName(in->dst));
+      break;
+    case LirRRI:
+      fprintf(out, "%s %s, %s, %d\n", in->op, lirRegName(in->dst),
+              lirRegName(in->src[0]), in->imm);
+      break;
+    case LirRI:
+      fprintf(out, "%s %s, %d\n", in->op, lirRegName(in->dst), in->imm);
+      break;
+    case LirRL:
+      fprintf(out, "%s %s, %s\n", in->op, lirRegName(in->dst), in->label);
+      break;
+    case LirRR:
+      fprintf(out, "%s %s, %s\n", in->op, lirRegName(in->dst), lirRegName(in->src[0]));
+      break;
+    case LirLoad:
+      if (in->src[0] < 0)
+        fprintf(out, "%s %s, %s\n", in->op, lirRegName(in->dst), in->label);
+      else
+        fprintf(out, "%s %s, %d(%s)\n", in->op, lirRegName(in->dst), in->imm,
+                lirRegName(in->src[0]));
+      break;
+    case LirStore:
+      if (in->src[1] < 0)
+        fprintf(out, "%s %s, %s\n", in->op, lirRegName(in->src[0]), in->label);
+      else
+        fprintf(out, "%s %s, %d(%s)\n", in->op, lirRegName(in->src[0]), in->imm,
+                lirRegName(in->src[1]));
+      break;
+    case LirBranch:
+      if (in->src[1] < 0)
+        fprintf(out, "%s %s, %s\n", in->op, lirRegName(in->src[0]), in->label);
+      else
+        fprintf(out, "%s %s, %s, %s\n", in->op, lirRegName(in->src[0]),
+                lirRegName(in->src[1]), in->label);
+      break;
+    case LirJump:
+    case LirCall:
+    case LirTailCall:
+      fprintf(out, "%s %s\n", in->op, in->label);
+      break;
+    case LirSyscall:
+      fprintf(out, "syscall\n");
+      break;
+    default:
+      DONT_OCCUR_PRINT;
+    }
+}
+
+void lirPrint(Lir lir, FILE *out)
+{
+  int i;
+  for (i = 0; i < lir->n; ++i)
+    lirPrintInstr(&lir->code[i], out);
+}
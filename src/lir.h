@@ -0,0 +1,121 @@
+/****************************************************/
+/* File: lir.h                                      */
+/* MIPS instruction lists with virtual registers    */
+/* for the C- code generator                        */
+/****************************************************/
+
+#ifndef _LIR_H_
+#define _LIR_H_
+
+#include "globals.h"
+
+/* machine registers */
+#define REG_ZERO 0
+#define REG_V0 2
+#define REG_V1 3
+#define REG_A0 4        /* $a0..$a3 are 4..7 */
+#define REG_T0 8        /* $t0..$t7 are 8..15 */
+#define REG_S0 16       /* $s0..$s7 are 16..23 */
+#define REG_T8 24
+#define REG_T9 25
+#define REG_GP 28
+#define REG_SP 29
+#define REG_FP 30
+#define REG_RA 31
+
+/* registers numbered from VREG_BASE on are virtual;
+ * the register allocator maps them onto machine
+ * registers
+ */
+#define VREG_BASE 32
+#define IS_VREG(r) ((r) >= VREG_BASE)
+
+/* The shape of an instruction, which decides how its
+ * operands print and which registers it reads and
+ * writes
+ */
+typedef enum {
+    LirLabel,    /* label: */
+    LirComment,  /* a comment line (label holds the text) */
+    LirRRR,      /* op dst, src0, src1 */
+    LirMulHi,    /* mult src0, src1; mfhi dst (high word of the product) */
+    LirRRI,      /* op dst, src0, imm */
+    LirRI,       /* op dst, imm (li) */
+    LirRL,       /* op dst, label (la) */
+    LirRR,       /* op dst, src0 (move) */
+    LirCondMove, /* op dst, src0, src1 (movz, movn); reads dst, which
+                  * keeps its value when the move is not made */
+    LirLoad,     /* op dst, imm(src0); op dst, label when src0 < 0 */
+    LirStore,    /* op src0, imm(src1); op src0, label when src1 < 0 */
+    LirBranch,   /* op src0, src1, label; op src0, label when src1 < 0 */
+    LirJump,     /* j label */
+    LirCall,     /* jal label; reads $a0.. up to imm of them and
+                  * clobbers the caller-saved registers */
+    LirTailCall, /* j label after leaving the frame (tail calls);
+                  * reads $a0.. up to imm of them */
+    LirSyscall,  /* syscall; reads $v0 and src0 ($a0, or -1), writes $v0 */
+} LirKind;
+
+/* The part of the frame a $fp offset is relative to
+ * ($fp stands for the $sp on entry); the code generator
+ * places the parts once their sizes are known and
+ * addresses them from $sp
+ */
+typedef enum {
+    FrameNone,   /* $fp itself: the parameters */
+    FrameSpill,  /* the spill slots, below the saved registers */
+    FrameLocal,  /* the local arrays, below the spill slots */
+} FrameArea;
+
+typedef struct
+{
+  LirKind kind;
+  const char *op;
+  int dst;
+  int src[2];
+  int imm;
+  char *label;
+  FrameArea area;
+} LirInstr;
+
+/* The instructions of one function body */
+typedef struct LirRec
+{
+  int n, cap;
+  LirInstr *code;
+  int nRegs;          /* next virtual register number */
+  int spillBytes;     /* size of the spill slots (allocateRegisters) */
+  unsigned usedRegs;  /* machine registers assigned (allocateRegisters) */
+} * Lir;
+
+/* Function lirNew returns an empty instruction list */
+Lir lirNew(void);
+
+/* Procedure lirFree releases an instruction list */
+void lirFree(Lir lir);
+
+/* Function lirReg returns a fresh virtual register */
+int lirReg(Lir lir);
+
+/* Function lirEmit appends an instruction and returns
+ * it; unused operands are -1, 0 or NULL
+ */
+LirInstr *lirEmit(Lir lir, LirKind kind, const char *op,
+                  int dst, int src0, int src1, int imm, const char *label);
+
+/* Function lirRegName returns the assembler name of a
+ * machine register
+ */
+const char *lirRegName(int reg);
+
+/* Procedure lirPrintInstr writes one instruction whose
+ * registers have been allocated
+ */
+void lirPrintInstr(LirInstr *in, FILE *out);
+
+/* Procedure lirPrint writes the instructions of a list
+ * whose registers have all been allocated
+ */
+void lirPrint(Lir lir, FILE *out);
+
+#endif
@@ -10,6 +10,23 @@
     }\
 } while(0)
 
+#define REALLOC(ptr, size) do { \
+    ptr = realloc(ptr, size);\
+    if(ptr == NULL) {\
+        fprintf(listing, "%s:%d:%s: Memory allocation failed.\n", \
+                __FILE__, __LINE__, __FUNCTION__); \
+        assert(0);\
+    }\
+} while(0)
+
+/* grow a (pointer, count, capacity) array to hold one more item */
+#define GROW(arr, cnt, cap) do { \
+    if((cnt) >= (cap)) {\
+        (cap) = (cap) ? (cap) * 2 : 8;\
+        REALLOC(arr, (cap) * sizeof(*(arr)));\
+    }\
+} while(0)
+
 #ifdef  DEBUG
 
 /* file:line:function: */
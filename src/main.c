@@ -25,6 +25,8 @@
 #if !NO_ANALYZE
 #include "analyze.h"
 #if !NO_CODE
+#include "bounds.h"
+#include "optimize.h"
 #include "cgen.h"
 #endif
 #endif
@@ -42,6 +44,14 @@ int TraceScan = FALSE;
 int TraceParse = FALSE;
 int TraceAnalyze = TRUE;
 int TraceCode = TRUE;
+int TraceOptimize = TRUE;
+
+/* allocate and set optimization flags */
+int Optimize = TRUE;
+int UnrollFactor = 4;
+int BoundsCheck = FALSE;
+int IfConvertLimit = 4;
+int RegisterArgs = TRUE;
 
 int Error = FALSE;
 
@@ -50,12 +60,30 @@ main(int argc, char* argv[])
 {
   TreeNode * syntaxTree;
   char pgm[120]; /* source code file name */
-  if (argc != 2)
+  int argi;
+  for (argi = 1; argi < argc && argv[argi][0] == '-'; ++argi)
+    {
+      if (strcmp(argv[argi],"-O0") == 0)
+        Optimize = FALSE;
+      else if (strcmp(argv[argi],"-O") == 0)
+        Optimize = TRUE;
+      else if (strncmp(argv[argi],"-funroll=",9) == 0 && atoi(argv[argi] + 9) >= 1)
+        UnrollFactor = atoi(argv[argi] + 9);
+      else if (strcmp(argv[argi],"-fbounds-check") == 0)
+        BoundsCheck = TRUE;
+      else if (strncmp(argv[argi],"-fifconvert=",12) == 0 && atoi(argv[argi] + 12) >= 0)
+        IfConvertLimit = atoi(argv[argi] + 12);
+      else if (strcmp(argv[argi],"-fstack-args") == 0)
+        RegisterArgs = FALSE;
+      else
+        break;
+    }
+  if (argi != argc - 1)
     {
-      fprintf(stderr,"usage: %s <filename>\n",argv[0]);
+      fprintf(stderr,"usage: %s [-O0] [-funroll=N] [-fbounds-check] [-fifconvert=N] [-fstack-args] <filename>\n",argv[0]);
       exit(1);
     }
-  strcpy(pgm,argv[1]) ;
+  strcpy(pgm,argv[argi]) ;
   if (strchr (pgm, '.') == NULL)
     {
      strcat(pgm,".tny");
@@ -110,6 +138,10 @@ main(int argc, char* argv[])
       printf("Unable to open %s\n",codefile);
       exit(1);
     }
+    if (BoundsCheck)
+      insertBoundsChecks(syntaxTree);
+    if (Optimize)
+      syntaxTree = optimize(syntaxTree);
     codeGen(syntaxTree, code);
     fclose(code);
   }
@@ -0,0 +1,90 @@
+/****************************************************/
+/* File: optimize.c                                 */
+/* Optimizer for the C- compiler                    */
+/* Runs the tree-level passes between semantic      */
+/* analysis and code generation                     */
+/****************************************************/
+
+#include "globals.h"
+#include "optimize.h"
+#include "bounds.h"
+#include "constprop.h"
+#include "range.h"
+#include "ipcp.h"
+#include "tailrec.h"
+#include "inline.h"
+#include "unswitch.h"
+#include "unroll.h"
+#include "reassoc.h"
+#include "idiom.h"
+#include "fusion.h"
+#include "licm.h"
+#include "indvar.h"
+#include "valnum.h"
+#include "deadcode.h"
+#include "unused.h"
+
+/* Function optimize rewrites the decorated syntax
+ * tree before code generation and returns its new root
+ */
+TreeNode *optimize(TreeNode *syntaxTree)
+{
+  TreeNode *t;
+
+  // cgen sets globalFlag when it lays out memory; the
+  // passes need it earlier to tell globals from locals
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodeKind == VariableDeclarationK)
+      t->attr.varDecl._var->symbolInfo->attr.intInfo.globalFlag = TRUE;
+    else if (t->nodeKind == ArrayDeclarationK)
+      t->attr.arrDecl._var->symbolInfo->attr.arrInfo.globalFlag = TRUE;
+
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind != FunctionDeclarationK)
+        continue;
+
+      constantPropagation(t);
+    }
+
+  interproceduralConstants(syntaxTree);
+
+  // loops instead of self calls make more functions inlinable
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodeKind == FunctionDeclarationK)
+      eliminateTailRecursion(t);
+
+  inlineCalls(syntaxTree);
+  unswitchLoops(syntaxTree);
+
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodeKind == FunctionDeclarationK)
+      {
+        int checks = 0, hoisted = 0;
+
+        if (unrollConstantLoops(t) > 0)
+          constantPropagation(t);
+        // checks left in loops here would keep the loop passes from
+        // recognizing the accesses
+        if (BoundsCheck)
+          {
+            checks = countBoundsChecks(t->attr.funcDecl.cmpd_stmt);
+            hoisted = hoistBoundsChecks(t);
+          }
+        if (propagateRanges(t) > 0)
+          constantPropagation(t);
+        if (BoundsCheck)
+          reportBoundsChecks(t, checks, hoisted);
+        recognizeIdioms(t);
+        fuseLoops(t);
+        splitLoops(t);
+        hoistLoopInvariants(t);
+        reduceInductionVariables(t);
+        unrollLoops(t);
+        reassociate(t);
+        valueNumbering(t);
+        eliminateDeadCode(t);
+      }
+
+  return removeUnused(syntaxTree);
+}
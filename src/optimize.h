@@ -0,0 +1,15 @@
+/****************************************************/
+/* File: optimize.h                                 */
+/* Optimizer interface for the C- compiler          */
+/****************************************************/
+
+#ifndef _OPTIMIZE_H_
+#define _OPTIMIZE_H_
+
+/* Function optimize rewrites the decorated syntax
+ * tree before code generation and returns its new
+ * root (unused declarations may be dropped)
+ */
+TreeNode *optimize(TreeNode *);
+
+#endif
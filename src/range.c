@@ -0,0 +1,608 @@
+/****************************************************/
+/* File: range.c                                    */
+/* Value-range analysis for the C- compiler         */
+/****************************************************/
+
+#include <limits.h>
+#include "globals.h"
+#include "util.h"
+#include "cfg.h"
+#include "bounds.h"
+#include "range.h"
+
+/* The values a scalar may hold: lo <= v <= hi.
+ * An unreached block has no ranges at all, so an
+ * empty range never has to be represented.
+ */
+typedef struct
+{
+  int lo, hi;
+} Range;
+
+static const Range rangeAll = { INT_MIN, INT_MAX };
+
+/* state of one run of the pass */
+static Cfg cfg;
+static Range **blockIn;    /* block id -> ranges on entry, NULL if not yet reached */
+static Range **blockOut;   /* block id -> ranges before the block's branch */
+static Range *condRange;   /* block id -> range of its branch condition */
+static int *loopHeader;    /* block id -> TRUE if a back edge enters it */
+static int rewrites;
+
+/* A computed range; anything that may wrap around
+ * 32 bits may hold any value
+ */
+static Range rangeOf(long long lo, long long hi)
+{
+  Range r;
+  if (lo < INT_MIN || hi > INT_MAX)
+    return rangeAll;
+  r.lo = (int) lo;
+  r.hi = (int) hi;
+  return r;
+}
+
+static Range rangeJoin(Range a, Range b)
+{
+  Range r;
+  r.lo = a.lo < b.lo ? a.lo : b.lo;
+  r.hi = a.hi > b.hi ? a.hi : b.hi;
+  return r;
+}
+
+static int isPoint(Range r)
+{
+  return r.lo == r.hi;
+}
+
+/* Range of lo..hi of a op b over the corners of two
+ * ranges; right for operators monotone in each operand
+ * over the ranges given
+ */
+static Range corners(TokenType op, Range l, Range r)
+{
+  long long c[4], lo, hi;
+  int i;
+
+  c[0] = l.lo; c[1] = l.lo; c[2] = l.hi; c[3] = l.hi;
+  for (i = 0; i < 4; ++i)
+    {
+      long long d = i % 2 ? r.hi : r.lo;
+      c[i] = op == TIMES ? c[i] * d : c[i] / d;
+    }
+  lo = hi = c[0];
+  for (i = 1; i < 4; ++i)
+    {
+      if (c[i] < lo) lo = c[i];
+      if (c[i] > hi) hi = c[i];
+    }
+  return rangeOf(lo, hi);
+}
+
+/* Range of a binary operator over two ranges, with
+ * the C- (32-bit wraparound) semantics of constprop
+ */
+static Range rangeBinary(TokenType op, Range l, Range r)
+{
+  int yes = -1;
+
+  switch (op)
+    {
+    case PLUS: return rangeOf((long long) l.lo + r.lo, (long long) l.hi + r.hi);
+    case MINUS: return rangeOf((long long) l.lo - r.hi, (long long) l.hi - r.lo);
+    case TIMES: return corners(TIMES, l, r);
+    case OVER:
+      if (r.lo > 0 || r.hi < 0)
+        return corners(OVER, l, r);
+      else
+        {
+          // the divisor may be zero or change sign: |quotient| <= |dividend|
+          long long m = -(long long) l.lo > l.hi ? -(long long) l.lo : l.hi;
+          return rangeOf(-m, m);
+        }
+    case SHR:
+      if (!isPoint(r) || r.lo < 0 || r.lo > 31)
+        return rangeAll;
+      return rangeOf(l.lo >> r.lo, l.hi >> r.lo);
+
+    case LT:
+      if (l.hi < r.lo) yes = 1; else if (l.lo >= r.hi) yes = 0;
+      break;
+    case LE:
+      if (l.hi <= r.lo) yes = 1; else if (l.lo > r.hi) yes = 0;
+      break;
+    case GT:
+      if (l.lo > r.hi) yes = 1; else if (l.hi <= r.lo) yes = 0;
+      break;
+    case GE:
+      if (l.lo >= r.hi) yes = 1; else if (l.hi < r.lo) yes = 0;
+      break;
+    case EQ:
+    case NE:
+      if (isPoint(l) && isPoint(r) && l.lo == r.lo) yes = 1;
+      else if (l.hi < r.lo || r.hi < l.lo) yes = 0;
+      if (op == NE && yes >= 0) yes = !yes;
+      break;
+    default:
+      DONT_OCCUR_PRINT;
+      return rangeAll;
+    }
+  return yes < 0 ? rangeOf(0, 1) : rangeOf(yes, yes);
+}
+
+/* Narrows *x to the values v with v op r for some
+ * value of r. Returns FALSE if none is left.
+ */
+static int constrain(Range *x, TokenType op, Range r)
+{
+  long long lo = x->lo, hi = x->hi;
+
+  switch (op)
+    {
+    case LT: if ((long long) r.hi - 1 < hi) hi = (long long) r.hi - 1; break;
+    case LE: if (r.hi < hi) hi = r.hi; break;
+    case GT: if ((long long) r.lo + 1 > lo) lo = (long long) r.lo + 1; break;
+    case GE: if (r.lo > lo) lo = r.lo; break;
+    case EQ:
+      if (r.lo > lo) lo = r.lo;
+      if (r.hi < hi) hi = r.hi;
+      break;
+    case NE:
+      if (isPoint(r))
+        {
+          if (lo == r.lo) lo++;
+          else if (hi == r.lo) hi--;
+        }
+      break;
+    default:
+      DONT_OCCUR_PRINT;
+    }
+  if (lo > hi)
+    return FALSE;
+  x->lo = (int) lo;
+  x->hi = (int) hi;
+  return TRUE;
+}
+
+/* the comparison that holds when op does not */
+static TokenType negateOp(TokenType op)
+{
+  switch (op)
+    {
+    case LT: return GE;
+    case LE: return GT;
+    case GT: return LE;
+    case GE: return LT;
+    case EQ: return NE;
+    default: return EQ;
+    }
+}
+
+/* the comparison with its operands swapped */
+static TokenType swapOp(TokenType op)
+{
+  switch (op)
+    {
+    case LT: return GT;
+    case LE: return GE;
+    case GT: return LT;
+    case GE: return LE;
+    default: return op;
+    }
+}
+
+/* log2 of a power of two above one, or -1 */
+static int shiftOf(int value)
+{
+  int k;
+  if (value < 2 || (value & (value - 1)) != 0)
+    return -1;
+  for (k = 0; (1 << k) != value; ++k)
+    ;
+  return k;
+}
+
+static Range evalExpr(TreeNode *t, Range *env, int rewrite);
+
+/* Evaluates the index of an array access; a tracked
+ * scalar used as the index of an array of known
+ * length is within its bounds afterwards
+ */
+static void evalIndex(TreeNode *arr, Range *env, int rewrite)
+{
+  TreeNode *index = arr->attr.arr.arr_expr;
+  SymbolInfo *sym = arr->attr.arr._var->symbolInfo;
+  int idx;
+
+  evalExpr(index, env, rewrite);
+  if (index->nodeKind != VariableK || sym->attr.arrInfo.isParam
+      || sym->attr.arrInfo.arrLen <= 0)
+    return;
+  idx = cfgVarIndex(cfg, index->symbolInfo);
+  if (idx >= 0)
+    {
+      Range r = env[idx];
+      if (constrain(&r, GE, rangeOf(0, 0))
+          && constrain(&r, LT, rangeOf(sym->attr.arrInfo.arrLen, sym->attr.arrInfo.arrLen)))
+        env[idx] = r;
+    }
+}
+
+/* Evaluates an expression in the order cgen emits it,
+ * updating env for assignments to tracked scalars.
+ * With rewrite set, side-effect free subtrees with a
+ * single possible value are replaced by constants and
+ * divisions of non-negative values by a power of two
+ * by shifts.
+ */
+static Range evalExpr(TreeNode *t, Range *env, int rewrite)
+{
+  Range v = rangeAll;
+  int idx;
+
+  switch (t->nodeKind)
+    {
+    case ConstantK:
+      return rangeOf(t->attr.NUM, t->attr.NUM);
+
+    case VariableK:
+      idx = cfgVarIndex(cfg, t->symbolInfo);
+      if (idx < 0)
+        return rangeAll;
+      v = env[idx];
+      if (rewrite && isPoint(v))
+        {
+          setConstantNode(t, v.lo);
+          rewrites++;
+        }
+      return v;
+
+    case ArrayK:
+      evalIndex(t, env, rewrite);
+      return rangeAll;
+
+    case AssignExpressionK:
+    {
+      TreeNode *var = t->attr.assignStmt._var;
+      v = evalExpr(t->attr.assignStmt.expr, env, rewrite);
+      if (var->nodeKind == VariableK)
+        {
+          idx = cfgVarIndex(cfg, var->symbolInfo);
+          if (idx >= 0)
+            env[idx] = v;
+        }
+      else if (var->nodeKind == ArrayK)
+        evalIndex(var, env, rewrite);
+      else
+        DONT_OCCUR_PRINT;
+      return v;
+    }
+
+    case ComparisonExpressionK:
+    {
+      Range l = evalExpr(t->attr.cmpExpr.lexpr, env, rewrite);
+      Range r = evalExpr(t->attr.cmpExpr.rexpr, env, rewrite);
+      v = rangeBinary(t->attr.cmpExpr.op->attr.TOK, l, r);
+      break;
+    }
+    case AdditiveExpressionK:
+    {
+      Range l = evalExpr(t->attr.addExpr.lexpr, env, rewrite);
+      Range r = evalExpr(t->attr.addExpr.rexpr, env, rewrite);
+      v = rangeBinary(t->attr.addExpr.op->attr.TOK, l, r);
+      break;
+    }
+    case MultiplicativeExpressionK:
+    {
+      Range l = evalExpr(t->attr.multExpr.lexpr, env, rewrite);
+      Range r = evalExpr(t->attr.multExpr.rexpr, env, rewrite);
+      TreeNode *divisor = t->attr.multExpr.rexpr;
+      v = rangeBinary(t->attr.multExpr.op->attr.TOK, l, r);
+      if (rewrite && t->attr.multExpr.op->attr.TOK == OVER && l.lo >= 0
+          && divisor->nodeKind == ConstantK && shiftOf(divisor->attr.NUM) > 0)
+        {
+          // truncation and flooring agree on non-negative dividends
+          t->attr.multExpr.op->attr.TOK = SHR;
+          divisor->attr.NUM = shiftOf(divisor->attr.NUM);
+          rewrites++;
+        }
+      break;
+    }
+
+    case CallK:
+    {
+      TreeNode *arg;
+      if (isBoundsCheck(t))
+        {
+          // an index that gets past the check is within the array
+          Range in = rangeOf(0, t->attr.call.expr_list->sibling->attr.NUM - 1);
+          arg = t->attr.call.expr_list;
+          v = evalExpr(arg, env, rewrite);
+          if (in.lo <= v.lo && v.hi <= in.hi)
+            {
+              if (rewrite)
+                {
+                  removeBoundsCheck(t);
+                  rewrites++;
+                }
+              return v;
+            }
+          if (arg->nodeKind == VariableK && (idx = cfgVarIndex(cfg, arg->symbolInfo)) >= 0)
+            constrain(&env[idx], EQ, in);
+          return constrain(&v, EQ, in) ? v : in;
+        }
+      for (arg = t->attr.call.expr_list; arg != NULL; arg = arg->sibling)
+        evalExpr(arg, env, rewrite);
+      return rangeAll;
+    }
+
+    default:
+      DONT_OCCUR_PRINT;
+      return rangeAll;
+    }
+
+  if (rewrite && isPoint(v) && !hasSideEffect(t))
+    {
+      setConstantNode(t, v.lo);
+      rewrites++;
+    }
+  return v;
+}
+
+/* Narrows env to the states in which cond has the
+ * given truth value. Returns FALSE if there are none.
+ */
+static int refine(Range *env, TreeNode *cond, int truth)
+{
+  TreeNode *lexpr, *rexpr;
+  TokenType op;
+  Range l, r;
+  int idx;
+
+  if (cond->nodeKind == VariableK)
+    {
+      idx = cfgVarIndex(cfg, cond->symbolInfo);
+      return idx < 0 || constrain(&env[idx], truth ? NE : EQ, rangeOf(0, 0));
+    }
+  if (cond->nodeKind != ComparisonExpressionK)
+    return TRUE;
+
+  op = cond->attr.cmpExpr.op->attr.TOK;
+  if (!truth)
+    op = negateOp(op);
+  lexpr = cond->attr.cmpExpr.lexpr;
+  rexpr = cond->attr.cmpExpr.rexpr;
+  l = evalExpr(lexpr, env, FALSE);
+  r = evalExpr(rexpr, env, FALSE);
+  if (lexpr->nodeKind == VariableK && (idx = cfgVarIndex(cfg, lexpr->symbolInfo)) >= 0
+      && !constrain(&env[idx], op, r))
+    return FALSE;
+  if (rexpr->nodeKind == VariableK && (idx = cfgVarIndex(cfg, rexpr->symbolInfo)) >= 0
+      && !constrain(&env[idx], swapOp(op), l))
+    return FALSE;
+  return TRUE;
+}
+
+/* Turns the exit ranges of block b in env into the
+ * ranges along its edge to succ[which]. Returns FALSE
+ * if that edge is never taken.
+ */
+static int edgeRanges(CfgBlock b, int which, Range *env)
+{
+  Range c;
+
+  if (b->term != CfgBranch)
+    return b->term == CfgJump && which == 0;
+  c = condRange[b->id];
+  if (which == 0 ? (c.lo == 0 && c.hi == 0) : (c.lo > 0 || c.hi < 0))
+    return FALSE;
+  if (hasSideEffect(b->cond))
+    return TRUE;
+  return refine(env, b->cond, which == 0);
+}
+
+/* Joins env into the entry ranges of block b, widening
+ * whatever still grows at a loop header to the full
+ * range. Returns TRUE if b has to be (re)visited.
+ */
+static int propagate(CfgBlock b, Range *env)
+{
+  int i, changed = FALSE;
+
+  if (blockIn[b->id] == NULL)
+    {
+      MALLOC(blockIn[b->id], (cfg->nVars + 1) * sizeof(Range));
+      memcpy(blockIn[b->id], env, cfg->nVars * sizeof(Range));
+      return TRUE;
+    }
+  for (i = 0; i < cfg->nVars; ++i)
+    {
+      Range old = blockIn[b->id][i], m = rangeJoin(old, env[i]);
+      if (loopHeader[b->id])
+        {
+          if (m.lo < old.lo) m.lo = INT_MIN;
+          if (m.hi > old.hi) m.hi = INT_MAX;
+        }
+      if (m.lo != old.lo || m.hi != old.hi)
+        {
+          blockIn[b->id][i] = m;
+          changed = TRUE;
+        }
+    }
+  return changed;
+}
+
+/* Evaluates block b from its entry ranges, recording
+ * its exit ranges and the range of its condition
+ */
+static void evalBlock(CfgBlock b, Range *env, int rewrite)
+{
+  int i;
+  memcpy(env, blockIn[b->id], cfg->nVars * sizeof(Range));
+  for (i = 0; i < b->nItems; ++i)
+    evalExpr(b->items[i], env, rewrite);
+  if (b->term == CfgBranch)
+    condRange[b->id] = evalExpr(b->cond, env, rewrite);
+  if (blockOut[b->id] == NULL)
+    MALLOC(blockOut[b->id], (cfg->nVars + 1) * sizeof(Range));
+  memcpy(blockOut[b->id], env, cfg->nVars * sizeof(Range));
+}
+
+static void solve(void)
+{
+  CfgBlock *worklist;
+  int *queued, nWork = 0, i, which;
+  Range *env, *edge;
+
+  MALLOC(worklist, cfg->nBlocks * sizeof(CfgBlock));
+  MALLOC(queued, cfg->nBlocks * sizeof(int));
+  MALLOC(env, (cfg->nVars + 1) * sizeof(Range));
+  MALLOC(edge, (cfg->nVars + 1) * sizeof(Range));
+  memset(queued, 0, cfg->nBlocks * sizeof(int));
+
+  // parameters and fresh locals may hold anything on entry
+  for (i = 0; i < cfg->nVars; ++i)
+    env[i] = rangeAll;
+  propagate(cfg->blocks[0], env);
+  worklist[nWork++] = cfg->blocks[0];
+  queued[0] = TRUE;
+
+  while (nWork > 0)
+    {
+      CfgBlock b = worklist[--nWork];
+      queued[b->id] = FALSE;
+
+      evalBlock(b, env, FALSE);
+      for (which = 0; which < 2; ++which)
+        {
+          CfgBlock s = b->succ[which];
+          if (s == NULL)
+            continue;
+          memcpy(edge, env, cfg->nVars * sizeof(Range));
+          if (edgeRanges(b, which, edge) && propagate(s, edge) && !queued[s->id])
+            {
+              worklist[nWork++] = s;
+              queued[s->id] = TRUE;
+            }
+        }
+    }
+
+  free(worklist);
+  free(queued);
+  free(env);
+  free(edge);
+}
+
+/* Recomputes the entry ranges of every block from its
+ * predecessors in reverse postorder, which takes back
+ * what widening gave away where a loop's own exit test
+ * bounds its counter
+ */
+static void narrow(void)
+{
+  CfgBlock *order;
+  Range *env, *edge, *in;
+  int i, j, round, which;
+
+  MALLOC(order, cfg->nBlocks * sizeof(CfgBlock));
+  MALLOC(env, (cfg->nVars + 1) * sizeof(Range));
+  MALLOC(edge, (cfg->nVars + 1) * sizeof(Range));
+  MALLOC(in, (cfg->nVars + 1) * sizeof(Range));
+  memset(order, 0, cfg->nBlocks * sizeof(CfgBlock));
+  for (i = 0; i < cfg->nBlocks; ++i)
+    if (cfg->blocks[i]->rpo >= 0)
+      order[cfg->blocks[i]->rpo] = cfg->blocks[i];
+
+  for (round = 0; round < 2; ++round)
+    for (i = 1; i < cfg->nBlocks; ++i)
+      {
+        CfgBlock b = order[i];
+        int seen = FALSE;
+        if (b == NULL || blockIn[b->id] == NULL)
+          continue;
+        for (j = 0; j < b->nPreds; ++j)
+          {
+            CfgBlock p = b->preds[j];
+            if (blockIn[p->id] == NULL)
+              continue;
+            for (which = 0; which < 2; ++which)
+              {
+                int k;
+                if (p->succ[which] != b)
+                  continue;
+                memcpy(edge, blockOut[p->id], cfg->nVars * sizeof(Range));
+                if (!edgeRanges(p, which, edge))
+                  continue;
+                for (k = 0; k < cfg->nVars; ++k)
+                  in[k] = seen ? rangeJoin(in[k], edge[k]) : edge[k];
+                seen = TRUE;
+              }
+          }
+        if (!seen)
+          continue;
+        for (j = 0; j < cfg->nVars; ++j)
+          {
+            Range *old = &blockIn[b->id][j];
+            if (in[j].lo <= old->hi && old->lo <= in[j].hi)
+              constrain(old, EQ, in[j]);
+          }
+        evalBlock(b, env, FALSE);
+      }
+
+  free(order);
+  free(env);
+  free(edge);
+  free(in);
+}
+
+/* Function propagateRanges computes the ranges of the
+ * scalar locals of a function and folds what they
+ * decide
+ */
+int propagateRanges(TreeNode *func)
+{
+  int i, j;
+  Range *env;
+
+  cfg = cfgBuild(func);
+  cfgDominators(cfg);
+  rewrites = 0;
+  MALLOC(blockIn, cfg->nBlocks * sizeof(Range *));
+  MALLOC(blockOut, cfg->nBlocks * sizeof(Range *));
+  MALLOC(condRange, cfg->nBlocks * sizeof(Range));
+  MALLOC(loopHeader, cfg->nBlocks * sizeof(int));
+  MALLOC(env, (cfg->nVars + 1) * sizeof(Range));
+  for (i = 0; i < cfg->nBlocks; ++i)
+    {
+      CfgBlock b = cfg->blocks[i];
+      blockIn[i] = blockOut[i] = NULL;
+      condRange[i] = rangeAll;
+      loopHeader[i] = FALSE;
+      for (j = 0; j < b->nPreds; ++j)
+        if (b->rpo >= 0 && b->preds[j]->rpo >= b->rpo)
+          loopHeader[i] = TRUE;
+    }
+
+  solve();
+  narrow();
+
+  // rewrite the reached blocks with the final entry ranges
+  for (i = 0; i < cfg->nBlocks; ++i)
+    if (blockIn[i] != NULL)
+      evalBlock(cfg->blocks[i], env, TRUE);
+
+  for (i = 0; i < cfg->nBlocks; ++i)
+    {
+      free(blockIn[i]);
+      free(blockOut[i]);
+    }
+  free(blockIn);
+  free(blockOut);
+  free(condRange);
+  free(loopHeader);
+  free(env);
+  cfgFree(cfg);
+  cfg = NULL;
+
+  return rewrites;
+}
@@ -0,0 +1,23 @@
+/****************************************************/
+/* File: range.h                                    */
+/* Value-range analysis for the C- compiler         */
+/****************************************************/
+
+#ifndef _RANGE_H_
+#define _RANGE_H_
+
+/* Function propagateRanges computes an interval for
+ * every scalar local of a function at every block of
+ * its control-flow graph, narrowed by the branches
+ * taken and by the length of the arrays indexed, and
+ * uses them to fold comparisons and other expressions
+ * with a single possible value, to remove the bounds
+ * checks of indexes that are always in range and to
+ * turn divisions of non-negative values by a power of
+ * two into shifts. Branches folded this way are left for
+ * constantPropagation to remove.
+ * Returns the number of rewrites made.
+ */
+int propagateRanges(TreeNode *func);
+
+#endif
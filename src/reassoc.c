@@ -0,0 +1,236 @@
+/****************************************************/
+/* File: reassoc.c                                  */
+/* Reassociation of + and * chains for the C-       */
+/* compiler                                         */
+/****************************************************/
+
+#include <limits.h>
+#include "globals.h"
+#include "util.h"
+#include "reassoc.h"
+
+typedef struct
+{
+  TreeNode *t;
+  int negated;          /* subtracted (+ chains only) */
+} Term;
+
+/* the terms of one chain */
+typedef struct
+{
+  Term *terms;
+  int n, cap;
+  unsigned constant;    /* sum or product of the constants, wrapping */
+  int nConstants;
+} Chain;
+
+static int rebuilt;
+
+static void walk(TreeNode *t);
+
+static void addTerm(Chain *c, TreeNode *t, int neg)
+{
+  GROW(c->terms, c->n, c->cap);
+  c->terms[c->n].t = t;
+  c->terms[c->n++].negated = neg;
+}
+
+/* x + k or x - k for a single term x */
+static int isOffset(TreeNode *t)
+{
+  return t->nodeKind == AdditiveExpressionK
+    && t->attr.addExpr.rexpr->nodeKind == ConstantK
+    && t->attr.addExpr.lexpr->nodeKind != AdditiveExpressionK
+    && t->attr.addExpr.lexpr->nodeKind != ConstantK;
+}
+
+/* A right operand x + k stays one term: s + (i + 1) is
+ * most likely next to a[i + 1] or i = i + 1, whose i + 1
+ * value numbering would no longer find
+ */
+static void collectSum(Chain *c, TreeNode *t, int neg)
+{
+  if (t->nodeKind == AdditiveExpressionK)
+    {
+      TreeNode *r = t->attr.addExpr.rexpr;
+      int rneg = t->attr.addExpr.op->attr.TOK == MINUS ? !neg : neg;
+      collectSum(c, t->attr.addExpr.lexpr, neg);
+      if (isOffset(r))
+        {
+          walk(r);
+          addTerm(c, r, rneg);
+        }
+      else
+        collectSum(c, r, rneg);
+    }
+  else if (t->nodeKind == ConstantK)
+    {
+      c->constant += neg ? -(unsigned) t->attr.NUM : (unsigned) t->attr.NUM;
+      c->nConstants++;
+    }
+  else
+    {
+      walk(t);
+      addTerm(c, t, neg);
+    }
+}
+
+static void collectProduct(Chain *c, TreeNode *t)
+{
+  if (t->nodeKind == MultiplicativeExpressionK && t->attr.multExpr.op->attr.TOK == TIMES)
+    {
+      collectProduct(c, t->attr.multExpr.lexpr);
+      collectProduct(c, t->attr.multExpr.rexpr);
+    }
+  else if (t->nodeKind == ConstantK)
+    {
+      c->constant *= (unsigned) t->attr.NUM;
+      c->nConstants++;
+    }
+  else
+    {
+      walk(t);
+      addTerm(c, t, FALSE);
+    }
+}
+
+static TreeNode *binary(NodeKind kind, TreeNode *l, TokenType op, TreeNode *r)
+{
+  TreeNode *t = kind == AdditiveExpressionK
+    ? newAdditiveExpressionNode(l, newTokenTypeNode(op), r)
+    : newMultiplicativeExpressionNode(l, newTokenTypeNode(op), r);
+  t->nodeType = IntT;
+  return t;
+}
+
+/* the terms lo..hi-1 combined by op, as a balanced tree;
+ * an odd term goes to the left half, so that the first
+ * two terms stay paired as the parser left them, for
+ * value numbering to find
+ */
+static TreeNode *balanced(TreeNode **terms, int lo, int hi, NodeKind kind, TokenType op)
+{
+  int mid = (lo + hi + 1) / 2;
+  if (hi - lo == 1)
+    return terms[lo];
+  return binary(kind, balanced(terms, lo, mid, kind, op), op,
+                balanced(terms, mid, hi, kind, op));
+}
+
+/* e + k, as e - (-k) when that is a positive constant */
+static TreeNode *plusConstant(TreeNode *e, int k)
+{
+  if (k < 0 && k != INT_MIN)
+    return binary(AdditiveExpressionK, e, MINUS, newIntConstantNode(-k));
+  return binary(AdditiveExpressionK, e, PLUS, newIntConstantNode(k));
+}
+
+static TreeNode *rebuildSum(Chain *c)
+{
+  TreeNode **pos, **neg, *e;
+  int nPos = 0, nNeg = 0, i, k = (int) c->constant;
+
+  MALLOC(pos, (c->n + 1) * sizeof(TreeNode *));
+  MALLOC(neg, (c->n + 1) * sizeof(TreeNode *));
+  for (i = 0; i < c->n; ++i)
+    if (c->terms[i].negated)
+      neg[nNeg++] = c->terms[i].t;
+    else
+      pos[nPos++] = c->terms[i].t;
+
+  if (nPos > 0)
+    {
+      e = balanced(pos, 0, nPos, AdditiveExpressionK, PLUS);
+      if (nNeg > 0)
+        e = binary(AdditiveExpressionK, e, MINUS, balanced(neg, 0, nNeg, AdditiveExpressionK, PLUS));
+      if (k != 0)
+        e = plusConstant(e, k);
+    }
+  else
+    e = binary(AdditiveExpressionK, newIntConstantNode(k), MINUS,
+               balanced(neg, 0, nNeg, AdditiveExpressionK, PLUS));
+  free(pos);
+  free(neg);
+  return e;
+}
+
+static TreeNode *rebuildProduct(Chain *c)
+{
+  TreeNode **terms, *e;
+  int k = (int) c->constant, i;
+
+  if (k == 0)
+    return newIntConstantNode(0);
+  MALLOC(terms, c->n * sizeof(TreeNode *));
+  for (i = 0; i < c->n; ++i)
+    terms[i] = c->terms[i].t;
+  e = balanced(terms, 0, c->n, MultiplicativeExpressionK, TIMES);
+  if (k != 1)
+    e = binary(MultiplicativeExpressionK, e, TIMES, newIntConstantNode(k));
+  free(terms);
+  return e;
+}
+
+/* Rebuilds the chain rooted at t in place when that
+ * gains something: more than two terms to balance,
+ * constants to fold, or a constant operand to move
+ * last into the immediate field
+ */
+static void reassociateChain(TreeNode *t)
+{
+  Chain c;
+  TreeNode *e, *sibling = t->sibling, *last;
+  int sum = t->nodeKind == AdditiveExpressionK;
+
+  memset(&c, 0, sizeof(c));
+  c.constant = sum ? 0 : 1;
+  if (sum)
+    collectSum(&c, t, FALSE);
+  else
+    collectProduct(&c, t);
+  last = sum ? t->attr.addExpr.rexpr : t->attr.multExpr.rexpr;
+
+  if (c.n > 0 && (c.n > 2 || c.nConstants > 1
+                  || (c.nConstants == 1 && last->nodeKind != ConstantK)))
+    {
+      e = sum ? rebuildSum(&c) : rebuildProduct(&c);
+      *t = *e;
+      t->sibling = sibling;
+      rebuilt++;
+    }
+  free(c.terms);
+}
+
+static int isChain(TreeNode *t)
+{
+  return t->nodeKind == AdditiveExpressionK
+    || (t->nodeKind == MultiplicativeExpressionK && t->attr.multExpr.op->attr.TOK == TIMES);
+}
+
+static void walk(TreeNode *t)
+{
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **kids[3];
+      int i, n;
+
+      // the order of the terms changes, so only when
+      // evaluating them has no effect
+      if (isChain(t) && !hasSideEffect(t))
+        {
+          reassociateChain(t);
+          if (isChain(t))
+            continue;
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        walk(*kids[i]);
+    }
+}
+
+int reassociate(TreeNode *func)
+{
+  rebuilt = 0;
+  walk(func->attr.funcDecl.cmpd_stmt);
+  return rebuilt;
+}
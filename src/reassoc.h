@@ -0,0 +1,21 @@
+/****************************************************/
+/* File: reassoc.h                                  */
+/* Reassociation of + and * chains for the C-       */
+/* compiler                                         */
+/****************************************************/
+
+#ifndef _REASSOC_H_
+#define _REASSOC_H_
+
+/* Function reassociate flattens every chain of + and -
+ * (or of *) without side effects in a function into
+ * its terms, folds the constants among them into one
+ * constant placed last, and rebuilds the rest as a
+ * balanced tree, so that its depth is logarithmic
+ * instead of linear in the number of terms. Integer
+ * arithmetic wraps around, so any grouping gives the
+ * same value. Returns the number of chains rebuilt.
+ */
+int reassociate(TreeNode *func);
+
+#endif
@@ -0,0 +1,648 @@
+/****************************************************/
+/* File: regalloc.c                                 */
+/* Linear-scan register allocation for the C-       */
+/* code generator                                   */
+/****************************************************/
+
+#include "globals.h"
+#include "regalloc.h"
+
+#define BIT(r) (1u << (r))
+#define RANGE(lo, n) (((1u << (n)) - 1) << (lo))
+
+#define A_REGS RANGE(REG_A0, 4)
+#define T_REGS RANGE(REG_T0, 8)
+#define S_REGS RANGE(REG_S0, 8)
+#define ALLOC_REGS (A_REGS | T_REGS | S_REGS)
+/* what a call may overwrite */
+#define CALLER_SAVED (BIT(REG_V0) | BIT(REG_V1) | A_REGS | T_REGS | BIT(REG_T8) | BIT(REG_T9))
+
+typedef struct
+{
+  int start, end;   /* first and last position live, end < 0 if never */
+  int reg;          /* machine register, -1 if spilled */
+  int slot;         /* spill slot, -1 if none */
+  int saveAtCalls;  /* caller-saved register kept across calls */
+  int piece0, nPieces;  /* its pieces, when spilled */
+} Interval;
+
+/* A piece of a spilled interval within one basic block
+ * and between calls that keeps the value in a register;
+ * the spill slot stays its home, so the piece loads it
+ * at a first read and stores it at each definition
+ */
+typedef struct
+{
+  int start, end;
+  int reg;
+} Piece;
+
+static Lir lir;
+static int nv, words;
+static Interval *iv;
+static int nPieces, capPieces;
+static Piece *pieces;
+
+/* the virtual registers an instruction reads; returns
+ * how many (machine registers are included)
+ */
+static int usesOf(LirInstr *in, int regs[4])
+{
+  int n = 0;
+  switch (in->kind)
+    {
+    case LirCall:
+    case LirTailCall:
+      // the argument registers
+      while (n < in->imm)
+        regs[n] = REG_A0 + n, n++;
+      break;
+    case LirRRR:
+    case LirMulHi:
+    case LirStore:
+    case LirBranch:
+      regs[n++] = in->src[0];
+      if (in->src[1] >= 0)
+        regs[n++] = in->src[1];
+      break;
+    case LirCondMove:
+      regs[n++] = in->src[0];
+      regs[n++] = in->src[1];
+      regs[n++] = in->dst;
+      break;
+    case LirRRI:
+    case LirRR:
+    case LirLoad:
+      if (in->src[0] >= 0)
+        regs[n++] = in->src[0];
+      break;
+    case LirSyscall:
+      regs[n++] = REG_V0;
+      if (in->src[0] >= 0)
+        regs[n++] = in->src[0];
+      break;
+    default:
+      break;
+    }
+  return n;
+}
+
+static int defOf(LirInstr *in)
+{
+  switch (in->kind)
+    {
+    case LirRRR:
+    case LirMulHi:
+    case LirRRI:
+    case LirRI:
+    case LirRL:
+    case LirRR:
+    case LirCondMove:
+    case LirLoad:
+      return in->dst;
+    case LirSyscall:
+      return REG_V0;
+    default:
+      return -1;
+    }
+}
+
+static int endsBlock(LirInstr *in)
+{
+  return in->kind == LirBranch || in->kind == LirJump || in->kind == LirTailCall;
+}
+
+/* the position of a label of the list, -1 if it is
+ * somewhere else (another function or the runtime)
+ */
+static int findLabel(const char *label)
+{
+  int i;
+  for (i = 0; i < lir->n; ++i)
+    if (lir->code[i].kind == LirLabel && !strcmp(lir->code[i].label, label))
+      return i;
+  return -1;
+}
+
+static void extend(int v, int pos)
+{
+  Interval *it = &iv[v - VREG_BASE];
+  if (pos < it->start) it->start = pos;
+  if (pos > it->end) it->end = pos;
+}
+
+/* Computes the live interval of every virtual register
+ * from the liveness of the basic blocks, and for every
+ * position the machine registers it holds a value in
+ */
+static void liveIntervals(unsigned *fixedBusy)
+{
+  int n = lir->n, nb = 0, i, j, w, changed;
+  int *blockOf, *first, *last, (*succ)[2];
+  unsigned *use, *def, *in, *out;
+
+  MALLOC(blockOf, (n + 1) * sizeof(int));
+  MALLOC(first, (n + 1) * sizeof(int));
+  MALLOC(last, (n + 1) * sizeof(int));
+  MALLOC(succ, (n + 1) * sizeof(*succ));
+  for (i = 0; i < n; ++i)
+    {
+      if (i == 0 || lir->code[i].kind == LirLabel || endsBlock(&lir->code[i - 1]))
+        {
+          if (nb > 0)
+            last[nb - 1] = i - 1;
+          first[nb++] = i;
+        }
+      blockOf[i] = nb - 1;
+    }
+  if (nb > 0)
+    last[nb - 1] = n - 1;
+
+  for (j = 0; j < nb; ++j)
+    {
+      LirInstr *end = &lir->code[last[j]];
+      int target = end->kind == LirBranch || end->kind == LirJump ? findLabel(end->label) : -1;
+      succ[j][0] = succ[j][1] = -1;
+      if (target >= 0)
+        succ[j][0] = blockOf[target];
+      if (end->kind != LirJump && end->kind != LirTailCall && j + 1 < nb)
+        succ[j][1] = j + 1;
+    }
+
+  use = calloc((size_t) (nb + 1) * words, sizeof(unsigned));
+  def = calloc((size_t) (nb + 1) * words, sizeof(unsigned));
+  in = calloc((size_t) (nb + 1) * words, sizeof(unsigned));
+  out = calloc((size_t) (nb + 1) * words, sizeof(unsigned));
+  if (use == NULL || def == NULL || in == NULL || out == NULL)
+    DONT_OCCUR_PRINT;
+
+  for (j = 0; j < nb; ++j)
+    for (i = first[j]; i <= last[j]; ++i)
+      {
+        int regs[4], k, m = usesOf(&lir->code[i], regs), d = defOf(&lir->code[i]);
+        for (k = 0; k < m; ++k)
+          if (IS_VREG(regs[k]))
+            {
+              int v = regs[k] - VREG_BASE;
+              if (!(def[j * words + v / 32] & BIT(v % 32)))
+                use[j * words + v / 32] |= BIT(v % 32);
+            }
+        if (d >= 0 && IS_VREG(d))
+          def[j * words + (d - VREG_BASE) / 32] |= BIT((d - VREG_BASE) % 32);
+      }
+
+  do
+    {
+      changed = FALSE;
+      for (j = nb - 1; j >= 0; --j)
+        for (w = 0; w < words; ++w)
+          {
+            unsigned o = 0, x;
+            int k;
+            for (k = 0; k < 2; ++k)
+              if (succ[j][k] >= 0)
+                o |= in[succ[j][k] * words + w];
+            x = use[j * words + w] | (o & ~def[j * words + w]);
+            if (o != out[j * words + w] || x != in[j * words + w])
+              changed = TRUE;
+            out[j * words + w] = o;
+            in[j * words + w] = x;
+          }
+    }
+  while (changed);
+
+  for (i = 0; i < nv; ++i)
+    {
+      iv[i].start = n;
+      iv[i].end = -1;
+    }
+  for (j = 0; j < nb; ++j)
+    {
+      unsigned live = 0;
+
+      for (w = 0; w < words; ++w)
+        {
+          int b;
+          for (b = 0; b < 32; ++b)
+            {
+              if (in[j * words + w] & BIT(b))
+                extend(VREG_BASE + w * 32 + b, first[j]);
+              if (out[j * words + w] & BIT(b))
+                extend(VREG_BASE + w * 32 + b, last[j]);
+            }
+        }
+      // machine registers hold values only within a block
+      for (i = last[j]; i >= first[j]; --i)
+        {
+          int regs[4], k, m = usesOf(&lir->code[i], regs), d = defOf(&lir->code[i]);
+          fixedBusy[i] = live;
+          if (d >= 0)
+            {
+              if (IS_VREG(d))
+                extend(d, i);
+              else if (ALLOC_REGS & BIT(d))
+                {
+                  fixedBusy[i] |= BIT(d);
+                  live &= ~BIT(d);
+                }
+            }
+          for (k = 0; k < m; ++k)
+            if (IS_VREG(regs[k]))
+              extend(regs[k], i);
+            else if (ALLOC_REGS & BIT(regs[k]))
+              live |= BIT(regs[k]);
+          fixedBusy[i] |= live;
+        }
+    }
+
+  free(blockOf); free(first); free(last); free(succ);
+  free(use); free(def); free(in); free(out);
+}
+
+static int cmpStart(const void *a, const void *b)
+{
+  const Interval *x = &iv[*(const int *) a], *y = &iv[*(const int *) b];
+  if (x->start != y->start)
+    return x->start - y->start;
+  return *(const int *) a - *(const int *) b;
+}
+
+/* the lowest register in the first of the masks that has one */
+static int pick(unsigned m1, unsigned m2)
+{
+  unsigned m = m1 ? m1 : m2;
+  int r;
+  for (r = 0; r < 32; ++r)
+    if (m & BIT(r))
+      return r;
+  return -1;
+}
+
+static void scan(unsigned *fixedBusy, int *callsBefore, int *nSlots)
+{
+  int *order, *active, nOrder = 0, nActive = 0, i, k;
+
+  MALLOC(order, (nv + 1) * sizeof(int));
+  MALLOC(active, (nv + 1) * sizeof(int));
+  for (i = 0; i < nv; ++i)
+    {
+      iv[i].reg = iv[i].slot = -1;
+      iv[i].saveAtCalls = FALSE;
+      if (iv[i].end >= 0)
+        order[nOrder++] = i;
+    }
+  qsort(order, nOrder, sizeof(int), cmpStart);
+
+  for (i = 0; i < nOrder; ++i)
+    {
+      Interval *it = &iv[order[i]];
+      LirInstr *at = &lir->code[it->start];
+      int definedHere = defOf(at) == VREG_BASE + order[i] && at->kind != LirCondMove;
+      int crosses = callsBefore[it->end] - callsBefore[it->start + 1] > 0;
+      unsigned taken = 0, forbidden = 0, free, prefer;
+      int reg = -1, hint = -1, p;
+
+      // expire; a register read for the last time here can
+      // take the value defined here
+      for (k = 0; k < nActive; )
+        if (iv[active[k]].end < it->start)
+          active[k] = active[--nActive];
+        else
+          {
+            if (iv[active[k]].end > it->start || !definedHere)
+              taken |= BIT(iv[active[k]].reg);
+            k++;
+          }
+      // a move from or to a machine register can use that
+      // register when the value there is not needed besides
+      for (p = it->start; p <= it->end; ++p)
+        {
+          LirInstr *in = &lir->code[p];
+          unsigned busy = fixedBusy[p];
+          if (p == it->start && definedHere && in->kind == LirRR && !IS_VREG(in->src[0])
+              && (p + 1 >= lir->n || !(fixedBusy[p + 1] & BIT(in->src[0]))))
+            busy &= ~BIT(in->src[0]);
+          if (p == it->end && in->kind == LirRR && in->src[0] == VREG_BASE + order[i]
+              && !IS_VREG(in->dst))
+            busy &= ~BIT(in->dst);
+          forbidden |= busy;
+        }
+
+      free = ALLOC_REGS & ~taken & ~forbidden;
+      prefer = crosses ? S_REGS : (T_REGS | A_REGS);
+      if (definedHere && at->kind == LirRR)
+        hint = IS_VREG(at->src[0]) ? iv[at->src[0] - VREG_BASE].reg : at->src[0];
+      else if (lir->code[it->end].kind == LirRR
+               && lir->code[it->end].src[0] == VREG_BASE + order[i]
+               && !IS_VREG(lir->code[it->end].dst))
+        hint = lir->code[it->end].dst;
+      if (hint >= 0 && !(ALLOC_REGS & BIT(hint)))
+        hint = -1;
+      if (hint >= 0 && (free & prefer & BIT(hint)))
+        reg = hint;
+      else if (free & prefer)
+        reg = pick(free & prefer & T_REGS, free & prefer);
+      else if (hint >= 0 && (free & BIT(hint)))
+        reg = hint;
+      else
+        reg = pick(free & T_REGS, free);
+
+      if (reg < 0)
+        {
+          // spill whichever lives longest: this value or the
+          // active value whose register it can use
+          int victim = -1;
+          for (k = 0; k < nActive; ++k)
+            {
+              Interval *u = &iv[active[k]];
+              int q, shared = FALSE;
+              if ((forbidden & BIT(u->reg)) || u->end <= it->end
+                  || (victim >= 0 && u->end <= iv[active[victim]].end))
+                continue;
+              for (q = 0; q < nActive; ++q)
+                if (q != k && iv[active[q]].reg == u->reg
+                    && (iv[active[q]].end > it->start || !definedHere))
+                  shared = TRUE;
+              if (!shared)
+                victim = k;
+            }
+          if (victim >= 0)
+            {
+              Interval *u = &iv[active[victim]];
+              reg = u->reg;
+              u->reg = -1;
+              u->saveAtCalls = FALSE;
+              u->slot = (*nSlots)++;
+              active[victim] = active[--nActive];
+            }
+          else
+            {
+              it->slot = (*nSlots)++;
+              continue;
+            }
+        }
+
+      it->reg = reg;
+      if (crosses && (CALLER_SAVED & BIT(reg)))
+        {
+          it->saveAtCalls = TRUE;
+          it->slot = (*nSlots)++;
+        }
+      active[nActive++] = order[i];
+    }
+  free(order);
+  free(active);
+}
+
+/* how often an instruction reads or writes v */
+static int refsOf(LirInstr *in, int v)
+{
+  int regs[4], k, m = usesOf(in, regs), refs = defOf(in) == v;
+  for (k = 0; k < m; ++k)
+    refs += regs[k] == v;
+  return refs;
+}
+
+/* the registers a piece over [start, end] cannot take */
+static unsigned busyOver(int start, int end, unsigned *fixedBusy)
+{
+  unsigned busy = 0;
+  int p, k;
+
+  for (p = start; p <= end; ++p)
+    busy |= fixedBusy[p];
+  for (k = 0; k < nv; ++k)
+    if (iv[k].reg >= 0 && iv[k].start <= end && iv[k].end >= start)
+      busy |= BIT(iv[k].reg);
+  for (k = 0; k < nPieces; ++k)
+    if (pieces[k].start <= end && pieces[k].end >= start)
+      busy |= BIT(pieces[k].reg);
+  return busy;
+}
+
+/* Splits the reads and writes of spilled interval v at
+ * pos[0..n-1] (refs[i] at pos[i]) into runs that find a
+ * register free over all of them, each a piece if it
+ * saves a load
+ */
+static void placePieces(int v, int *pos, int *refs, int n, unsigned *fixedBusy)
+{
+  int i = 0, j, count;
+  unsigned avail;
+
+  while (i < n)
+    {
+      // caller-saved registers only: a piece holds no call
+      avail = (T_REGS | A_REGS) & ~busyOver(pos[i], pos[i], fixedBusy);
+      count = refs[i];
+      for (j = i + 1; j < n; ++j)
+        {
+          unsigned f = avail & ~busyOver(pos[i], pos[j], fixedBusy);
+          if (f == 0)
+            break;
+          avail = f;
+          count += refs[j];
+        }
+      if (count > 1 && avail != 0)
+        {
+          GROW(pieces, nPieces, capPieces);
+          pieces[nPieces].start = pos[i];
+          pieces[nPieces].end = pos[j - 1];
+          pieces[nPieces].reg = pick(avail & T_REGS, avail);
+          if (iv[v].nPieces++ == 0)
+            iv[v].piece0 = nPieces;
+          nPieces++;
+        }
+      i = j;
+    }
+}
+
+/* Splits each spilled interval at the labels, block
+ * ends and calls within it, and between those at its
+ * reads and writes, into pieces that keep the value in
+ * a register where one is free
+ */
+static void splitSpilled(unsigned *fixedBusy)
+{
+  int v, p, n, r, *pos, *refs;
+
+  nPieces = 0;
+  MALLOC(pos, (lir->n + 1) * sizeof(int));
+  MALLOC(refs, (lir->n + 1) * sizeof(int));
+  for (v = 0; v < nv; ++v)
+    {
+      Interval *it = &iv[v];
+
+      it->nPieces = 0;
+      if (it->reg >= 0 || it->slot < 0)
+        continue;
+      n = 0;
+      for (p = it->start; p <= it->end + 1; ++p)
+        {
+          LirInstr *in = p <= it->end ? &lir->code[p] : NULL;
+          if (in == NULL || in->kind == LirLabel || in->kind == LirCall)
+            {
+              placePieces(v, pos, refs, n, fixedBusy);
+              n = 0;
+              continue;
+            }
+          if ((r = refsOf(in, VREG_BASE + v)) > 0)
+            {
+              pos[n] = p;
+              refs[n++] = r;
+            }
+          if (endsBlock(in))
+            {
+              placePieces(v, pos, refs, n, fixedBusy);
+              n = 0;
+            }
+        }
+    }
+  free(pos);
+  free(refs);
+}
+
+/* the piece of spilled interval it around position pos, or NULL */
+static Piece *pieceAt(Interval *it, int pos)
+{
+  int k;
+  for (k = it->piece0; k < it->piece0 + it->nPieces; ++k)
+    if (pieces[k].start <= pos && pos <= pieces[k].end)
+      return &pieces[k];
+  return NULL;
+}
+
+/* a load or store of a spill slot; the code generator
+ * places the spill area in the frame
+ */
+static void loadSlot(int reg, int slot)
+{
+  lirEmit(lir, LirLoad, "lw", reg, REG_FP, -1, -(slot + 1) * (int) sizeof(int), NULL)->area = FrameSpill;
+}
+
+static void storeSlot(int reg, int slot)
+{
+  lirEmit(lir, LirStore, "sw", -1, reg, REG_FP, -(slot + 1) * (int) sizeof(int), NULL)->area = FrameSpill;
+}
+
+/* Replaces the virtual registers by the machine
+ * registers, with loads and stores for the spilled
+ * ones and saves around calls
+ */
+static void rewrite(void)
+{
+  LirInstr *old = lir->code;
+  int n = lir->n, i, k;
+
+  lir->code = NULL;
+  lir->n = lir->cap = 0;
+  lir->usedRegs = 0;
+  for (k = 0; k < nPieces; ++k)
+    lir->usedRegs |= BIT(pieces[k].reg);
+  for (i = 0; i < n; ++i)
+    {
+      LirInstr in = old[i];
+      int d = defOf(&in), spilledDst = -1, scratchDst = REG_T8;
+      int regs[4], m = usesOf(&in, regs);
+      Piece *pc;
+
+      if (in.kind == LirCall)
+        for (k = 0; k < nv; ++k)
+          if (iv[k].saveAtCalls && iv[k].start < i && i < iv[k].end)
+            storeSlot(iv[k].reg, iv[k].slot);
+
+      // a piece that starts with a read loads the value once
+      for (k = 0; k < m; ++k)
+        if (IS_VREG(regs[k]) && (k == 0 || regs[k] != regs[k - 1])
+            && (pc = pieceAt(&iv[regs[k] - VREG_BASE], i)) != NULL && pc->start == i)
+          loadSlot(pc->reg, iv[regs[k] - VREG_BASE].slot);
+
+      for (k = 0; k < 2; ++k)
+        if (in.kind != LirSyscall && in.src[k] >= 0 && IS_VREG(in.src[k]))
+          {
+            Interval *it = &iv[in.src[k] - VREG_BASE];
+            if (it->reg >= 0)
+              in.src[k] = it->reg;
+            else if ((pc = pieceAt(it, i)) != NULL)
+              in.src[k] = pc->reg;
+            else
+              {
+                int scratch = k == 0 ? REG_T8 : REG_T9;
+                loadSlot(scratch, it->slot);
+                in.src[k] = scratch;
+              }
+          }
+      if (d >= 0 && IS_VREG(d))
+        {
+          Interval *it = &iv[d - VREG_BASE];
+          if (it->reg >= 0)
+            in.dst = it->reg;
+          else if ((pc = pieceAt(it, i)) != NULL)
+            {
+              in.dst = scratchDst = pc->reg;
+              spilledDst = it->slot;
+            }
+          else
+            {
+              // a conditional move reads its destination too,
+              // and $t8 and $t9 may hold its sources
+              if (in.kind == LirCondMove)
+                {
+                  scratchDst = REG_V1;
+                  loadSlot(scratchDst, it->slot);
+                }
+              in.dst = scratchDst;
+              spilledDst = it->slot;
+            }
+        }
+      if (d >= 0)
+        lir->usedRegs |= BIT(IS_VREG(d) ? in.dst : d);
+
+      // a move within one register goes, but a spilled
+      // destination is still stored
+      if (in.kind == LirRR && in.dst == in.src[0])
+        free(in.label);
+      else
+        {
+          GROW(lir->code, lir->n, lir->cap);
+          lir->code[lir->n++] = in;
+        }
+
+      if (spilledDst >= 0)
+        storeSlot(scratchDst, spilledDst);
+      if (in.kind == LirCall)
+        for (k = 0; k < nv; ++k)
+          if (iv[k].saveAtCalls && iv[k].start < i && i < iv[k].end)
+            loadSlot(iv[k].reg, iv[k].slot);
+    }
+  free(old);
+}
+
+void allocateRegisters(Lir list)
+{
+  unsigned *fixedBusy;
+  int *callsBefore, i, nSlots = 0;
+
+  lir = list;
+  nv = lir->nRegs - VREG_BASE;
+  words = nv / 32 + 1;
+  MALLOC(iv, (nv + 1) * sizeof(Interval));
+  MALLOC(fixedBusy, (lir->n + 1) * sizeof(unsigned));
+  MALLOC(callsBefore, (lir->n + 2) * sizeof(int));
+
+  liveIntervals(fixedBusy);
+  callsBefore[0] = 0;
+  for (i = 0; i <= lir->n; ++i)
+    callsBefore[i + 1] = callsBefore[i] + (i < lir->n && lir->code[i].kind == LirCall);
+  scan(fixedBusy, callsBefore, &nSlots);
+  splitSpilled(fixedBusy);
+  rewrite();
+  lir->spillBytes = nSlots * sizeof(int);
+
+  free(iv);
+  free(pieces);
+  pieces = NULL;
+  capPieces = 0;
+  free(fixedBusy);
+  free(callsBefore);
+}
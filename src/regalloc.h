@@ -0,0 +1,33 @@
+/****************************************************/
+/* File: regalloc.h                                 */
+/* Linear-scan register allocation for the C-       */
+/* code generator                                   */
+/****************************************************/
+
+#ifndef _REGALLOC_H_
+#define _REGALLOC_H_
+
+#include "lir.h"
+
+/* Procedure allocateRegisters maps the virtual
+ * registers of a function body onto $t0-$t7, $a0-$a3
+ * and $s0-$s7 by linear scan over live intervals.
+ * Values live across a call go to the callee-saved
+ * $s registers; when those run out they keep a $t or
+ * $a register that is stored before each call crossed
+ * and reloaded after it. Values that find no register
+ * at all live in spill slots (FrameSpill offsets) and
+ * go through $t8/$t9 at each use. A spilled interval
+ * is split at labels, block ends and calls, and between
+ * those at its uses, into pieces; a piece with several
+ * uses that finds a $t or $a register free keeps the
+ * value there, loading it at the first read and storing
+ * it at each definition.
+ * A move from or to a machine register ($a0-$a3 for
+ * arguments) takes that register where it is free,
+ * so the move goes away.
+ * Sets spillBytes and usedRegs of the list.
+ */
+void allocateRegisters(Lir lir);
+
+#endif
@@ -0,0 +1,222 @@
+/****************************************************/
+/* File: tailrec.c                                  */
+/* Tail-recursion elimination for the C- compiler   */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "tailrec.h"
+
+/* state of one run of the pass */
+static TreeNode *self;      /* FunctionDeclarationK */
+static SymbolInfo *flag;    /* _tail, NULL when the loop never exits by itself */
+static int removed;
+
+static int isSelfCall(TreeNode *t)
+{
+  return t != NULL && t->nodeKind == CallK
+    && t->attr.call._var->symbolInfo == self->attr.funcDecl._var->symbolInfo;
+}
+
+/* TRUE if the expression reads the symbol */
+static int readsSymbol(TreeNode *t, SymbolInfo *symbolInfo)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == VariableK && t->symbolInfo == symbolInfo)
+        return TRUE;
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        if (readsSymbol(*kids[i], symbolInfo))
+          return TRUE;
+    }
+  return FALSE;
+}
+
+/* The arguments must match the parameters one to one,
+ * and an array passed back in must outlive the body it
+ * was passed from: a global array or an array
+ * parameter, never a local array of the body
+ */
+static int loopSafeArgs(TreeNode *call)
+{
+  TreeNode *arg, *param = self->attr.funcDecl.params;
+  for (arg = call->attr.call.expr_list; arg != NULL; arg = arg->sibling, param = param->sibling)
+    if (param == NULL
+        || (arg->nodeType == IntArrayT
+            && !arg->symbolInfo->attr.arrInfo.isParam
+            && !arg->symbolInfo->attr.arrInfo.globalFlag))
+      return FALSE;
+  return param == NULL;
+}
+
+static TreeNode *assignStmt(char *name, SymbolInfo *symbolInfo, TreeNode *expr)
+{
+  TreeNode *assign = newAssignExpressionNode(newSymbolUseNode(name, symbolInfo), expr);
+  TreeNode *stmt = newExpressionStatementNode(assign);
+  assign->nodeType = symbolInfo->nodeType;
+  stmt->nodeType = NoneT;
+  return stmt;
+}
+
+/* Builds the block that replaces a tail call: the
+ * arguments become the new parameter values and the
+ * body starts over. A parameter still read by a later
+ * argument gets its new value through a temporary.
+ */
+static TreeNode *restartBlock(TreeNode *call)
+{
+  TreeNode *param, *arg, *next, *cmpd;
+  TreeNode *decls = NULL, *stmts = NULL, *late = NULL;
+  int sideEffects = FALSE;
+
+  for (arg = call->attr.call.expr_list; arg != NULL; arg = arg->sibling)
+    sideEffects |= hasSideEffect(arg);
+
+  for (param = self->attr.funcDecl.params, arg = call->attr.call.expr_list;
+       arg != NULL;
+       param = param->sibling, arg = next)
+    {
+      TreeNode *_var = param->attr.varParam._var;
+      next = arg->sibling;
+      arg->sibling = NULL;
+
+      // passed through unchanged
+      if (arg->nodeKind == VariableK && arg->symbolInfo == _var->symbolInfo)
+        continue;
+
+      if (sideEffects || readsSymbol(next, _var->symbolInfo))
+        {
+          TreeNode *decl = newScalarDeclarationNode("_arg");
+          SymbolInfo *tmp = decl->attr.varDecl._var->symbolInfo;
+          if (param->nodeKind == ArrayParameterK)
+            {
+              // a pointer slot, read like an array parameter
+              tmp->nodeType = decl->attr.varDecl._var->nodeType = IntArrayT;
+              tmp->attr.arrInfo.isParam = TRUE;
+            }
+          decls = addSibling(decls, decl);
+          stmts = addSibling(stmts, assignStmt("_arg", tmp, arg));
+          late = addSibling(late, assignStmt(_var->attr.ID, _var->symbolInfo,
+                                             newSymbolUseNode("_arg", tmp)));
+        }
+      else
+        stmts = addSibling(stmts, assignStmt(_var->attr.ID, _var->symbolInfo, arg));
+    }
+  stmts = addSibling(stmts, late);
+  if (flag != NULL)
+    stmts = addSibling(stmts, assignStmt("_tail", flag, newIntConstantNode(1)));
+
+  cmpd = newCompoundStatementNode(decls, stmts);
+  cmpd->nodeType = NoneT;
+  return cmpd;
+}
+
+static int isBareReturn(TreeNode *t)
+{
+  return t != NULL && t->nodeKind == ReturnStatementK && t->attr.retStmt.expr == NULL;
+}
+
+/* Replaces the self calls in tail position of the
+ * statement list at *link
+ */
+static void rewriteTailCalls(TreeNode **link, int tail)
+{
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link, *call = NULL, *rest = t->sibling;
+      int last = tail && t->sibling == NULL;
+
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          rewriteTailCalls(&t->attr.cmpdStmt.stmt_list, last);
+          break;
+        case SelectionStatementK:
+          rewriteTailCalls(&t->attr.selectStmt.if_stmt, last);
+          rewriteTailCalls(&t->attr.selectStmt.else_stmt, last);
+          break;
+        case ReturnStatementK:
+          // return f(...);
+          if (last)
+            call = t->attr.retStmt.expr;
+          break;
+        case ExpressionStatementK:
+          // f(...); or f(...); return; in a void function
+          if (last)
+            call = t->attr.exprStmt.expr;
+          else if (tail && isBareReturn(t->sibling) && t->sibling->sibling == NULL)
+            {
+              call = t->attr.exprStmt.expr;
+              rest = NULL;
+            }
+          break;
+        default:
+          break;
+        }
+
+      if (isSelfCall(call) && loopSafeArgs(call))
+        {
+          *link = restartBlock(call);
+          (*link)->sibling = rest;
+          removed++;
+        }
+    }
+}
+
+/* Function eliminateTailRecursion turns the calls a
+ * function makes to itself in tail position into
+ * jumps back to the top of its body
+ */
+int eliminateTailRecursion(TreeNode *func)
+{
+  TreeNode *body = func->attr.funcDecl.cmpd_stmt, *flagDecl = NULL;
+  TreeNode *inner, *loop;
+
+  self = func;
+  removed = 0;
+
+  sinkRest(body->attr.cmpdStmt.stmt_list);
+  // a body that may fall off its end needs a flag to leave the loop
+  if (!alwaysReturns(body->attr.cmpdStmt.stmt_list))
+    {
+      flagDecl = newScalarDeclarationNode("_tail");
+      flag = flagDecl->attr.varDecl._var->symbolInfo;
+    }
+  else
+    flag = NULL;
+
+  rewriteTailCalls(&body->attr.cmpdStmt.stmt_list, TRUE);
+  if (removed == 0)
+    return 0;
+
+  inner = newCompoundStatementNode(body->attr.cmpdStmt.local_decl, body->attr.cmpdStmt.stmt_list);
+  inner->nodeType = NoneT;
+  if (flag != NULL)
+    {
+      //   _tail = 1; while (_tail) { _tail = 0; body }
+      TreeNode *again = newCompoundStatementNode(NULL,
+          addSibling(assignStmt("_tail", flag, newIntConstantNode(0)), inner));
+      again->nodeType = NoneT;
+      loop = newIterationStatementNode(newSymbolUseNode("_tail", flag), again);
+      loop->nodeType = NoneT;
+      body->attr.cmpdStmt.local_decl = flagDecl;
+      body->attr.cmpdStmt.stmt_list =
+        addSibling(assignStmt("_tail", flag, newIntConstantNode(1)), loop);
+    }
+  else
+    {
+      //   while (1) body
+      loop = newIterationStatementNode(newIntConstantNode(1), inner);
+      loop->nodeType = NoneT;
+      body->attr.cmpdStmt.local_decl = NULL;
+      body->attr.cmpdStmt.stmt_list = loop;
+    }
+
+  self = NULL;
+  flag = NULL;
+  return removed;
+}
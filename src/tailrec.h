@@ -0,0 +1,17 @@
+/****************************************************/
+/* File: tailrec.h                                  */
+/* Tail-recursion elimination for the C- compiler   */
+/****************************************************/
+
+#ifndef _TAILREC_H_
+#define _TAILREC_H_
+
+/* Function eliminateTailRecursion turns the calls a
+ * function makes to itself in tail position into
+ * jumps back to the top of its body, by assigning the
+ * arguments to the parameters inside a loop around
+ * the body. Returns the number of calls removed.
+ */
+int eliminateTailRecursion(TreeNode *func);
+
+#endif
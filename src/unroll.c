@@ -0,0 +1,438 @@
+/****************************************************/
+/* File: unroll.c                                   */
+/* Loop unrolling for the C- compiler               */
+/****************************************************/
+
+#include <limits.h>
+#include "globals.h"
+#include "util.h"
+#include "unroll.h"
+
+/* largest body, in tree nodes, unrolled by UnrollFactor */
+#define UNROLL_MAX_BODY 48
+
+/* a constant trip count up to this is unrolled fully
+ * when all the copies together stay within the size
+ */
+#define FULL_UNROLL_MAX_TRIPS 16
+#define FULL_UNROLL_MAX_SIZE 96
+
+/* most variables one group of steps may advance */
+#define MAX_STEPPED 8
+
+/* A counted loop
+ *   while (iv REL bound) { ...; v = v + step; ... }
+ * whose body ends in the steps of iv and of the
+ * pointers strength reduction steps along with it
+ */
+typedef struct
+{
+  TreeNode *loop;
+  TreeNode *ivUse;          /* the read of iv in the test */
+  TreeNode **ivSide;
+  TreeNode *bound;
+  int nStepped;
+  TreeNode *stepped[MAX_STEPPED];   /* a use of each */
+  int steps[MAX_STEPPED];
+  TreeNode *tail;           /* first of the steps ending the body, or NULL */
+} CountedLoop;
+
+static int unrolled;
+static int fullOnly;      /* only loops with a small constant trip count */
+
+static int countAssigns(TreeNode *t, SymbolInfo *var)
+{
+  TreeNode **kids[3];
+  int i, n, count = 0;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == AssignExpressionK && t->attr.assignStmt._var->nodeKind == VariableK
+          && t->attr.assignStmt._var->symbolInfo == var)
+        count++;
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        count += countAssigns(*kids[i], var);
+    }
+  return count;
+}
+
+static int hasNode(TreeNode *t, NodeKind kind)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == kind)
+        return TRUE;
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        if (hasNode(*kids[i], kind))
+          return TRUE;
+    }
+  return FALSE;
+}
+
+/* TRUE if var can be stepped in copies: a local scalar,
+ * or a local pointer stepped by whole elements
+ */
+static int steppable(SymbolInfo *var, int step)
+{
+  if (var->attr.intInfo.globalFlag)
+    return FALSE;
+  if (var->nodeType == IntArrayT)
+    return var->attr.arrInfo.isParam && step % (int) sizeof(int) == 0;
+  return var->nodeType == IntT;
+}
+
+/* Finds the steps ending the body; each steps a
+ * variable the loop assigns nowhere else
+ */
+static void findTail(TreeNode *body, CountedLoop *c)
+{
+  TreeNode *stmt;
+
+  c->tail = NULL;
+  c->nStepped = 0;
+  for (stmt = body->attr.cmpdStmt.stmt_list; stmt != NULL; stmt = stmt->sibling)
+    {
+      TreeNode *assign = stmt->nodeKind == ExpressionStatementK ? stmt->attr.exprStmt.expr : NULL;
+      int step;
+
+      if (assign != NULL && assign->nodeKind == AssignExpressionK
+          && assign->attr.assignStmt._var->nodeKind == VariableK
+          && constantStep(stmt, assign->attr.assignStmt._var->symbolInfo, &step)
+          && steppable(assign->attr.assignStmt._var->symbolInfo, step)
+          && countAssigns(body, assign->attr.assignStmt._var->symbolInfo) == 1
+          && c->nStepped < MAX_STEPPED)
+        {
+          if (c->tail == NULL)
+            c->tail = stmt;
+          c->stepped[c->nStepped] = assign->attr.assignStmt._var;
+          c->steps[c->nStepped++] = step;
+        }
+      else
+        {
+          c->tail = NULL;
+          c->nStepped = 0;
+        }
+    }
+}
+
+/* Step of var in the tail, or 0 if it has none */
+static int tailStep(CountedLoop *c, SymbolInfo *var)
+{
+  int i;
+  for (i = 0; i < c->nStepped; ++i)
+    if (c->stepped[i]->symbolInfo == var)
+      return c->steps[i];
+  return 0;
+}
+
+/* TRUE if the loop is counted by a variable that its
+ * body steps once per iteration, in the steps ending
+ * it, towards a bound the loop never changes
+ */
+static int countedLoop(TreeNode *loop, CountedLoop *c)
+{
+  TreeNode *test = loop->attr.iterStmt.expr, *body = loop->attr.iterStmt.loop_stmt;
+  int op, up, step;
+
+  if (test->nodeKind != ComparisonExpressionK || body == NULL
+      || body->nodeKind != CompoundStatementK || hasNode(body, IterationStatementK))
+    return FALSE;
+  op = test->attr.cmpExpr.op->attr.TOK;
+  if (op == EQ || op == NE)
+    return FALSE;
+
+  c->loop = loop;
+  c->ivSide = &test->attr.cmpExpr.lexpr;
+  c->bound = test->attr.cmpExpr.rexpr;
+  up = op == LT || op == LE;
+  if ((*c->ivSide)->nodeKind != VariableK
+      || countAssigns(body, (*c->ivSide)->symbolInfo) == 0)
+    {
+      // bound < iv counts up like iv > bound counts down
+      c->ivSide = &test->attr.cmpExpr.rexpr;
+      c->bound = test->attr.cmpExpr.lexpr;
+      up = !up;
+    }
+  c->ivUse = *c->ivSide;
+  if (c->ivUse->nodeKind != VariableK)
+    return FALSE;
+
+  if (c->bound->nodeKind == VariableK)
+    {
+      SymbolInfo *b = c->bound->symbolInfo;
+      if (b->nodeType != IntT || countAssigns(body, b) > 0
+          || (b->attr.intInfo.globalFlag && hasNode(body, CallK)))
+        return FALSE;
+    }
+  else if (c->bound->nodeKind != ConstantK)
+    return FALSE;
+
+  findTail(body, c);
+  step = tailStep(c, c->ivUse->symbolInfo);
+  return step != 0 && (step > 0) == up;
+}
+
+static TreeNode *plus(TreeNode *l, int k)
+{
+  TreeNode *t = newAdditiveExpressionNode(l, newTokenTypeNode(PLUS), newIntConstantNode(k));
+  t->nodeType = IntT;
+  return t;
+}
+
+/* Replaces the reads of the stepped variables in a
+ * list by their values k steps on (full: iv by the
+ * constant k). An element of a pointer moves along
+ * by its index instead.
+ */
+static void substitute(TreeNode **link, CountedLoop *c, int k, int full)
+{
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link, **kids[3];
+      int i, n, step;
+
+      if (t->nodeKind == ArrayK && !full
+          && (step = tailStep(c, t->attr.arr._var->symbolInfo)) != 0)
+        {
+          TreeNode *index;
+          substitute(&t->attr.arr.arr_expr, c, k, full);
+          index = t->attr.arr.arr_expr;
+          if (index->nodeKind == ConstantK)
+            index->attr.NUM += k * step / (int) sizeof(int);
+          else
+            t->attr.arr.arr_expr = plus(index, k * step / (int) sizeof(int));
+          continue;
+        }
+      if (t->nodeKind == VariableK && (step = tailStep(c, t->symbolInfo)) != 0
+          && (!full || t->symbolInfo == c->ivUse->symbolInfo))
+        {
+          TreeNode *repl = full ? newIntConstantNode(k)
+            : plus(newSymbolUseNode(t->attr.ID, t->symbolInfo), k * step);
+          repl->sibling = t->sibling;
+          *link = repl;
+          continue;
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        substitute(kids[i], c, k, full);
+    }
+}
+
+/* A copy of the body, without its steps, for the
+ * iteration k steps on (full: iv is just k)
+ */
+static TreeNode *bodyCopy(TreeNode *body, CountedLoop *c, int k, int full)
+{
+  SymbolMap map = { 0, 0, NULL, NULL };
+  TreeNode *copy = cloneTree(body, &map);
+  free(map.from);
+  free(map.to);
+  if (full || k != 0)
+    substitute(&copy->attr.cmpdStmt.stmt_list, c, k, full);
+  return copy;
+}
+
+static int compare(int op, int l, int r)
+{
+  switch (op)
+    {
+    case LT: return l < r;
+    case LE: return l <= r;
+    case GT: return l > r;
+    case GE: return l >= r;
+    default: return FALSE;
+    }
+}
+
+/* Trip count of a loop whose iv starts at a known
+ * constant and whose bound is constant, or -1
+ */
+static int tripCount(CountedLoop *c, int start, int *last)
+{
+  TreeNode *test = c->loop->attr.iterStmt.expr;
+  int op = test->attr.cmpExpr.op->attr.TOK, v = start, trips = 0;
+  int step = tailStep(c, c->ivUse->symbolInfo);
+
+  while (trips <= FULL_UNROLL_MAX_TRIPS)
+    {
+      int go = c->ivSide == &test->attr.cmpExpr.lexpr
+        ? compare(op, v, c->bound->attr.NUM) : compare(op, c->bound->attr.NUM, v);
+      if (!go)
+        {
+          *last = v;
+          return trips;
+        }
+      v += step;
+      trips++;
+    }
+  return -1;
+}
+
+/* TRUE if bound - reach does not overflow */
+static int boundFits(int bound, int reach)
+{
+  return reach > 0 ? bound >= INT_MIN + reach : bound <= INT_MAX + reach;
+}
+
+static TreeNode *stepStmt(TreeNode *use, TreeNode *value)
+{
+  TreeNode *assign = newAssignExpressionNode(newSymbolUseNode(use->attr.ID, use->symbolInfo), value);
+  TreeNode *stmt = newExpressionStatementNode(assign);
+  assign->nodeType = IntT;
+  stmt->nodeType = NoneT;
+  return stmt;
+}
+
+/* Takes the steps off the end of the body */
+static void cutTail(TreeNode *body, CountedLoop *c)
+{
+  TreeNode **link = &body->attr.cmpdStmt.stmt_list;
+  while (*link != c->tail)
+    link = &(*link)->sibling;
+  *link = NULL;
+}
+
+/* Unrolls the loop at *link; head starts its list.
+ * Returns the link to the last statement put there.
+ */
+static TreeNode **unrollLoop(TreeNode *head, TreeNode **link)
+{
+  TreeNode *loop = *link, *body = loop->attr.iterStmt.loop_stmt;
+  TreeNode *start, *copies = NULL, *cmpd, *rest, *test, **boundSide;
+  SymbolMap map = { 0, 0, NULL, NULL };
+  CountedLoop c;
+  int size, trips = -1, last = 0, k, i, reach;
+
+  if (!countedLoop(loop, &c))
+    return link;
+  size = countTreeNodes(body);
+
+  if (fullOnly)
+    {
+      //   copies with iv a constant in each; iv = its final value
+      start = constantOnEntry(head, loop, c.ivUse->symbolInfo);
+      if (start != NULL && c.bound->nodeKind == ConstantK && c.nStepped == 1
+          && c.ivUse->symbolInfo->nodeType == IntT)
+        trips = tripCount(&c, start->attr.NUM, &last);
+      if (trips <= 0 || trips * size > FULL_UNROLL_MAX_SIZE)
+        return link;
+
+      cutTail(body, &c);
+      for (k = 0; k < trips; ++k)
+        copies = addSibling(copies, bodyCopy(body, &c, start->attr.NUM + k * c.steps[0], TRUE));
+      copies = addSibling(copies, stepStmt(c.ivUse, newIntConstantNode(last)));
+      replaceStmt(link, copies);
+      while ((*link)->sibling != loop->sibling)
+        link = &(*link)->sibling;
+      unrolled++;
+      return link;
+    }
+
+  if (UnrollFactor <= 1 || size > UNROLL_MAX_BODY)
+    return link;
+  // iv + reach would overflow next to the end of the range
+  // (and a pointer next to the top of the address space),
+  // so the bound moves back instead; an int bound is
+  // checked to be far enough from the other end
+  reach = (UnrollFactor - 1) * tailStep(&c, c.ivUse->symbolInfo);
+  if (c.ivUse->symbolInfo->nodeType == IntT && c.bound->nodeKind == ConstantK
+      && !boundFits(c.bound->attr.NUM, reach))
+    return link;
+
+  //   if (bound - reach does not overflow)   (a variable int bound)
+  //     while (iv REL bound - reach) { U copies; steps }
+  //   while (iv REL bound) body
+  rest = cloneTree(loop, &map);
+  free(map.from);
+  free(map.to);
+
+  cutTail(body, &c);
+  for (k = 0; k < UnrollFactor; ++k)
+    copies = addSibling(copies, bodyCopy(body, &c, k, FALSE));
+  for (i = 0; i < c.nStepped; ++i)
+    copies = addSibling(copies, stepStmt(c.stepped[i],
+        plus(newSymbolUseNode(c.stepped[i]->attr.ID, c.stepped[i]->symbolInfo),
+             UnrollFactor * c.steps[i])));
+
+  cmpd = newCompoundStatementNode(NULL, copies);
+  cmpd->nodeType = NoneT;
+  loop->attr.iterStmt.loop_stmt = cmpd;
+  test = loop->attr.iterStmt.expr;
+  boundSide = c.ivSide == &test->attr.cmpExpr.lexpr
+    ? &test->attr.cmpExpr.rexpr : &test->attr.cmpExpr.lexpr;
+  *boundSide = plus(c.bound, -reach);
+  rest->sibling = loop->sibling;
+  if (c.ivUse->symbolInfo->nodeType == IntT && c.bound->nodeKind == VariableK)
+    {
+      TreeNode *fits = newComparisonExpressionNode(
+          newSymbolUseNode(c.bound->attr.ID, c.bound->symbolInfo),
+          newTokenTypeNode(reach > 0 ? GE : LE),
+          newIntConstantNode(reach > 0 ? INT_MIN + reach : INT_MAX + reach));
+      TreeNode *guard = newSelectionStatementNode(fits, loop, NULL);
+      fits->nodeType = IntT;
+      guard->nodeType = NoneT;
+      loop->sibling = NULL;
+      guard->sibling = rest;
+      *link = guard;
+      unrolled++;
+      return &guard->sibling;
+    }
+  loop->sibling = rest;
+  unrolled++;
+  return &loop->sibling;
+}
+
+static void walkStmts(TreeNode **link)
+{
+  TreeNode *head = *link;
+
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          walkStmts(&t->attr.cmpdStmt.stmt_list);
+          break;
+        case SelectionStatementK:
+          walkStmts(&t->attr.selectStmt.if_stmt);
+          walkStmts(&t->attr.selectStmt.else_stmt);
+          break;
+        case IterationStatementK:
+          walkStmts(&t->attr.iterStmt.loop_stmt);
+          // the remainder loop left behind is not unrolled again
+          link = unrollLoop(head, link);
+          break;
+        default:
+          break;
+        }
+    }
+}
+
+/* Function unrollConstantLoops replaces the loops with
+ * a small constant trip count by copies of their body
+ */
+int unrollConstantLoops(TreeNode *func)
+{
+  unrolled = 0;
+  fullOnly = TRUE;
+  if (UnrollFactor > 1)
+    walkStmts(&func->attr.funcDecl.cmpd_stmt);
+  return unrolled;
+}
+
+/* Function unrollLoops unrolls the small counted loops
+ * of a function by UnrollFactor
+ */
+int unrollLoops(TreeNode *func)
+{
+  unrolled = 0;
+  fullOnly = FALSE;
+  walkStmts(&func->attr.funcDecl.cmpd_stmt);
+  return unrolled;
+}
@@ -0,0 +1,25 @@
+/****************************************************/
+/* File: unroll.h                                   */
+/* Loop unrolling for the C- compiler               */
+/****************************************************/
+
+#ifndef _UNROLL_H_
+#define _UNROLL_H_
+
+/* Function unrollConstantLoops replaces each small
+ * innermost loop with a constant trip count by that
+ * many copies of its body, the counter a constant in
+ * each. Returns the number of loops replaced.
+ */
+int unrollConstantLoops(TreeNode *func);
+
+/* Function unrollLoops unrolls the small innermost
+ * counted while loops of a function by UnrollFactor,
+ * leaving the original loop behind to run the
+ * remaining iterations. The counter may be a pointer
+ * left by strength reduction. Returns the number of
+ * loops unrolled.
+ */
+int unrollLoops(TreeNode *func);
+
+#endif
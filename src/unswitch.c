@@ -0,0 +1,236 @@
+/****************************************************/
+/* File: unswitch.c                                 */
+/* Loop unswitching for the C- compiler             */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "callgraph.h"
+#include "unswitch.h"
+
+/* largest loop, in tree nodes, copied by unswitching */
+#define UNSWITCH_MAX_SIZE 120
+
+/* tree nodes unswitching may add to one function */
+#define UNSWITCH_BUDGET 300
+
+static CallGraph cg;
+static int budget;
+static int unswitched;
+
+/* TRUE if a call in t may assign the global scalar */
+static int callsMayModify(TreeNode *t, SymbolInfo *global)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == CallK)
+        {
+          CgNode callee = cgLookup(cg, t->attr.call._var->symbolInfo);
+          if (callee != NULL && cgMayModify(callee, global))
+            return TRUE;
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        if (callsMayModify(*kids[i], global))
+          return TRUE;
+    }
+  return FALSE;
+}
+
+/* TRUE if the condition has the same value all through
+ * the loop and evaluating it early cannot fault
+ */
+static int invariantCond(TreeNode *e, TreeNode *loop)
+{
+  switch (e->nodeKind)
+    {
+    case ConstantK:
+      return TRUE;
+    case VariableK:
+      if (e->symbolInfo->nodeType != IntT || assignsSymbol(loop, e->symbolInfo))
+        return FALSE;
+      return !e->symbolInfo->attr.intInfo.globalFlag || !callsMayModify(loop, e->symbolInfo);
+    case ComparisonExpressionK:
+      return invariantCond(e->attr.cmpExpr.lexpr, loop)
+        && invariantCond(e->attr.cmpExpr.rexpr, loop);
+    case AdditiveExpressionK:
+      return invariantCond(e->attr.addExpr.lexpr, loop)
+        && invariantCond(e->attr.addExpr.rexpr, loop);
+    case MultiplicativeExpressionK:
+      if (e->attr.multExpr.op->attr.TOK == OVER
+          && (e->attr.multExpr.rexpr->nodeKind != ConstantK || e->attr.multExpr.rexpr->attr.NUM == 0))
+        return FALSE;
+      return invariantCond(e->attr.multExpr.lexpr, loop)
+        && invariantCond(e->attr.multExpr.rexpr, loop);
+    default:
+      return FALSE;
+    }
+}
+
+/* Numbers the ifs of a loop body in preorder, not
+ * counting those of nested loops, and returns the
+ * number of the first with an invariant condition
+ * (or -1). *count runs on across the list.
+ */
+static int findSwitch(TreeNode *t, TreeNode *loop, int *count)
+{
+  int found;
+
+  for (; t != NULL; t = t->sibling)
+    switch (t->nodeKind)
+      {
+      case CompoundStatementK:
+        if ((found = findSwitch(t->attr.cmpdStmt.stmt_list, loop, count)) >= 0)
+          return found;
+        break;
+      case SelectionStatementK:
+        if (t->attr.selectStmt.expr->nodeKind != ConstantK
+            && invariantCond(t->attr.selectStmt.expr, loop))
+          return *count;
+        (*count)++;
+        if ((found = findSwitch(t->attr.selectStmt.if_stmt, loop, count)) >= 0
+            || (found = findSwitch(t->attr.selectStmt.else_stmt, loop, count)) >= 0)
+          return found;
+        break;
+      default:
+        break;
+      }
+  return -1;
+}
+
+/* Returns the link to the if numbered n by findSwitch */
+static TreeNode **switchAt(TreeNode **link, int *n)
+{
+  TreeNode **found;
+
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          if ((found = switchAt(&t->attr.cmpdStmt.stmt_list, n)) != NULL)
+            return found;
+          break;
+        case SelectionStatementK:
+          if ((*n)-- == 0)
+            return link;
+          if ((found = switchAt(&t->attr.selectStmt.if_stmt, n)) != NULL
+              || (found = switchAt(&t->attr.selectStmt.else_stmt, n)) != NULL)
+            return found;
+          break;
+        default:
+          break;
+        }
+    }
+  return NULL;
+}
+
+/* Puts one branch of the if at *link in its place */
+static void keepBranch(TreeNode **link, TreeNode *branch)
+{
+  if (branch == NULL)
+    {
+      branch = newCompoundStatementNode(NULL, NULL);
+      branch->nodeType = NoneT;
+    }
+  replaceStmt(link, branch);
+}
+
+/* Unswitches the loop at *link:
+ *   while (c) { ... if (e) A else B ... }
+ * becomes
+ *   if (e) while (c) { ... A ... } else while (c) { ... B ... }
+ */
+static int unswitchLoop(TreeNode **link)
+{
+  TreeNode *loop = *link, *copy, *sel, **ifLoop, **ifCopy, *cond;
+  SymbolMap map = { 0, 0, NULL, NULL };
+  int size, count = 0, n, m;
+
+  if (loop->attr.iterStmt.loop_stmt == NULL)
+    return FALSE;
+  size = 1 + countTreeNodes(loop->attr.iterStmt.expr) + countTreeNodes(loop->attr.iterStmt.loop_stmt);
+  if (size > UNSWITCH_MAX_SIZE || size > budget)
+    return FALSE;
+  n = findSwitch(loop->attr.iterStmt.loop_stmt, loop, &count);
+  if (n < 0)
+    return FALSE;
+
+  copy = cloneTree(loop, &map);
+  free(map.from);
+  free(map.to);
+  m = n;
+  ifLoop = switchAt(&loop->attr.iterStmt.loop_stmt, &m);
+  m = n;
+  ifCopy = switchAt(&copy->attr.iterStmt.loop_stmt, &m);
+
+  cond = (*ifLoop)->attr.selectStmt.expr;
+  keepBranch(ifCopy, (*ifCopy)->attr.selectStmt.if_stmt);
+  keepBranch(ifLoop, (*ifLoop)->attr.selectStmt.else_stmt);
+
+  sel = newSelectionStatementNode(cond, copy, loop);
+  sel->nodeType = NoneT;
+  sel->sibling = loop->sibling;
+  loop->sibling = NULL;
+  copy->sibling = NULL;
+  *link = sel;
+
+  budget -= size;
+  unswitched++;
+  return TRUE;
+}
+
+static void walkStmts(TreeNode **link)
+{
+  for (; *link != NULL; link = &(*link)->sibling)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case CompoundStatementK:
+          walkStmts(&t->attr.cmpdStmt.stmt_list);
+          break;
+        case SelectionStatementK:
+          walkStmts(&t->attr.selectStmt.if_stmt);
+          walkStmts(&t->attr.selectStmt.else_stmt);
+          break;
+        case IterationStatementK:
+          // outer loops first, so a test leaves the whole nest;
+          // each copy may have another invariant if to unswitch
+          if (unswitchLoop(link))
+            {
+              walkStmts(&(*link)->attr.selectStmt.if_stmt);
+              walkStmts(&(*link)->attr.selectStmt.else_stmt);
+            }
+          else
+            walkStmts(&t->attr.iterStmt.loop_stmt);
+          break;
+        default:
+          break;
+        }
+    }
+}
+
+/* Function unswitchLoops hoists invariant conditions
+ * out of the while loops of the program
+ */
+int unswitchLoops(TreeNode *syntaxTree)
+{
+  TreeNode *t;
+
+  unswitched = 0;
+  cg = cgBuild(syntaxTree);
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodeKind == FunctionDeclarationK)
+      {
+        budget = UNSWITCH_BUDGET;
+        walkStmts(&t->attr.funcDecl.cmpd_stmt);
+      }
+  cgFree(cg);
+  cg = NULL;
+  return unswitched;
+}
@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: unswitch.h                                 */
+/* Loop unswitching for the C- compiler             */
+/****************************************************/
+
+#ifndef _UNSWITCH_H_
+#define _UNSWITCH_H_
+
+/* Function unswitchLoops moves the ifs of while loops
+ * whose conditions the loop cannot change (calls
+ * included, by what their callees may assign) out of
+ * the loop, making one copy of the loop for each
+ * branch, within a code-growth limit per function.
+ * Returns the number of loops unswitched.
+ */
+int unswitchLoops(TreeNode *syntaxTree);
+
+#endif
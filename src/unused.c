@@ -0,0 +1,132 @@
+/****************************************************/
+/* File: unused.c                                   */
+/* Whole-program removal of unused functions and    */
+/* globals for the C- compiler                      */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "callgraph.h"
+#include "unused.h"
+
+/* globals referred to by reachable functions */
+static int nUsed, capUsed;
+static SymbolInfo **used;
+
+static void markCallees(CgNode node)
+{
+  int i;
+  if (node == NULL || node->mark)
+    return;
+  node->mark = TRUE;
+  for (i = 0; i < node->nCalls; ++i)
+    markCallees(node->calls[i]->callee);
+}
+
+static int isUsed(SymbolInfo *symbolInfo)
+{
+  int i;
+  for (i = 0; i < nUsed; ++i)
+    if (used[i] == symbolInfo)
+      return TRUE;
+  return FALSE;
+}
+
+static void markGlobals(TreeNode *t)
+{
+  TreeNode **kids[3];
+  int i, n;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == VariableK && t->symbolInfo->nodeType != FuncT
+          && t->symbolInfo->attr.intInfo.globalFlag && !isUsed(t->symbolInfo))
+        {
+          GROW(used, nUsed, capUsed);
+          used[nUsed++] = t->symbolInfo;
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        markGlobals(*kids[i]);
+    }
+}
+
+/* Function removeUnused drops the functions and
+ * globals main cannot reach
+ */
+TreeNode *removeUnused(TreeNode *syntaxTree)
+{
+  CallGraph cg = cgBuild(syntaxTree);
+  TreeNode **link;
+  int i, mainFound = FALSE;
+  int nFuncs = 0, codeNodes = 0, nGlobals = 0, dataBytes = 0;
+
+  for (i = 0; i < cg->nNodes; ++i)
+    cg->nodes[i]->mark = FALSE;
+  for (i = 0; i < cg->nNodes; ++i)
+    if (strcmp(cg->nodes[i]->func->attr.funcDecl._var->attr.ID, "main") == 0)
+      {
+        markCallees(cg->nodes[i]);
+        mainFound = TRUE;
+      }
+  if (!mainFound)
+    {
+      cgFree(cg);
+      return syntaxTree;
+    }
+
+  nUsed = 0;
+  for (i = 0; i < cg->nNodes; ++i)
+    if (cg->nodes[i]->mark)
+      markGlobals(cg->nodes[i]->func->attr.funcDecl.cmpd_stmt);
+
+  link = &syntaxTree;
+  while (*link != NULL)
+    {
+      TreeNode *t = *link;
+      switch (t->nodeKind)
+        {
+        case FunctionDeclarationK:
+          if (!cgLookup(cg, t->attr.funcDecl._var->symbolInfo)->mark)
+            {
+              nFuncs++;
+              codeNodes += 1 + countTreeNodes(t->attr.funcDecl.cmpd_stmt);
+              *link = t->sibling;
+              continue;
+            }
+          break;
+        case VariableDeclarationK:
+          if (!isUsed(t->attr.varDecl._var->symbolInfo))
+            {
+              nGlobals++;
+              dataBytes += sizeof(int);
+              *link = t->sibling;
+              continue;
+            }
+          break;
+        case ArrayDeclarationK:
+          if (!isUsed(t->attr.arrDecl._var->symbolInfo))
+            {
+              nGlobals++;
+              dataBytes += sizeof(int) * t->attr.arrDecl._var->symbolInfo->attr.arrInfo.arrLen;
+              *link = t->sibling;
+              continue;
+            }
+          break;
+        default:
+          DONT_OCCUR_PRINT;
+        }
+      link = &t->sibling;
+    }
+
+  if (TraceOptimize && (nFuncs > 0 || nGlobals > 0))
+    fprintf(listing, "\nRemoved %d unused function(s) (%d tree nodes of code) "
+            "and %d unused global(s) (%d bytes of data)\n",
+            nFuncs, codeNodes, nGlobals, dataBytes);
+
+  cgFree(cg);
+  free(used);
+  used = NULL;
+  nUsed = capUsed = 0;
+  return syntaxTree;
+}
@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: unused.h                                   */
+/* Whole-program removal of unused functions and    */
+/* globals for the C- compiler                      */
+/****************************************************/
+
+#ifndef _UNUSED_H_
+#define _UNUSED_H_
+
+/* Function removeUnused drops the functions that
+ * cannot be called from main and the globals that no
+ * remaining function refers to, reports the code and
+ * data saved when TraceOptimize is set, and returns
+ * the new root of the syntax tree
+ */
+TreeNode *removeUnused(TreeNode *syntaxTree);
+
+#endif
@@ -89,6 +89,9 @@ printToken(TokenType token, const char* tokenString)
     case OVER:    fprintf(listing,
                           "OVER\t\t\t%s\n",
                           tokenString); break;
+    case SHR:     fprintf(listing,
+                          "SHR\t\t\t%s\n",
+                          tokenString); break;
 
     case LT:      fprintf(listing,
                           "<\t\t\t%s\n",
@@ -452,6 +455,50 @@ newConstantNode(char *_NUM)
   return t;
 }
 
+TreeNode *
+newIntConstantNode(int value)
+{
+  TreeNode * t = allocateTreeNode();
+  if (t != NULL)
+    setConstantNode(t, value);
+
+  return t;
+}
+
+/* declaration of a fresh int local, with its own symbol */
+TreeNode *
+newScalarDeclarationNode(char *name)
+{
+  TreeNode * t = newVariableDeclarationNode(newTokenTypeNode(INT),
+                                            newVariableNode(name));
+  SymbolInfo * symbolInfo;
+  if (t != NULL)
+    {
+      MALLOC(symbolInfo, sizeof(*symbolInfo));
+      memset(symbolInfo, 0, sizeof(*symbolInfo));
+      symbolInfo->nodeType = IntT;
+      t->nodeType = NoneT;
+      t->attr.varDecl._var->nodeType = IntT;
+      t->attr.varDecl._var->symbolInfo = symbolInfo;
+    }
+
+  return t;
+}
+
+/* VariableK referring to an already declared symbol */
+TreeNode *
+newSymbolUseNode(char *name, SymbolInfo *symbolInfo)
+{
+  TreeNode * t = newVariableNode(name);
+  if (t != NULL)
+    {
+      t->symbolInfo = symbolInfo;
+      t->nodeType = symbolInfo->nodeType;
+    }
+
+  return t;
+}
+
 TreeNode *
 newTokenTypeNode(TokenType token)
 {
@@ -470,7 +517,7 @@ newTokenTypeNode(TokenType token)
  * copy of an existing string
  */
 char*
-copyString(char * s)
+copyString(const char * s)
 {
   size_t n;
   char * t;
@@ -509,6 +556,7 @@ operatorString(TokenType op)
   if(op == MINUS) return "-";
   if(op == TIMES) return "*";
   if(op == OVER) return "/";
+  if(op == SHR) return ">>";
 
   if(op == LT) return "<";
   if(op == LE) return "<=";
@@ -683,3 +731,448 @@ printTree(TreeNode* tree)
   UNINDENT;
 }
 
+
+/* Function hasSideEffect returns TRUE if evaluating
+ * the expression assigns or calls a function
+ */
+int
+hasSideEffect(TreeNode *t)
+{
+  if (t == NULL) return FALSE;
+  switch (t->nodeKind)
+    {
+    case AssignExpressionK:
+    case CallK:
+      return TRUE;
+    case ComparisonExpressionK:
+      return hasSideEffect(t->attr.cmpExpr.lexpr)
+        || hasSideEffect(t->attr.cmpExpr.rexpr);
+    case AdditiveExpressionK:
+      return hasSideEffect(t->attr.addExpr.lexpr)
+        || hasSideEffect(t->attr.addExpr.rexpr);
+    case MultiplicativeExpressionK:
+      return hasSideEffect(t->attr.multExpr.lexpr)
+        || hasSideEffect(t->attr.multExpr.rexpr);
+    case ArrayK:
+      return hasSideEffect(t->attr.arr.arr_expr);
+    default:
+      return FALSE;
+    }
+}
+
+/* Procedure setConstantNode turns an expression node
+ * into a ConstantK node holding the given value
+ */
+void
+setConstantNode(TreeNode *t, int value)
+{
+  t->nodeKind = ConstantK;
+  t->nodeType = IntT;
+  t->symbolInfo = NULL;
+  t->attr.NUM = value;
+}
+
+/* Function treeChildren stores the addresses of the
+ * statement/expression child links of a node in the
+ * order cgen evaluates them, and returns their count
+ */
+int
+treeChildren(TreeNode *t, TreeNode **slots[3])
+{
+  int n = 0;
+  switch (t->nodeKind)
+    {
+    case FunctionDeclarationK:
+      slots[n++] = &t->attr.funcDecl.cmpd_stmt;
+      break;
+    case CompoundStatementK:
+      slots[n++] = &t->attr.cmpdStmt.local_decl;
+      slots[n++] = &t->attr.cmpdStmt.stmt_list;
+      break;
+    case ExpressionStatementK:
+      slots[n++] = &t->attr.exprStmt.expr;
+      break;
+    case SelectionStatementK:
+      slots[n++] = &t->attr.selectStmt.expr;
+      slots[n++] = &t->attr.selectStmt.if_stmt;
+      slots[n++] = &t->attr.selectStmt.else_stmt;
+      break;
+    case IterationStatementK:
+      slots[n++] = &t->attr.iterStmt.expr;
+      slots[n++] = &t->attr.iterStmt.loop_stmt;
+      break;
+    case ReturnStatementK:
+      slots[n++] = &t->attr.retStmt.expr;
+      break;
+    case AssignExpressionK:
+      slots[n++] = &t->attr.assignStmt.expr;
+      slots[n++] = &t->attr.assignStmt._var;
+      break;
+    case ComparisonExpressionK:
+      slots[n++] = &t->attr.cmpExpr.lexpr;
+      slots[n++] = &t->attr.cmpExpr.rexpr;
+      break;
+    case AdditiveExpressionK:
+      slots[n++] = &t->attr.addExpr.lexpr;
+      slots[n++] = &t->attr.addExpr.rexpr;
+      break;
+    case MultiplicativeExpressionK:
+      slots[n++] = &t->attr.multExpr.lexpr;
+      slots[n++] = &t->attr.multExpr.rexpr;
+      break;
+    case ArrayK:
+      slots[n++] = &t->attr.arr.arr_expr;
+      slots[n++] = &t->attr.arr._var;
+      break;
+    case CallK:
+      slots[n++] = &t->attr.call.expr_list;
+      slots[n++] = &t->attr.call._var;
+      break;
+    default:
+      break;
+    }
+  return n;
+}
+
+/* Function countTreeNodes returns the number of nodes
+ * in a tree including its siblings
+ */
+int
+countTreeNodes(TreeNode *t)
+{
+  int cnt = 0;
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode **slots[3];
+      int i, n = treeChildren(t, slots);
+      cnt++;
+      for (i = 0; i < n; ++i)
+        cnt += countTreeNodes(*slots[i]);
+    }
+  return cnt;
+}
+
+static SymbolInfo *
+mapSymbol(SymbolMap *map, SymbolInfo *symbolInfo)
+{
+  int i;
+  for (i = 0; i < map->n; ++i)
+    if (map->from[i] == symbolInfo)
+      return map->to[i];
+  return symbolInfo;
+}
+
+/* gives the symbol declared by _var a fresh copy */
+static void
+copyDeclaredSymbol(SymbolMap *map, TreeNode *_var)
+{
+  SymbolInfo *copy;
+  if (_var->symbolInfo == NULL)
+    return;
+  MALLOC(copy, sizeof(*copy));
+  *copy = *_var->symbolInfo;
+  if (map->n >= map->cap)
+    {
+      map->cap = map->cap ? map->cap * 2 : 8;
+      REALLOC(map->from, map->cap * sizeof(*map->from));
+      REALLOC(map->to, map->cap * sizeof(*map->to));
+    }
+  map->from[map->n] = _var->symbolInfo;
+  map->to[map->n] = copy;
+  map->n++;
+}
+
+static TreeNode *cloneList(TreeNode *, SymbolMap *);
+
+static TreeNode *
+cloneNode(TreeNode *t, SymbolMap *map)
+{
+  TreeNode *c;
+  if (t == NULL) return NULL;
+  c = allocateTreeNode();
+  *c = *t;
+  c->sibling = NULL;
+  switch (t->nodeKind)
+    {
+    case VariableDeclarationK:
+      copyDeclaredSymbol(map, t->attr.varDecl._var);
+      c->attr.varDecl.type_spec = cloneNode(t->attr.varDecl.type_spec, map);
+      c->attr.varDecl._var = cloneNode(t->attr.varDecl._var, map);
+      break;
+    case ArrayDeclarationK:
+      copyDeclaredSymbol(map, t->attr.arrDecl._var);
+      c->attr.arrDecl.type_spec = cloneNode(t->attr.arrDecl.type_spec, map);
+      c->attr.arrDecl._var = cloneNode(t->attr.arrDecl._var, map);
+      c->attr.arrDecl._num = cloneNode(t->attr.arrDecl._num, map);
+      break;
+    case FunctionDeclarationK:
+      copyDeclaredSymbol(map, t->attr.funcDecl._var);
+      c->attr.funcDecl.type_spec = cloneNode(t->attr.funcDecl.type_spec, map);
+      c->attr.funcDecl._var = cloneNode(t->attr.funcDecl._var, map);
+      c->attr.funcDecl.params = cloneList(t->attr.funcDecl.params, map);
+      c->attr.funcDecl.cmpd_stmt = cloneList(t->attr.funcDecl.cmpd_stmt, map);
+      break;
+    case VariableParameterK:
+      copyDeclaredSymbol(map, t->attr.varParam._var);
+      c->attr.varParam.type_spec = cloneNode(t->attr.varParam.type_spec, map);
+      c->attr.varParam._var = cloneNode(t->attr.varParam._var, map);
+      break;
+    case ArrayParameterK:
+      copyDeclaredSymbol(map, t->attr.arrParam._var);
+      c->attr.arrParam.type_spec = cloneNode(t->attr.arrParam.type_spec, map);
+      c->attr.arrParam._var = cloneNode(t->attr.arrParam._var, map);
+      break;
+    case ComparisonExpressionK:
+      c->attr.cmpExpr.op = cloneNode(t->attr.cmpExpr.op, map);
+      c->attr.cmpExpr.lexpr = cloneList(t->attr.cmpExpr.lexpr, map);
+      c->attr.cmpExpr.rexpr = cloneList(t->attr.cmpExpr.rexpr, map);
+      break;
+    case AdditiveExpressionK:
+      c->attr.addExpr.op = cloneNode(t->attr.addExpr.op, map);
+      c->attr.addExpr.lexpr = cloneList(t->attr.addExpr.lexpr, map);
+      c->attr.addExpr.rexpr = cloneList(t->attr.addExpr.rexpr, map);
+      break;
+    case MultiplicativeExpressionK:
+      c->attr.multExpr.op = cloneNode(t->attr.multExpr.op, map);
+      c->attr.multExpr.lexpr = cloneList(t->attr.multExpr.lexpr, map);
+      c->attr.multExpr.rexpr = cloneList(t->attr.multExpr.rexpr, map);
+      break;
+    case VariableK:
+      c->attr.ID = copyString(t->attr.ID);
+      c->symbolInfo = mapSymbol(map, t->symbolInfo);
+      break;
+    case ConstantK:
+    case TokenTypeK:
+      break;
+    default:
+    {
+      // statements and the remaining expressions only link children
+      TreeNode **from[3], **to[3];
+      int i, n = treeChildren(t, from);
+      treeChildren(c, to);
+      for (i = 0; i < n; ++i)
+        *to[i] = cloneList(*from[i], map);
+      break;
+    }
+    }
+  return c;
+}
+
+static TreeNode *
+cloneList(TreeNode *t, SymbolMap *map)
+{
+  TreeNode *head = NULL, *tail = NULL;
+  for (; t != NULL; t = t->sibling)
+    {
+      TreeNode *c = cloneNode(t, map);
+      if (tail == NULL)
+        head = c;
+      else
+        tail->sibling = c;
+      tail = c;
+    }
+  return head;
+}
+
+/* Function cloneTree deep-copies a node and its
+ * subtree (not its siblings). Parameters and locals
+ * declared inside it get fresh symbols, recorded in
+ * map; uses of other symbols are shared with the
+ * original.
+ */
+TreeNode *
+cloneTree(TreeNode *t, SymbolMap *map)
+{
+  return cloneNode(t, map);
+}
+
+/* Function alwaysReturns returns TRUE if every path
+ * through the statement list ends in a return
+ */
+int
+alwaysReturns(TreeNode *t)
+{
+  for (; t != NULL; t = t->sibling)
+    switch (t->nodeKind)
+      {
+      case ReturnStatementK:
+        return TRUE;
+      case CompoundStatementK:
+        if (alwaysReturns(t->attr.cmpdStmt.stmt_list))
+          return TRUE;
+        break;
+      case SelectionStatementK:
+        if (t->attr.selectStmt.else_stmt != NULL
+            && alwaysReturns(t->attr.selectStmt.if_stmt)
+            && alwaysReturns(t->attr.selectStmt.else_stmt))
+          return TRUE;
+        break;
+      default:
+        break;
+      }
+  return FALSE;
+}
+
+static TreeNode *
+appendToBranch(TreeNode *branch, TreeNode *rest)
+{
+  TreeNode *t = newCompoundStatementNode(NULL, addSibling(branch, rest));
+  t->nodeType = NoneT;
+  return t;
+}
+
+/* Procedure sinkRest moves the statements after an if
+ * whose one branch always returns into the other
+ * branch, so that `if (c) return a; return b;` has
+ * its returns in tail position
+ */
+void
+sinkRest(TreeNode *t)
+{
+  for (; t != NULL; t = t->sibling)
+    switch (t->nodeKind)
+      {
+      case CompoundStatementK:
+        sinkRest(t->attr.cmpdStmt.stmt_list);
+        break;
+      case IterationStatementK:
+        sinkRest(t->attr.iterStmt.loop_stmt);
+        break;
+      case SelectionStatementK:
+        if (t->sibling != NULL && alwaysReturns(t->attr.selectStmt.if_stmt))
+          {
+            t->attr.selectStmt.else_stmt = appendToBranch(t->attr.selectStmt.else_stmt, t->sibling);
+            t->sibling = NULL;
+          }
+        else if (t->sibling != NULL && alwaysReturns(t->attr.selectStmt.else_stmt))
+          {
+            t->attr.selectStmt.if_stmt = appendToBranch(t->attr.selectStmt.if_stmt, t->sibling);
+            t->sibling = NULL;
+          }
+        sinkRest(t->attr.selectStmt.if_stmt);
+        sinkRest(t->attr.selectStmt.else_stmt);
+        break;
+      default:
+        break;
+      }
+}
+
+/* Function replaceStmt replaces the statement at
+ * *link by the list repl (NULL removes it) and
+ * returns the link to continue at
+ */
+TreeNode **
+replaceStmt(TreeNode **link, TreeNode *repl)
+{
+  TreeNode *next = (*link)->sibling;
+  if (repl == NULL)
+    {
+      *link = next;
+      return link;
+    }
+  *link = repl;
+  while (repl->sibling != NULL)
+    repl = repl->sibling;
+  repl->sibling = next;
+  return &repl->sibling;
+}
+
+/* Function constantStep returns TRUE if the statement
+ * is var = var + C, var = C + var or var = var - C,
+ * and stores the signed step C
+ */
+int
+constantStep(TreeNode *stmt, SymbolInfo *var, int *step)
+{
+  TreeNode *assign, *e, *l, *r;
+
+  if (stmt->nodeKind != ExpressionStatementK || (assign = stmt->attr.exprStmt.expr) == NULL
+      || assign->nodeKind != AssignExpressionK
+      || assign->attr.assignStmt._var->nodeKind != VariableK
+      || assign->attr.assignStmt._var->symbolInfo != var)
+    return FALSE;
+  e = assign->attr.assignStmt.expr;
+  if (e->nodeKind != AdditiveExpressionK)
+    return FALSE;
+  l = e->attr.addExpr.lexpr;
+  r = e->attr.addExpr.rexpr;
+  if (l->nodeKind == VariableK && l->symbolInfo == var && r->nodeKind == ConstantK)
+    *step = e->attr.addExpr.op->attr.TOK == PLUS ? r->attr.NUM : -r->attr.NUM;
+  else if (r->nodeKind == VariableK && r->symbolInfo == var && l->nodeKind == ConstantK
+           && e->attr.addExpr.op->attr.TOK == PLUS)
+    *step = l->attr.NUM;
+  else
+    return FALSE;
+  return TRUE;
+}
+
+/* Function indexOffset returns TRUE if the index is
+ * iv, iv + k, k + iv or iv - k, and stores k
+ */
+int
+indexOffset(TreeNode *index, SymbolInfo *iv, int *k)
+{
+  TreeNode *l, *r;
+
+  if (index->nodeKind == VariableK && index->symbolInfo == iv)
+    {
+      *k = 0;
+      return TRUE;
+    }
+  if (index->nodeKind != AdditiveExpressionK)
+    return FALSE;
+  l = index->attr.addExpr.lexpr;
+  r = index->attr.addExpr.rexpr;
+  if (l->nodeKind == VariableK && l->symbolInfo == iv && r->nodeKind == ConstantK)
+    *k = index->attr.addExpr.op->attr.TOK == PLUS ? r->attr.NUM : -r->attr.NUM;
+  else if (r->nodeKind == VariableK && r->symbolInfo == iv && l->nodeKind == ConstantK
+           && index->attr.addExpr.op->attr.TOK == PLUS)
+    *k = l->attr.NUM;
+  else
+    return FALSE;
+  return TRUE;
+}
+
+/* Function assignsSymbol returns TRUE if the node or
+ * its subtree (not its siblings) assigns the symbol
+ */
+int
+assignsSymbol(TreeNode *t, SymbolInfo *var)
+{
+  TreeNode **kids[3], *kid;
+  int i, n;
+
+  if (t->nodeKind == AssignExpressionK && t->attr.assignStmt._var->nodeKind == VariableK
+      && t->attr.assignStmt._var->symbolInfo == var)
+    return TRUE;
+  n = treeChildren(t, kids);
+  for (i = 0; i < n; ++i)
+    for (kid = *kids[i]; kid != NULL; kid = kid->sibling)
+      if (assignsSymbol(kid, var))
+        return TRUE;
+  return FALSE;
+}
+
+/* Function constantOnEntry returns the constant the
+ * statements from head up to stmt last assign to a
+ * scalar, or NULL if its value there is not known
+ */
+TreeNode *
+constantOnEntry(TreeNode *head, TreeNode *stmt, SymbolInfo *var)
+{
+  TreeNode *t, *value = NULL;
+
+  for (t = head; t != NULL && t != stmt; t = t->sibling)
+    {
+      TreeNode *e = t->nodeKind == ExpressionStatementK ? t->attr.exprStmt.expr : NULL;
+      if (!assignsSymbol(t, var))
+        continue;
+      value = NULL;
+      if (e != NULL && e->nodeKind == AssignExpressionK
+          && e->attr.assignStmt._var->nodeKind == VariableK
+          && e->attr.assignStmt._var->symbolInfo == var
+          && e->attr.assignStmt.expr->nodeKind == ConstantK)
+        value = e->attr.assignStmt.expr;
+    }
+  return value;
+}
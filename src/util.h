@@ -36,6 +36,9 @@ TreeNode *newVariableNode(char *);
 TreeNode *newArrayNode(TreeNode *, TreeNode *);
 TreeNode *newCallNode(TreeNode *, TreeNode *);
 TreeNode *newConstantNode(char *);
+TreeNode *newIntConstantNode(int);
+TreeNode *newScalarDeclarationNode(char *);
+TreeNode *newSymbolUseNode(char *, SymbolInfo *);
 TreeNode *newTokenTypeNode(TokenType);
 
 /* Procedure printToken prints a token 
@@ -46,11 +49,90 @@ void printToken(TokenType, const char*);
 /* Function copyString allocates and makes a new
  * copy of an existing string
  */
-char* copyString(char*);
+char* copyString(const char*);
 
 /* procedure printTree prints a syntax tree to the 
  * listing file using indentation to indicate subtrees
  */
 void printTree(TreeNode*);
 
+/* Function hasSideEffect returns TRUE if evaluating
+ * the expression assigns or calls a function
+ */
+int hasSideEffect(TreeNode *);
+
+/* Procedure setConstantNode turns an expression node
+ * into a ConstantK node holding the given value
+ */
+void setConstantNode(TreeNode *, int);
+
+/* Function treeChildren stores the addresses of the
+ * statement/expression child links of a node in the
+ * order cgen evaluates them, and returns their count.
+ * Each link heads a sibling list.
+ */
+int treeChildren(TreeNode *, TreeNode **[3]);
+
+/* Function countTreeNodes returns the number of nodes
+ * in a tree including its siblings
+ */
+int countTreeNodes(TreeNode *);
+
+/* Symbols declared inside a cloned tree and
+ * their copies in the clone
+ */
+typedef struct SymbolMapRec
+{
+  int n, cap;
+  SymbolInfo **from, **to;
+} SymbolMap;
+
+/* Function cloneTree deep-copies a node and its
+ * subtree (not its siblings). Parameters and locals
+ * declared inside it get fresh symbols, recorded in
+ * map; uses of other symbols are shared with the
+ * original.
+ */
+TreeNode *cloneTree(TreeNode *, SymbolMap *);
+
+/* Function alwaysReturns returns TRUE if every path
+ * through the statement list ends in a return
+ */
+int alwaysReturns(TreeNode *);
+
+/* Procedure sinkRest moves the statements after an if
+ * whose one branch always returns into the other
+ * branch, so that the returns of a function body end
+ * up in tail position
+ */
+void sinkRest(TreeNode *);
+
+/* Function replaceStmt replaces the statement at
+ * *link by the list repl (NULL removes it) and
+ * returns the link to continue at
+ */
+TreeNode **replaceStmt(TreeNode **, TreeNode *);
+
+/* Function constantStep returns TRUE if the statement
+ * is var = var + C, var = C + var or var = var - C,
+ * and stores the signed step C
+ */
+int constantStep(TreeNode *, SymbolInfo *, int *);
+
+/* Function indexOffset returns TRUE if the index is
+ * iv, iv + k, k + iv or iv - k, and stores k
+ */
+int indexOffset(TreeNode *, SymbolInfo *, int *);
+
+/* Function assignsSymbol returns TRUE if the node or
+ * its subtree (not its siblings) assigns the symbol
+ */
+int assignsSymbol(TreeNode *, SymbolInfo *);
+
+/* Function constantOnEntry returns the constant the
+ * statements from head up to stmt last assign to a
+ * scalar, or NULL if its value there is not known
+ */
+TreeNode *constantOnEntry(TreeNode *, TreeNode *, SymbolInfo *);
+
 #endif
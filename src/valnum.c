@@ -0,0 +1,404 @@
+/****************************************************/
+/* File: valnum.c                                   */
+/* Value numbering and common-subexpression         */
+/* elimination for the C- compiler                  */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "cfg.h"
+#include "valnum.h"
+
+/* Operators of value keys other than the C- tokens */
+typedef enum {
+    VnConst = 1000, /* a: value */
+    VnGlobal,       /* a: symbol, b: memory version */
+    VnAddr,         /* a: symbol, b: memory version for array parameters */
+    VnLoad,         /* a: address, b: index, c: memory version */
+} VnOp;
+
+typedef struct
+{
+  int op, a, b, c;
+} VnKey;
+
+/* A value computed in the blocks on the current
+ * dominator-tree path. slot is where it was first
+ * computed; temp holds it once something reuses it.
+ */
+typedef struct
+{
+  VnKey key;
+  int vn;
+  TreeNode **slot;
+  SymbolInfo *temp;
+} VnEntry;
+
+/* What a block may change, for the blocks it joins */
+typedef struct
+{
+  char *defs;       /* tracked scalars assigned */
+  int clobbers;     /* stores to memory or calls */
+} BlockEffect;
+
+/* state of one run of the pass */
+static Cfg cfg;
+static TreeNode *func;
+static int nextVn;
+static int *varVn;          /* tracked scalar -> its value number now */
+static int memVn;           /* version of memory (arrays, globals) now */
+static int nTable, capTable;
+static VnEntry *table;      /* scoped by the dominator tree */
+static int nLeaves, capLeaves;
+static VnEntry *leaves;     /* constants and memory reads, never scoped */
+static int nSyms, capSyms;
+static SymbolInfo **syms;
+static BlockEffect *effects;
+static int rewrites;
+
+static int symId(SymbolInfo *symbolInfo)
+{
+  int i;
+  for (i = 0; i < nSyms; ++i)
+    if (syms[i] == symbolInfo)
+      return i;
+  GROW(syms, nSyms, capSyms);
+  syms[nSyms] = symbolInfo;
+  return nSyms++;
+}
+
+static VnKey makeKey(int op, int a, int b, int c)
+{
+  VnKey key;
+  // operand order does not matter for these
+  if ((op == PLUS || op == TIMES || op == EQ || op == NE) && a > b)
+    {
+      int t = a;
+      a = b;
+      b = t;
+    }
+  key.op = op;
+  key.a = a;
+  key.b = b;
+  key.c = c;
+  return key;
+}
+
+static int sameKey(VnKey x, VnKey y)
+{
+  return x.op == y.op && x.a == y.a && x.b == y.b && x.c == y.c;
+}
+
+static int leafVn(VnKey key)
+{
+  int i;
+  for (i = 0; i < nLeaves; ++i)
+    if (sameKey(leaves[i].key, key))
+      return leaves[i].vn;
+  GROW(leaves, nLeaves, capLeaves);
+  leaves[nLeaves].key = key;
+  leaves[nLeaves].vn = nextVn++;
+  return leaves[nLeaves++].vn;
+}
+
+static VnEntry *lookup(VnKey key)
+{
+  int i;
+  for (i = nTable - 1; i >= 0; --i)
+    if (sameKey(table[i].key, key))
+      return &table[i];
+  return NULL;
+}
+
+static void insert(VnKey key, int vn, TreeNode **slot)
+{
+  GROW(table, nTable, capTable);
+  table[nTable].key = key;
+  table[nTable].vn = vn;
+  table[nTable].slot = slot;
+  table[nTable].temp = NULL;
+  nTable++;
+}
+
+/* Makes the first computation of an entry save its
+ * value: e becomes (_cse = e)
+ */
+static SymbolInfo *entryTemp(VnEntry *e)
+{
+  TreeNode *decl, *first, *assign;
+  int i;
+  if (e->temp != NULL)
+    return e->temp;
+
+  decl = newScalarDeclarationNode("_cse");
+  e->temp = decl->attr.varDecl._var->symbolInfo;
+  decl->sibling = func->attr.funcDecl.cmpd_stmt->attr.cmpdStmt.local_decl;
+  func->attr.funcDecl.cmpd_stmt->attr.cmpdStmt.local_decl = decl;
+
+  first = *e->slot;
+  assign = newAssignExpressionNode(newSymbolUseNode("_cse", e->temp), first);
+  assign->nodeType = IntT;
+  assign->sibling = first->sibling;
+  first->sibling = NULL;
+  *e->slot = assign;
+  // the argument after a wrapped one now hangs off the wrapper
+  for (i = 0; i < nTable; ++i)
+    if (table[i].slot == &first->sibling)
+      table[i].slot = &assign->sibling;
+  return e->temp;
+}
+
+/* The link to argument i of a call */
+static TreeNode **argSlot(TreeNode *call, int i)
+{
+  TreeNode **slot = &call->attr.call.expr_list;
+  while (i-- > 0)
+    slot = &(*slot)->sibling;
+  return slot;
+}
+
+/* Numbers the expression at *slot in evaluation order,
+ * replacing it by a temporary if its value is known
+ */
+static int vnExpr(TreeNode **slot)
+{
+  TreeNode *t = *slot, **kids[3];
+  int idx, mark = nTable, v[2] = { 0, 0 }, i, n;
+  VnKey key;
+  VnEntry *e;
+
+  switch (t->nodeKind)
+    {
+    case ConstantK:
+      return leafVn(makeKey(VnConst, t->attr.NUM, 0, 0));
+
+    case VariableK:
+      if (t->symbolInfo->nodeType == IntArrayT)
+        return leafVn(makeKey(VnAddr, symId(t->symbolInfo),
+                              t->symbolInfo->attr.arrInfo.isParam ? memVn : 0, 0));
+      idx = cfgVarIndex(cfg, t->symbolInfo);
+      if (idx >= 0)
+        return varVn[idx];
+      return leafVn(makeKey(VnGlobal, symId(t->symbolInfo), memVn, 0));
+
+    case AssignExpressionK:
+    {
+      TreeNode *var = t->attr.assignStmt._var;
+      int value = vnExpr(&t->attr.assignStmt.expr);
+      if (var->nodeKind == VariableK && (idx = cfgVarIndex(cfg, var->symbolInfo)) >= 0)
+        varVn[idx] = value;
+      else if (var->nodeKind == VariableK)
+        memVn = nextVn++;
+      else if (var->nodeKind == ArrayK)
+        {
+          int index = vnExpr(&var->attr.arr.arr_expr);
+          int base = vnExpr(&var->attr.arr._var);
+          memVn = nextVn++;
+          // a load of the element just stored reads the stored value
+          insert(makeKey(VnLoad, base, index, memVn), value, &t->attr.assignStmt.expr);
+        }
+      else
+        DONT_OCCUR_PRINT;
+      return value;
+    }
+
+    case CallK:
+      // found again from the list each time, as reusing an
+      // argument wraps it and moves the link to the next
+      for (i = 0; *(kids[0] = argSlot(t, i)) != NULL; ++i)
+        vnExpr(kids[0]);
+      // the callee may store to any array or global
+      memVn = nextVn++;
+      return nextVn++;
+
+    case ComparisonExpressionK:
+    case AdditiveExpressionK:
+    case MultiplicativeExpressionK:
+    case ArrayK:
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        v[i] = vnExpr(kids[i]);
+      if (t->nodeKind == ArrayK)
+        key = makeKey(VnLoad, v[1], v[0], memVn);
+      else if (t->nodeKind == ComparisonExpressionK)
+        key = makeKey(t->attr.cmpExpr.op->attr.TOK, v[0], v[1], 0);
+      else if (t->nodeKind == AdditiveExpressionK)
+        key = makeKey(t->attr.addExpr.op->attr.TOK, v[0], v[1], 0);
+      else
+        key = makeKey(t->attr.multExpr.op->attr.TOK, v[0], v[1], 0);
+
+      e = lookup(key);
+      if (e == NULL)
+        {
+          insert(key, nextVn, slot);
+          return nextVn++;
+        }
+      if (!hasSideEffect(t))
+        {
+          TreeNode *first = *e->slot;
+          SymbolInfo *temp = entryTemp(e);
+          TreeNode *use = newSymbolUseNode("_cse", temp);
+          // t may be the argument right after the one wrapped
+          if (slot == &first->sibling)
+            slot = &(*e->slot)->sibling;
+          use->sibling = t->sibling;
+          *slot = use;
+          // what was computed inside the replaced tree is gone
+          nTable = mark;
+          rewrites++;
+        }
+      return e->vn;
+
+    default:
+      DONT_OCCUR_PRINT;
+      return nextVn++;
+    }
+}
+
+static void blockEffects(TreeNode *t, BlockEffect *effect)
+{
+  TreeNode **kids[3];
+  int i, n, idx;
+
+  for (; t != NULL; t = t->sibling)
+    {
+      if (t->nodeKind == CallK)
+        effect->clobbers = TRUE;
+      else if (t->nodeKind == AssignExpressionK)
+        {
+          TreeNode *var = t->attr.assignStmt._var;
+          if (var->nodeKind == VariableK && (idx = cfgVarIndex(cfg, var->symbolInfo)) >= 0)
+            effect->defs[idx] = TRUE;
+          else
+            effect->clobbers = TRUE;
+        }
+      n = treeChildren(t, kids);
+      for (i = 0; i < n; ++i)
+        blockEffects(*kids[i], effect);
+    }
+}
+
+/* Gathers the effects of the blocks on paths from
+ * the immediate dominator of a join to the join
+ */
+static void pathEffects(CfgBlock b, CfgBlock stop, BlockEffect *acc)
+{
+  int i;
+  if (b->mark || b == stop || b->rpo < 0)
+    return;
+  b->mark = TRUE;
+  for (i = 0; i < cfg->nVars; ++i)
+    acc->defs[i] |= effects[b->id].defs[i];
+  acc->clobbers |= effects[b->id].clobbers;
+  for (i = 0; i < b->nPreds; ++i)
+    pathEffects(b->preds[i], stop, acc);
+}
+
+/* Numbers block b, then the blocks it immediately
+ * dominates, starting from the values at the end of b
+ */
+static void vnBlock(CfgBlock b)
+{
+  int i, j, mark = nTable, savedMem;
+  int *saved;
+
+  for (i = 0; i < b->nItems; ++i)
+    {
+      vnExpr(cfgExprSlot(b->itemStmts[i]));
+      b->items[i] = *cfgExprSlot(b->itemStmts[i]);
+    }
+  if (b->term == CfgBranch)
+    {
+      vnExpr(cfgExprSlot(b->termStmt));
+      b->cond = *cfgExprSlot(b->termStmt);
+    }
+
+  MALLOC(saved, (cfg->nVars + 1) * sizeof(int));
+  memcpy(saved, varVn, cfg->nVars * sizeof(int));
+  savedMem = memVn;
+
+  for (i = 0; i < cfg->nBlocks; ++i)
+    {
+      CfgBlock c = cfg->blocks[i];
+      if (c->idom != b)
+        continue;
+
+      memcpy(varVn, saved, cfg->nVars * sizeof(int));
+      memVn = savedMem;
+      if (!(c->nPreds == 1 && c->preds[0] == b))
+        {
+          // values changed on any path into the join are unknown
+          BlockEffect acc;
+          MALLOC(acc.defs, cfg->nVars + 1);
+          memset(acc.defs, 0, cfg->nVars + 1);
+          acc.clobbers = FALSE;
+          for (j = 0; j < cfg->nBlocks; ++j)
+            cfg->blocks[j]->mark = FALSE;
+          for (j = 0; j < c->nPreds; ++j)
+            pathEffects(c->preds[j], b, &acc);
+          for (j = 0; j < cfg->nVars; ++j)
+            if (acc.defs[j])
+              varVn[j] = nextVn++;
+          if (acc.clobbers)
+            memVn = nextVn++;
+          free(acc.defs);
+        }
+      vnBlock(c);
+    }
+
+  free(saved);
+  nTable = mark;
+}
+
+/* Function valueNumbering replaces recomputed values
+ * of a function by temporaries
+ */
+int valueNumbering(TreeNode *f)
+{
+  int i;
+
+  func = f;
+  cfg = cfgBuild(func);
+  cfgDominators(cfg);
+  rewrites = 0;
+  nextVn = 1;
+  nTable = nLeaves = nSyms = 0;
+
+  MALLOC(effects, cfg->nBlocks * sizeof(BlockEffect));
+  for (i = 0; i < cfg->nBlocks; ++i)
+    {
+      CfgBlock b = cfg->blocks[i];
+      int k;
+      MALLOC(effects[i].defs, cfg->nVars + 1);
+      memset(effects[i].defs, 0, cfg->nVars + 1);
+      effects[i].clobbers = FALSE;
+      for (k = 0; k < b->nItems; ++k)
+        blockEffects(b->items[k], &effects[i]);
+      if (b->term == CfgBranch)
+        blockEffects(b->cond, &effects[i]);
+    }
+
+  // parameters and locals start out unrelated
+  MALLOC(varVn, (cfg->nVars + 1) * sizeof(int));
+  for (i = 0; i < cfg->nVars; ++i)
+    varVn[i] = nextVn++;
+  memVn = nextVn++;
+
+  vnBlock(cfg->blocks[0]);
+
+  for (i = 0; i < cfg->nBlocks; ++i)
+    free(effects[i].defs);
+  free(effects);
+  free(varVn);
+  free(table);
+  free(leaves);
+  free(syms);
+  table = leaves = NULL;
+  syms = NULL;
+  capTable = capLeaves = capSyms = 0;
+  cfgFree(cfg);
+  cfg = NULL;
+  func = NULL;
+
+  return rewrites;
+}
@@ -0,0 +1,20 @@
+/****************************************************/
+/* File: valnum.h                                   */
+/* Value numbering and common-subexpression         */
+/* elimination for the C- compiler                  */
+/****************************************************/
+
+#ifndef _VALNUM_H_
+#define _VALNUM_H_
+
+/* Function valueNumbering numbers the values a
+ * function computes, block by block down its
+ * dominator tree, and makes every arithmetic result,
+ * array address and array load computed again with
+ * the same operands (and no store in between) reuse
+ * the first result through a temporary. Returns the
+ * number of expressions replaced.
+ */
+int valueNumbering(TreeNode *func);
+
+#endif
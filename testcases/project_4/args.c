@@ -0,0 +1,76 @@
+/* calling convention: the first four arguments go in
+ * $a0-$a3 and the rest on the stack; calls nested in the
+ * arguments of another call, arrays, recursion that
+ * permutes its arguments and results in $v0.
+ * input: 1 2
+ */
+int g[10];
+
+int six(int a, int b, int c, int d, int e, int f)
+{
+  return a * 100000 + b * 10000 + c * 1000 + d * 100 + e * 10 + f;
+}
+
+int sum(int v[], int n)
+{
+  int i;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < n)
+    {
+      s = s + v[i];
+      i = i + 1;
+    }
+  return s;
+}
+
+int seven(int a, int b, int c, int d, int e, int f, int h)
+{
+  if (a > 3)
+    return b * 1000 + c * 100 + d * 10 + e + f * h;
+  return seven(a + 1, c, b, e, d, f + h, h - 1);
+}
+
+int five(int a, int b, int c, int d, int e)
+{
+  g[2] = g[2] + a + b + c + d + e;
+  if (a == 0)
+    return six(b, c, d, e, a, 9);
+  return five(a - 1, b + 1, c, d, e);
+}
+
+int order(int a, int b, int c)
+{
+  return a * 100 + b * 10 + c;
+}
+
+void main(void)
+{
+  int l[5];
+  int x;
+  int y;
+  int s;
+
+  x = input();
+  y = input();
+  l[0] = x;
+  l[1] = y;
+  l[2] = 3;
+  l[3] = 4;
+  l[4] = 5;
+  g[0] = 1;
+  g[1] = 2;
+  s = six(x, y, x + y, six(1, 2, 3, 4, 5, 6) / 100000, y - x, 7);
+  output(s); /* 123117 */
+  s = sum(l, 5);
+  output(s); /* 15 */
+  s = seven(x, 1, 2, 3, 4, 5, y);
+  output(s); /* 2135 */
+  s = five(3, x, y, 2, 1);
+  output(s); /* 422109 */
+  s = order(sum(l, 3), six(0, 0, 0, 0, y, x), sum(g, 2));
+  output(s); /* 813 */
+  output(g[2]); /* 36 */
+}
@@ -0,0 +1,61 @@
+/* bounds checks (compile with -fbounds-check): the checks
+ * of a loop index are hoisted out of the loop as one test
+ * of its first and last values; loops with calls keep
+ * theirs, and the last read is out of range, so the
+ * program stops with an error after the outputs.
+ * input: 10 12
+ */
+int g[12];
+
+int get(int a[], int i)
+{
+  return a[i];
+}
+
+int smooth(int a[], int n)
+{
+  int i;
+  int s;
+
+  i = 1;
+  s = 0;
+  while (i < n - 1)
+    {
+      s = s + a[i - 1] + a[i] * 2 + a[i + 1];
+      i = i + 1;
+    }
+  return s;
+}
+
+void main(void)
+{
+  int loc[10];
+  int i;
+  int n;
+  int s;
+
+  n = input();
+  i = 0;
+  while (i < n)
+    {
+      loc[i] = i * 3;
+      g[i + 2] = i;
+      i = i + 1;
+    }
+  s = smooth(loc, n);
+  output(s); /* 432 */
+  s = smooth(g, 12);
+  output(s); /* 145 */
+
+  i = 0;
+  s = 0;
+  while (i < 10)
+    {
+      s = s + get(loc, i) - g[i];
+      i = i + 1;
+    }
+  output(s); /* 107 */
+
+  n = input();
+  output(loc[n]); /* error: index out of bounds */
+}
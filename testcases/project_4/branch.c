@@ -0,0 +1,69 @@
+/* compare and branch: each relation branches directly on
+ * its operands, against zero, small and large constants,
+ * at the extremes of the range and as a value.
+ * input: 5 -3 -2147483648
+ */
+int classify(int a, int b)
+{
+  int s;
+
+  s = 0;
+  if (a < b)
+    s = s + 1;
+  if (a <= b)
+    s = s + 2;
+  if (a > b)
+    s = s + 4;
+  if (a >= b)
+    s = s + 8;
+  if (a == b)
+    s = s + 16;
+  if (a != b)
+    s = s + 32;
+  if (a < 0)
+    s = s + 64;
+  if (0 >= a)
+    s = s + 128;
+  if (a != 0)
+    s = s + 256;
+  if (a > 70000)
+    s = s + 512;
+  if (a <= 0 - 2147483647)
+    s = s + 1024;
+  return s;
+}
+
+void main(void)
+{
+  int a;
+  int b;
+  int c;
+  int n;
+  int s;
+
+  a = input();
+  b = input();
+  c = input();
+  s = classify(a, b);
+  output(s); /* 300 */
+  s = classify(b, a);
+  output(s); /* 483 */
+  s = classify(a, a);
+  output(s); /* 282 */
+  s = classify(c, a);
+  output(s); /* 1507 */
+  s = classify(100000, c);
+  output(s); /* 812 */
+  s = classify(0, 0);
+  output(s); /* 154 */
+  s = (a < b) + (a > b) * 2 + (c <= a) * 4 + (b == 0 - 3) * 8;
+  output(s); /* 14 */
+
+  n = 0;
+  while (a >= b)
+    {
+      a = a - 2;
+      n = n + 1;
+    }
+  output(n); /* 5 */
+}
@@ -0,0 +1,36 @@
+/* constants assigned to locals decide branches */
+int f(int x, int y)
+{
+  return x * 10 + y;
+}
+
+void main(void)
+{
+  int a;
+  int b;
+  int flag;
+
+  b = 5;
+  if (b > 3)
+    output(1);
+  else
+    output(2);
+
+  flag = 0;
+  while (flag)
+    {
+      output(999);
+      flag = flag - 1;
+    }
+
+  a = b * 2 + 1;
+  output(a); /* 11 */
+
+  flag = input();
+  if (flag)
+    b = 7;
+  else
+    b = 7;
+  output(b); /* 7 */
+  output(f(b, a)); /* 81 */
+}
@@ -0,0 +1,63 @@
+/* unreachable code, dead stores and dead pure
+ * computations go; calls and stores to globals stay.
+ * input: 5 6
+ */
+int g;
+
+int side(int x)
+{
+  g = g + x;
+  return x;
+}
+
+int early(int x)
+{
+  int y;
+  y = x * 2;
+  return y;
+  y = y + 1;
+  output(y);
+}
+
+void main(void)
+{
+  int a;
+  int b;
+  int c;
+  int i;
+  int s;
+  int unused;
+
+  a = input();
+  b = input();
+  unused = a * b;
+  c = b = side(a);
+  unused = side(5) + 1;
+  while (0)
+    {
+      output(99);
+    }
+
+  i = 0;
+  s = 0;
+  while (i < 10)
+    {
+      s = s + i;
+      a = s * 3;
+      i = i + 1;
+    }
+  output(s); /* 45 */
+  output(c); /* 5 */
+  output(g); /* 10 */
+  output(early(b)); /* 10 */
+
+  s = 7;
+  if (a > 0)
+    {
+    }
+  else
+    {
+    }
+  a = (b = 3) + (c = 4);
+  output(a); /* 7 */
+}
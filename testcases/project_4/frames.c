@@ -0,0 +1,97 @@
+/* prologues: a leaf sets up no frame, a function that
+ * calls on one path only sets up its frame on that path,
+ * and calls in return position jump to the callee unless
+ * it takes more than four arguments or a local array
+ * of the caller. The callers recurse on large values
+ * so that they are not inlined. input: 7
+ */
+int g[5];
+
+int leaf(int x, int y)
+{
+  return x * y - 1;
+}
+
+int early(int n)
+{
+  if (n < 3)
+    return n;
+  return early(n - 1) + early(n - 2);
+}
+
+int arrSum(int a[], int i, int n, int acc)
+{
+  if (i >= n)
+    return acc;
+  return arrSum(a, i + 1, n, acc + a[i]);
+}
+
+int helper(int x, int y)
+{
+  return x * 100 + y;
+}
+
+int wrap(int a, int b, int c)
+{
+  if (a > 1000)
+    return wrap(a - 1000, b, c) + 1;
+  return helper(c, a + b);
+}
+
+int useLocal(int n)
+{
+  int loc[3];
+
+  if (n > 1000)
+    return useLocal(n - 1000) + 1;
+  loc[0] = n;
+  loc[1] = n + 1;
+  loc[2] = n + 2;
+  return arrSum(loc, 0, 3, 0);
+}
+
+int passG(int x, int y, int z, int w)
+{
+  if (w > 1000)
+    return passG(x, y, z, w - 1000) + 1;
+  return arrSum(g, 0, 5, x + y + z + w);
+}
+
+int five(int a, int b, int c, int d, int e)
+{
+  return a + b * 2 + c * 3 + d * 4 + e * 5;
+}
+
+int toFive(int a, int b)
+{
+  if (a > 1000)
+    return toFive(a - 1000, b) + 1;
+  return five(b, a, b, a, 1);
+}
+
+void main(void)
+{
+  int i;
+  int n;
+  int s;
+
+  n = input();
+  i = 0;
+  while (i < 5)
+    {
+      g[i] = i * i;
+      i = i + 1;
+    }
+  s = leaf(n, 6);
+  output(s); /* 41 */
+  s = early(n);
+  output(s); /* 21 */
+  s = wrap(n + 1000, 2, 3);
+  output(s); /* 310 */
+  s = useLocal(n);
+  output(s); /* 24 */
+  s = passG(1, 2, 3, n);
+  output(s); /* 43 */
+  s = toFive(n, 10);
+  output(s); /* 87 */
+}
@@ -0,0 +1,137 @@
+/* loop fusion and fission: adjacent loops over the same
+ * range are merged unless one reads an element the other
+ * has not written yet, or needs a total the other one
+ * computes; a long body that touches independent arrays
+ * is split in two. input: 20
+ */
+int a[50];
+int b[50];
+int c[50];
+
+int check(int x[], int m)
+{
+  int i;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < m)
+    {
+      s = s + x[i] * (i + 1);
+      i = i + 1;
+    }
+  return s;
+}
+
+void main(void)
+{
+  int i;
+  int j;
+  int k;
+  int n;
+  int s;
+  int t;
+
+  n = input();
+
+  i = 0;
+  while (i < n)
+    {
+      a[i] = i * 2 + 1;
+      i = i + 1;
+    }
+  i = 0;
+  while (i < n)
+    {
+      b[i] = a[i] * 3;
+      i = i + 1;
+    }
+  s = 0;
+  j = 0;
+  while (j < n)
+    {
+      s = s + b[j];
+      j = j + 1;
+    }
+  output(s); /* 1200 */
+  output(i); /* 20 */
+  output(j); /* 20 */
+
+  i = 0;
+  while (i < n)
+    {
+      a[i] = a[i] + 5;
+      i = i + 1;
+    }
+  i = 0;
+  while (i < n)
+    {
+      c[i] = a[i + 1];
+      i = i + 1;
+    }
+  s = check(c, n);
+  output(s); /* 6080 */
+
+  i = 1;
+  while (i < n)
+    {
+      a[i] = i;
+      i = i + 1;
+    }
+  i = 1;
+  while (i < n)
+    {
+      c[i] = a[i - 1] + 7;
+      i = i + 1;
+    }
+  s = check(c, n);
+  output(s); /* 3934 */
+
+  t = 0;
+  i = 0;
+  while (i < n)
+    {
+      t = t + a[i];
+      i = i + 1;
+    }
+  i = 0;
+  while (i < n)
+    {
+      b[i] = t;
+      i = i + 1;
+    }
+  s = check(b, n);
+  output(s); /* 41160 */
+
+  i = 0;
+  while (i < n)
+    {
+      a[i] = a[i] * 3 + b[i] * 5 - c[i] / 2 + (i * i - 7) * (i + 3) - (i + 1) * (i + 2);
+      b[i] = b[i] * 7 - c[i] * 3 + (i * 11 - 5) * (i + 9) - (i + 4) * (i - 6) + a[i];
+      c[i] = (c[i] + 1) * (c[i] - 1) + i * i * i - (i + 13) * 17 + (i - 2) * (i + 8);
+      k = (i * 5 + 3) * (i - 1) + (i + 7) * (i * 2 - 9) - (i + 11) * 4 + i / 3;
+      c[i + 1] = k;
+      i = i + 1;
+    }
+  s = check(a, n);
+  output(s); /* 753552 */
+  s = check(b, n);
+  output(s); /* 1049732 */
+  s = check(c, n + 1);
+  output(s); /* 315848040 */
+
+  i = 0;
+  while (i < n)
+    {
+      a[i] = b[i] / 3 + c[i] / 5 - 7 + i;
+      b[i] = a[i + 1] / 2 + i * 4 - c[i] / 9;
+      c[i] = c[i] / 3 + i - b[i] / 2;
+      i = i + 1;
+    }
+  s = check(a, n);
+  output(s); /* 63510453 */
+  s = check(b, n);
+  output(s); /* -34727438 */
+  s = check(c, n);
+  output(s); /* 122632134 */
+}
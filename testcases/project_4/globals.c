@@ -0,0 +1,58 @@
+/* global data: scalars and the most used arrays go in
+ * the area addressed from $gp; arrays that do not fit
+ * its 64K bytes get their own labels. Arrays of either
+ * kind are indexed by constants and variables and passed
+ * to functions. input: 7
+ */
+int big[20000];
+int x;
+int small[4];
+int huge[10000];
+
+int sum(int a[], int lo, int hi)
+{
+  int s;
+
+  s = 0;
+  while (lo < hi)
+    {
+      s = s + a[lo];
+      lo = lo + 1;
+    }
+  return s;
+}
+
+void put(int a[], int i, int v)
+{
+  a[i] = v;
+}
+
+void main(void)
+{
+  int i;
+  int s;
+
+  i = 0;
+  while (i < 20000)
+    {
+      big[i] = i;
+      i = i + 1;
+    }
+  x = input();
+  small[2] = x;
+  huge[9999] = small[2] + big[x];
+  huge[x] = 5;
+  s = huge[9999] + huge[x] + big[19999];
+  output(s); /* 20018 */
+  put(huge, 9998, x * 3);
+  put(small, 3, x + 1);
+  put(big, 0, 0 - 1);
+  s = sum(huge, 9990, 10000);
+  output(s); /* 35 */
+  s = sum(small, 0, 4);
+  output(s); /* 15 */
+  s = sum(big, 0, 10);
+  output(s); /* 44 */
+  s = sum(big, 19990, 20000);
+  output(s); /* 199945 */
+}
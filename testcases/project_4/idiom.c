@@ -0,0 +1,117 @@
+/* loop idioms: fill and copy loops become calls to the
+ * runtime helpers; a copy whose source is the element
+ * just stored, a loop that never runs and the index left
+ * after the loop stay correct. input: 25
+ */
+int g[40];
+int h[40];
+
+void clear(int a[], int m)
+{
+  int i;
+
+  i = 0;
+  while (i < m)
+    {
+      a[i] = 0;
+      i = i + 1;
+    }
+}
+
+void shift(int a[], int m)
+{
+  int i;
+
+  i = 1;
+  while (i < m)
+    {
+      a[i] = a[i - 1];
+      i = i + 1;
+    }
+}
+
+int sum(int a[], int m)
+{
+  int i;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < m)
+    {
+      s = s + a[i];
+      i = i + 1;
+    }
+  return s;
+}
+
+void main(void)
+{
+  int loc[30];
+  int i;
+  int j;
+  int n;
+  int v;
+  int s;
+
+  n = input();
+  v = n * 3;
+  i = 0;
+  while (i < n)
+    {
+      g[i] = i * i;
+      i = i + 1;
+    }
+  i = 0;
+  while (i < n)
+    {
+      h[i] = v + 1;
+      i = i + 1;
+    }
+  s = sum(h, n);
+  output(s); /* 1900 */
+
+  i = 2;
+  while (i <= n)
+    {
+      loc[i - 2] = g[i];
+      i = i + 1;
+    }
+  output(i); /* 26 */
+  s = sum(loc, n - 1);
+  output(s); /* 4899 */
+
+  shift(g, n);
+  s = sum(g, n);
+  output(s); /* 0 */
+  clear(g, n);
+  s = sum(g, 40);
+  output(s); /* 0 */
+
+  j = 5;
+  while (j < 3)
+    {
+      g[j] = 7;
+      j = j + 1;
+    }
+  output(j); /* 5 */
+
+  i = 0;
+  while (i < 30)
+    {
+      loc[i] = n;
+      i = i + 1;
+    }
+  s = sum(loc, 30);
+  output(s); /* 750 */
+
+  i = 3;
+  while (n > i)
+    {
+      h[i + 1] = h[i];
+      i = i + 1;
+    }
+  s = sum(h, 40);
+  output(s); /* 1976 */
+  output(i); /* 25 */
+}
@@ -0,0 +1,82 @@
+/* if-conversion: short assignments on both sides of a
+ * test become a select without a branch; a side that
+ * divides by zero, loads an element or calls keeps its
+ * branch, as it must not run when not taken.
+ * input: 0 5 7 -4
+ */
+int a[4];
+
+int maxOf(int x, int y)
+{
+  int m;
+
+  if (x > y)
+    m = x;
+  else
+    m = y;
+  return m;
+}
+
+int absOf(int x)
+{
+  if (x < 0)
+    x = 0 - x;
+  return x;
+}
+
+int clamp(int x, int lo, int hi)
+{
+  if (x < lo)
+    x = lo;
+  if (x > hi)
+    x = hi;
+  return x;
+}
+
+int pick(int c, int i)
+{
+  int x;
+
+  if (c)
+    x = a[i];
+  else
+    x = 0 - 1;
+  return x;
+}
+
+void main(void)
+{
+  int c;
+  int x;
+  int y;
+  int z;
+  int s;
+
+  c = input();
+  y = input();
+  if (c)
+    x = y / 0;
+  else
+    x = 1;
+  output(x); /* 1 */
+  if (c)
+    x = y / c;
+  else
+    x = y / 5;
+  output(x); /* 1 */
+
+  z = input();
+  s = maxOf(y, z);
+  output(s); /* 7 */
+  s = maxOf(z, y);
+  output(s); /* 7 */
+  z = input();
+  s = absOf(z);
+  output(s); /* 4 */
+  s = clamp(z, 0 - 3, 5);
+  output(s); /* -3 */
+  s = clamp(y * 2, 0 - 3, 5);
+  output(s); /* 5 */
+  s = pick(c, 100000);
+  output(s); /* -1 */
+}
@@ -0,0 +1,120 @@
+/* induction variables: array walks step pointers
+ * instead of scaling indexes, forwards, backwards, by
+ * two and in nested loops. find is called with a bound
+ * far beyond its array and returns inside it: the end
+ * address of the bound must not replace the counter.
+ * An array declared in a block of the loop body is not
+ * in scope before the loop and keeps its indexes.
+ */
+int g[20];
+
+int back(int a[], int n)
+{
+  int i;
+  int s;
+
+  s = 0;
+  i = n - 1;
+  while (i >= 1)
+    {
+      s = s + a[i] - a[i - 1];
+      i = i - 1;
+    }
+  return s;
+}
+
+int after(int n)
+{
+  int i;
+
+  i = 0;
+  while (n > i)
+    {
+      g[i + 1] = g[i] + 1;
+      i = i + 2;
+    }
+  return i;
+}
+
+int find(int a[], int n, int x)
+{
+  int i;
+
+  i = 0;
+  while (i < n)
+    {
+      if (a[i] == x)
+        return 77;
+      i = i + 1;
+    }
+  return 0 - 1;
+}
+
+void main(void)
+{
+  int a[20];
+  int b[10];
+  int i;
+  int j;
+
+  i = 0;
+  while (i < 20)
+    {
+      a[i] = i * 3 + 1;
+      g[i] = 0;
+      i = i + 1;
+    }
+  output(back(a, 10)); /* 27 */
+  output(after(9)); /* 10 */
+  output(g[9]); /* 1 */
+
+  i = 0;
+  while (i < 10)
+    {
+      b[i] = i * 3;
+      i = i + 1;
+    }
+  output(find(b, 100000, 9)); /* 77 */
+  output(find(b, 10, 8)); /* -1 */
+
+  i = 0;
+  while (i < 4)
+    {
+      j = 0;
+      while (j < 4)
+        {
+          a[i * 4 + j] = a[j] + i;
+          j = j + 1;
+        }
+      i = i + 1;
+    }
+  i = 0;
+  while (i < 16)
+    {
+      output(a[i]);
+      i = i + 4;
+    }
+  /* 1 2 3 4 */
+
+  i = 0;
+  while (i < 4)
+    {
+      {
+        int t[4];
+
+        t[0] = 10;
+        t[1] = 20;
+        t[2] = 30;
+        t[3] = 40;
+        g[i + 1] = t[i];
+      }
+      i = i + 1;
+    }
+  i = 1;
+  while (i <= 4)
+    {
+      output(g[i]);
+      i = i + 1;
+    }
+  /* 10 20 30 40 */
+}
@@ -0,0 +1,108 @@
+/* small functions are inlined into their callers: early
+ * returns, array parameters and globals the callee
+ * changes between two reads in the caller. input: 10
+ */
+int g;
+int garr[10];
+
+int get(int a[], int i)
+{
+  return a[i];
+}
+
+void put(int a[], int i, int v)
+{
+  a[i] = v;
+}
+
+int bump(void)
+{
+  g = g + 1;
+  return g;
+}
+
+int maxOf(int a, int b)
+{
+  if (a > b)
+    return a;
+  return b;
+}
+
+int sign(int x)
+{
+  if (x < 0)
+    return 0 - 1;
+  else if (x == 0)
+    return 0;
+  return 1;
+}
+
+void early(int x)
+{
+  if (x > 3)
+    {
+      output(x);
+      return;
+    }
+  output(0 - x);
+}
+
+int sumArr(int a[], int n)
+{
+  int i;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < n)
+    {
+      s = s + get(a, i);
+      i = i + 1;
+    }
+  return s;
+}
+
+void fill(int a[], int n, int v)
+{
+  int i;
+
+  i = 0;
+  while (i < n)
+    {
+      put(a, i, v + i);
+      i = i + 1;
+    }
+}
+
+void main(void)
+{
+  int loc[10];
+  int i;
+  int x;
+
+  fill(loc, 10, input());
+  fill(garr, 10, 3);
+  output(sumArr(loc, 10)); /* 145 */
+  output(sumArr(garr, 5)); /* 25 */
+
+  g = 5;
+  x = g + bump();
+  output(x); /* 11 */
+  x = bump() + g;
+  output(x); /* 14 */
+
+  i = 0;
+  while (i < 6)
+    {
+      output(maxOf(i, 3) * sign(i - 2));
+      early(i);
+      i = i + 1;
+    }
+  /* -3 0 -3 -1 0 -2 3 -3 4 4 5 5 */
+
+  if (maxOf(get(loc, 2), get(garr, 9)) > 12)
+    output(1);
+  else
+    output(2); /* 2 */
+  output(get(loc, get(garr, 0) - 2)); /* 11 */
+}
@@ -0,0 +1,34 @@
+/* interprocedural constants: f(3, 5) in a loop is
+ * specialized; the clone's own recursive call has other
+ * arguments and must still call f. input: 2
+ */
+int f(int n, int k)
+{
+  if (n == 0)
+    return k;
+  output(n);
+  return f(n - 1, k + 1);
+}
+
+int scale(int x, int by)
+{
+  return x * by;
+}
+
+void main(void)
+{
+  int i;
+  int r;
+
+  i = 0;
+  while (i < 2)
+    {
+      r = f(3, 5); /* 3 2 1 */
+      output(r); /* 8 */
+      i = i + 1;
+    }
+  r = f(input(), 7); /* 2 1 */
+  output(r); /* 9 */
+
+  output(scale(4, 3) + scale(5, 3)); /* 27 */
+}
@@ -0,0 +1,77 @@
+/* loop-invariant code motion: invariant arithmetic and
+ * loads of arrays the loop does not store to move out
+ * of the loop; loops that never run, a divisor that is
+ * only safe inside the loop and loads of arrays the loop
+ * stores to stay correct
+ */
+int g[10];
+
+int sum(int a[], int n, int k)
+{
+  int i;
+  int t;
+
+  i = 0;
+  t = 0;
+  while (i < n)
+    {
+      t = t + a[i] * (k * 3 + 1) + g[k];
+      i = i + 1;
+    }
+  return t;
+}
+
+int nested(int n, int m)
+{
+  int i;
+  int j;
+  int t;
+
+  i = 0;
+  t = 0;
+  while (i < n)
+    {
+      j = 0;
+      while (j < m)
+        {
+          t = t + (n * m) + i * 2 + g[j] / (m - 1);
+          j = j + 1;
+        }
+      i = i + 1;
+    }
+  return t;
+}
+
+int stores(int a[], int n)
+{
+  int i;
+
+  i = 0;
+  while (i < n)
+    {
+      g[i] = a[0] + 1;
+      a[i] = g[1] + i;
+      i = i + 1;
+    }
+  return a[n - 1];
+}
+
+void main(void)
+{
+  int a[10];
+  int i;
+
+  i = 0;
+  while (i < 10)
+    {
+      a[i] = i * i;
+      g[i] = i + 2;
+      i = i + 1;
+    }
+  output(sum(a, 10, 2)); /* 2035 */
+  output(sum(a, 0, 100)); /* 0 */
+  output(nested(4, 3)); /* 196 */
+  output(nested(0, 1)); /* 0 */
+  output(stores(a, 5)); /* 8 */
+  output(stores(g, 4)); /* 9 */
+}
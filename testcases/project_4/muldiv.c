@@ -0,0 +1,42 @@
+/* multiplication and division by constants: products
+ * become shifts and adds, quotients a multiply by the
+ * reciprocal and a shift, rounding toward zero for
+ * negative values and divisors too.
+ * input: 123456789 -987654321 2147483647 -2147483648
+ * output, one line per input:
+ *   41152263 17636684 12345678 192600 7716049 -15432098
+ *     -123456 0 864197523 -740740734 -1332004360 -730804971
+ *   -329218107 -141093474 -98765432 -1540802 -61728395 123456790
+ *     987654 0 1676354345 1630958630 2066100072 1550882639
+ *   715827882 306783378 214748364 3350208 134217727 -268435455
+ *     -2147483 1 2147483641 6 -24 2147418111
+ *   -715827882 -306783378 -214748364 -3350208 -134217728 268435456
+ *     2147483 -1 -2147483648 0 0 -2147483648
+ */
+void check(int v)
+{
+  output(v / 3);
+  output(v / 7);
+  output(v / 10);
+  output(v / 641);
+  output(v / 16);
+  output(v / (0 - 8));
+  output(v / (0 - 1000));
+  output(v / 2147483647);
+  output(v * 7);
+  output(v * (0 - 6));
+  output(v * 24);
+  output(v * 65537);
+}
+
+void main(void)
+{
+  int i;
+
+  i = 0;
+  while (i < 4)
+    {
+      check(input());
+      i = i + 1;
+    }
+}
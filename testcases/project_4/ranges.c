@@ -0,0 +1,102 @@
+/* value ranges: tests decided by the range of a loop
+ * index or of a clamped value are folded, divisions of
+ * values known to be non-negative become shifts, and
+ * negative values still round toward zero.
+ * input: 3 10 400 -33 4
+ */
+int tab[16];
+
+int clampSum(int n)
+{
+  int i;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < 16)
+    {
+      if (i < 20)
+        s = s + tab[i] / 4;
+      else
+        s = s - 1000;
+      if (i >= 0)
+        s = s + i / 2;
+      i = i + 1;
+    }
+  if (i == 16)
+    s = s + 1;
+  return s;
+}
+
+int mid(int lo, int hi)
+{
+  if (lo < 0)
+    lo = 0;
+  if (hi < lo)
+    hi = lo;
+  if (hi > 1000)
+    hi = 1000;
+  return (lo + hi) / 2;
+}
+
+int neg(int x)
+{
+  int q;
+
+  q = x / 8;
+  if (x > 5)
+    {
+      if (x < 3)
+        q = 99;
+    }
+  return q;
+}
+
+int walk(int k)
+{
+  int j;
+  int t;
+
+  t = 0;
+  j = k;
+  tab[j] = 7;
+  if (j < 16)
+    t = t + 1;
+  if (j >= 0)
+    t = t + 1;
+  j = 15;
+  while (j > 0)
+    {
+      t = t + tab[j] / 2 + j / 4;
+      j = j - 1;
+    }
+  if (j == 0)
+    t = t + 100;
+  return t;
+}
+
+void main(void)
+{
+  int i;
+  int n;
+  int s;
+
+  n = input();
+  i = 0;
+  while (i < 16)
+    {
+      tab[i] = i * n - 40;
+      i = i + 1;
+    }
+  s = clampSum(n);
+  output(s); /* -9 */
+  i = input();
+  n = input();
+  output(mid(i, n)); /* 205 */
+  output(mid(0 - 5, 7)); /* 3 */
+  i = input();
+  output(neg(i)); /* -4 */
+  output(neg(0 - 17)); /* -2 */
+  i = input();
+  output(walk(i)); /* 26 */
+}
@@ -0,0 +1,37 @@
+/* reassociation: sums and products with constants are
+ * regrouped so the constants fold; a sum whose regrouped
+ * form overflows in between still gives the value of the
+ * source order, as additions wrap rather than trap.
+ * input: 2147483647 1 1 6
+ */
+int three(int x)
+{
+  return x + 1 + 1 + 1;
+}
+
+int mix(int x, int y)
+{
+  return (x + 4) - (y - 7) + (x * 2 + 3) * 4 - 10;
+}
+
+void main(void)
+{
+  int a;
+  int b;
+  int c;
+  int d;
+  int s;
+
+  a = input();
+  b = input();
+  c = input();
+  d = input();
+  s = a - b + c;
+  output(s); /* 2147483647 */
+  s = three(d);
+  output(s); /* 9 */
+  s = mix(d, b);
+  output(s); /* 66 */
+  s = (d * 3) * 5 + 2 * d * 7;
+  output(s); /* 174 */
+}
@@ -0,0 +1,116 @@
+/* register allocation: more values live across calls than
+ * there are $s registers, so some stay in $t registers
+ * saved around each call and the rest are spilled to the
+ * frame; all of them are printed at the end. The spilled
+ * ones read several times in one block are kept in a free
+ * register there rather than loaded at each read.
+ * input: 7 3
+ */
+int g;
+
+int f(int x)
+{
+  g = g + x;
+  return x * 3 + 1;
+}
+
+int h(int a, int b, int c, int d, int e)
+{
+  return a - b + c * d - e;
+}
+
+void main(void)
+{
+  int arr[10];
+  int a;
+  int b;
+  int c;
+  int d;
+  int e;
+  int ff;
+  int gg;
+  int hh;
+  int i;
+  int j;
+  int k;
+  int l;
+  int m;
+  int n;
+  int o;
+  int p;
+  int q;
+  int r;
+  int s;
+  int t;
+  int u;
+  int v;
+  int w;
+  int x;
+  int y;
+  int z;
+  int it;
+  int mix;
+
+  a = input();
+  b = input();
+  c = a + b;
+  d = a - b;
+  e = a * b;
+  ff = c + d;
+  gg = c - e;
+  hh = d * 2;
+  i = f(a);
+  j = f(b) + i;
+  k = c + j;
+  l = d + k;
+  m = e + l;
+  n = ff + m;
+  o = gg + n;
+  p = hh + o;
+  q = i + p;
+  r = j + q;
+  s = k + r;
+  t = l + s;
+  u = f(t);
+  v = u + m;
+  w = v + n;
+  x = w + o;
+  y = x + p;
+  z = y + q;
+  mix = (z - y) * (z - x) + (z + y) * z - y * x + (x - w) * z;
+  it = 0;
+  while (it < 10)
+    {
+      arr[it] = h(it, a, b, c, d) + f(it);
+      it = it + 1;
+    }
+  output(a); /* 7 */
+  output(b); /* 3 */
+  output(c); /* 10 */
+  output(d); /* 4 */
+  output(e); /* 21 */
+  output(ff); /* 14 */
+  output(gg); /* -11 */
+  output(hh); /* 8 */
+  output(i); /* 22 */
+  output(j); /* 32 */
+  output(k); /* 42 */
+  output(l); /* 46 */
+  output(m); /* 67 */
+  output(n); /* 81 */
+  output(o); /* 70 */
+  output(p); /* 78 */
+  output(q); /* 100 */
+  output(r); /* 132 */
+  output(s); /* 174 */
+  output(t); /* 220 */
+  output(u); /* 661 */
+  output(v); /* 728 */
+  output(w); /* 809 */
+  output(x); /* 879 */
+  output(y); /* 957 */
+  output(z); /* 1057 */
+  output(mix); /* 1379385 */
+  output(g); /* 275 */
+  output(arr[3] + arr[9]); /* 88 */
+}
@@ -0,0 +1,70 @@
+/* frame layout: arrays of sibling scopes share frame
+ * space, nested scopes do not; the outgoing arguments of
+ * a call and of the calls nested in them share one area
+ * at the bottom of a frame that is set up once.
+ * input: 4 -2
+ */
+int g(int a, int b, int c, int d, int e, int f)
+{
+  if (a > 1000)
+    return g(a - 1000, b, c, d, e, f) + 1;
+  return a + b * 2 + c * 3 + d * 4 + e * 5 + f * 6;
+}
+
+int scopes(int x)
+{
+  int i;
+  int s;
+
+  s = 0;
+  if (x > 0)
+    {
+      int a[5];
+
+      i = 0;
+      while (i < 5)
+        {
+          a[i] = i + x;
+          i = i + 1;
+        }
+      s = a[4] + g(a[0], a[1], a[2], a[3], a[4], x);
+    }
+  else
+    {
+      int b[3];
+
+      b[0] = 7;
+      b[2] = x;
+      s = b[0] + b[2];
+    }
+  {
+    int c[4];
+
+    c[3] = x;
+    {
+      int d[2];
+
+      d[1] = c[3] + 1;
+      s = s * 10 + d[1] + c[3];
+    }
+  }
+  return s;
+}
+
+void main(void)
+{
+  int x;
+  int y;
+  int s;
+
+  x = input();
+  y = input();
+  s = scopes(x);
+  output(s); /* 1329 */
+  s = scopes(y);
+  output(s); /* 47 */
+  s = g(1, 2, 3, 4, g(x, 1, 1, 1, 1, 1), g(2, 2, 2, 2, 2, y));
+  output(s); /* 258 */
+  s = g(g(1001, 0, 0, 0, 0, y), 0, 0, 0, 0, 0) + g(0, 0, 0, 0, 0, x);
+  output(s); /* 14 */
+}
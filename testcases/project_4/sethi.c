@@ -0,0 +1,44 @@
+/* evaluation order: deep right-leaning expressions need
+ * the side that uses more registers evaluated first; an
+ * operand that calls a function keeps its left-to-right
+ * order with the other side. input: 3 -7 11 2 5 -1 9 4 6 8
+ */
+int a[10];
+int cnt;
+
+int next(void)
+{
+  cnt = cnt + 1;
+  return cnt;
+}
+
+int score(int k)
+{
+  return a[0] * a[1] - (a[2] * a[3] - (a[4] * a[5] - (a[6] * a[7] - (a[8] * a[9]
+    - (a[0] * a[1] - (a[2] * a[3] - (a[4] * a[5] - (a[6] * a[7] - (a[8] * a[9]
+    - (a[0] * a[1] - (a[2] * a[3] - (a[4] * a[5] - (a[6] * a[7] - (a[8] * a[9]
+    - (a[0] * a[1] - (a[2] * a[3] - (a[4] * a[5] - (a[6] * a[7] - (a[8] * a[9]
+    - (a[0] * a[1] - (a[2] * a[3] - (a[4] * a[5] - (a[6] * a[7] - (a[8] * a[9]
+    - (a[0] * a[1]))))))))))))))))))))))))) + k;
+}
+
+void main(void)
+{
+  int i;
+  int s;
+
+  i = 0;
+  while (i < 10)
+    {
+      a[i] = input();
+      i = i + 1;
+    }
+  s = score(3);
+  output(s); /* -12 */
+  s = (a[1] + a[2]) * ((a[3] + a[4]) * ((a[5] - a[6]) * (a[7] + a[8] * a[9])));
+  output(s); /* -14560 */
+  s = next() - (a[0] * (a[1] + a[2] * (a[3] - next())));
+  output(s); /* 22 */
+  s = next() * 10 + next();
+  output(s); /* 34 */
+}
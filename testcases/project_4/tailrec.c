@@ -0,0 +1,88 @@
+/* tail recursion becomes a loop, and other tail calls
+ * reuse the caller's frame: parameters swapped, read by
+ * later arguments, arrays passed through and a local
+ * array passed on. input: 36
+ */
+int g[5];
+
+int gcd(int a, int b)
+{
+  if (b == 0)
+    return a;
+  return gcd(b, a - (a / b) * b);
+}
+
+int sumTo(int n, int acc)
+{
+  if (n == 0)
+    return acc;
+  return sumTo(n - 1, acc + n);
+}
+
+void countDown(int n)
+{
+  if (n < 0)
+    return;
+  if (n - (n / 3) * 3 == 0)
+    output(n);
+  countDown(n - 1);
+}
+
+int arrSum(int a[], int i, int n, int acc)
+{
+  if (i >= n)
+    return acc;
+  return arrSum(a, i + 1, n, acc + a[i]);
+}
+
+int helper(int x, int y)
+{
+  output(x);
+  output(y);
+  return x * 100 + y;
+}
+
+int wrap(int a, int b, int c)
+{
+  return helper(c, a + b);
+}
+
+int useLocal(int n)
+{
+  int loc[3];
+  loc[0] = n;
+  loc[1] = n + 1;
+  loc[2] = n + 2;
+  return arrSum(loc, 0, 3, 0);
+}
+
+int collatz(int n, int steps)
+{
+  if (n == 1)
+    return steps;
+  if (n - (n / 2) * 2 == 0)
+    return collatz(n / 2, steps + 1);
+  return collatz(3 * n + 1, steps + 1);
+}
+
+void main(void)
+{
+  int i;
+
+  i = input();
+  output(gcd(i, 84)); /* 12 */
+  output(sumTo(20000, 0)); /* 200010000 */
+  countDown(10); /* 9 6 3 0 */
+
+  i = 0;
+  while (i < 5)
+    {
+      g[i] = i * i;
+      i = i + 1;
+    }
+  output(arrSum(g, 0, 5, 0)); /* 30 */
+  i = wrap(1, 2, 3); /* 3 3 */
+  output(i); /* 303 */
+  output(useLocal(4)); /* 15 */
+  output(collatz(27, 0)); /* 111 */
+}
@@ -0,0 +1,139 @@
+/* counted loops are unrolled with a remainder loop for
+ * the last iterations, and loops with a small constant
+ * trip count fully. The walk over arr in main steps a
+ * pointer that ends right below the top of the stack;
+ * upTo and downTo count to the ends of the int range,
+ * where the index a few steps on would overflow.
+ * input: 2147483641 2147483647
+ */
+int g[12];
+
+int sum(int a[], int n)
+{
+  int i;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < n)
+    {
+      s = s + a[i] * i;
+      i = i + 1;
+    }
+  return s;
+}
+
+int down(int n)
+{
+  int i;
+  int s;
+
+  s = 0;
+  i = n;
+  while (0 < i)
+    {
+      s = s * 2 + g[i];
+      i = i - 2;
+    }
+  return s + i;
+}
+
+int small(void)
+{
+  int i;
+  int s;
+  int t[4];
+
+  i = 0;
+  s = 1;
+  while (i < 4)
+    {
+      t[i] = s;
+      s = s * 3;
+      i = i + 1;
+    }
+  return t[0] + t[1] + t[2] + t[3] + i;
+}
+
+int upTo(int i, int n)
+{
+  int s;
+
+  s = 0;
+  while (i < n)
+    {
+      s = s + 1;
+      i = i + 1;
+    }
+  return s;
+}
+
+int downTo(int i, int n)
+{
+  int s;
+
+  s = 0;
+  while (i > n)
+    {
+      s = s + 1;
+      i = i - 1;
+    }
+  return s;
+}
+
+void main(void)
+{
+  int arr[20];
+  int i;
+  int j;
+  int n;
+  int s;
+
+  i = 0;
+  while (i < 12)
+    {
+      g[i] = i + 1;
+      i = i + 1;
+    }
+  i = 0;
+  while (i <= 9)
+    {
+      output(sum(g, i));
+      i = i + 1;
+    }
+  /* 0 0 2 8 20 40 70 112 168 240 */
+  output(down(11)); /* 641 */
+  output(down(7)); /* 97 */
+  output(down(0)); /* 0 */
+  output(small()); /* 44 */
+
+  i = 0;
+  while (i < 20)
+    {
+      arr[i] = i * i;
+      i = i + 1;
+    }
+  i = 0;
+  s = 0;
+  while (i < 20)
+    {
+      s = s + arr[i];
+      i = i + 1;
+    }
+  output(s); /* 2470 */
+
+  i = input();
+  n = input();
+  s = upTo(i, n);
+  output(s); /* 6 */
+  s = downTo(0 - i - 1, 0 - n - 1);
+  output(s); /* 6 */
+  j = i;
+  s = 0;
+  while (j < 2147483647)
+    {
+      s = s + 2;
+      j = j + 1;
+    }
+  output(s); /* 12 */
+}
@@ -0,0 +1,30 @@
+/* main makes no calls, so it saves nothing and its
+ * array ends right below the top of the stack; the
+ * pointers that walk it must not wrap around at the top
+ * when the loops are unrolled. input: 19
+ */
+void main(void)
+{
+  int arr[19];
+  int i;
+  int n;
+  int s;
+
+  n = input();
+  i = 0;
+  while (i < 19)
+    {
+      arr[i] = i * i;
+      i = i + 1;
+    }
+  output(arr[n - 1]); /* 324 */
+
+  i = 0;
+  s = 0;
+  while (i < 19)
+    {
+      s = s + arr[i];
+      i = i + 1;
+    }
+  output(s); /* 2109 */
+}
@@ -0,0 +1,150 @@
+/* loop unswitching: conditions on values the loop does not
+ * change are tested once outside the loop; conditions on
+ * globals a call may change, or on locals the loop
+ * assigns, stay inside it. input: 12
+ */
+int mode;
+int cnt;
+int a[20];
+
+void bump(void)
+{
+  cnt = cnt + 1;
+}
+
+void flip(void)
+{
+  mode = 1 - mode;
+}
+
+int sumMode(int n, int m)
+{
+  int i;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < n)
+    {
+      if (m > 2)
+        s = s + a[i] * 2;
+      else
+        s = s - a[i];
+      i = i + 1;
+    }
+  return s;
+}
+
+int globalMode(int n)
+{
+  int i;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < n)
+    {
+      bump();
+      if (mode)
+        s = s + a[i];
+      i = i + 1;
+    }
+  return s;
+}
+
+int flipped(int n)
+{
+  int i;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < n)
+    {
+      if (mode)
+        s = s + a[i];
+      else
+        s = s + 100;
+      flip();
+      i = i + 1;
+    }
+  return s;
+}
+
+int nested(int n, int p, int q)
+{
+  int i;
+  int j;
+  int s;
+
+  i = 0;
+  s = 0;
+  while (i < n)
+    {
+      j = 0;
+      while (j < n)
+        {
+          if (p)
+            {
+              if (q < 3)
+                s = s + i;
+              else
+                s = s + j;
+            }
+          j = j + 1;
+        }
+      if (q == 5)
+        s = s * 2;
+      i = i + 1;
+    }
+  return s;
+}
+
+int changes(int n)
+{
+  int i;
+  int k;
+  int s;
+
+  i = 0;
+  k = 0;
+  s = 0;
+  while (i < n)
+    {
+      if (k)
+        s = s + 1;
+      else
+        s = s + 10;
+      if (i == 3)
+        k = 1;
+      i = i + 1;
+    }
+  return s;
+}
+
+void main(void)
+{
+  int i;
+  int n;
+
+  n = input();
+  i = 0;
+  while (i < 20)
+    {
+      a[i] = i * 3 - 7;
+      i = i + 1;
+    }
+  output(sumMode(n, 3)); /* 228 */
+  output(sumMode(n, 1)); /* -114 */
+  mode = 1;
+  output(globalMode(n)); /* 114 */
+  mode = 0;
+  output(globalMode(n)); /* 0 */
+  output(cnt); /* 24 */
+  mode = 1;
+  output(flipped(n)); /* 648 */
+  output(nested(n, 1, 2)); /* 792 */
+  output(nested(n, 1, 5)); /* 540540 */
+  output(nested(n, 0, 5)); /* 0 */
+  output(changes(n)); /* 48 */
+}
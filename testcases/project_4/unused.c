@@ -0,0 +1,55 @@
+/* functions and globals main cannot reach are removed,
+ * also when they only call or use each other; those
+ * reached through other functions stay. input: 4
+ */
+int used;
+int deadScalar;
+int deadArr[100];
+int table[8];
+
+int deadLeaf(int x)
+{
+  deadScalar = x;
+  return x * 2;
+}
+
+int deadCaller(int x)
+{
+  deadArr[x] = deadLeaf(x);
+  return deadArr[x];
+}
+
+int deadRec(int n)
+{
+  if (n == 0)
+    return 0;
+  return deadRec(n - 1) + deadCaller(n);
+}
+
+int fill(int n)
+{
+  int i;
+  i = 0;
+  while (i < 8)
+    {
+      table[i] = i * n;
+      i = i + 1;
+    }
+  return table[7];
+}
+
+int reached(int n)
+{
+  used = n + 1;
+  return fill(n);
+}
+
+void main(void)
+{
+  int n;
+
+  n = input();
+  output(reached(n)); /* 28 */
+  output(used); /* 5 */
+  output(table[3]); /* 12 */
+}
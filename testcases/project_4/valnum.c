@@ -0,0 +1,97 @@
+/* value numbering: repeated subexpressions and array
+ * loads are computed once, but not across stores to the
+ * same array, calls that may change it, or assignments
+ * to their operands. Arguments of one call may share
+ * a subexpression with each other. input: 4 3
+ */
+int g;
+int m[64];
+int acc;
+
+void mix(int a, int b, int c)
+{
+  acc = acc * 7 + a * 3 + b * 5 + c;
+}
+
+int touch(int a[], int k)
+{
+  a[k] = a[k] + 100;
+  g = g + 1;
+  return k;
+}
+
+void main(void)
+{
+  int i;
+  int j;
+  int n;
+  int s;
+  int x;
+  int y;
+
+  n = input();
+  i = 0;
+  while (i < n)
+    {
+      j = 0;
+      while (j < n)
+        {
+          m[i * 4 + j] = i * 4 + j + m[i * 4 + j];
+          m[i * 4 + j] = m[i * 4 + j] + m[i * 4 + j + 1];
+          j = j + 1;
+        }
+      i = i + 1;
+    }
+  s = 0;
+  i = 0;
+  while (i < 16)
+    {
+      s = s + m[i] * (i + 1);
+      i = i + 1;
+    }
+  output(s); /* 1360 */
+
+  x = m[3] + m[5];
+  m[5] = 7;
+  y = m[3] + m[5];
+  output(x); /* 8 */
+  output(y); /* 10 */
+
+  x = m[2] + g;
+  touch(m, 2);
+  y = m[2] + g;
+  output(x); /* 2 */
+  output(y); /* 103 */
+
+  i = input();
+  x = i * i + 3;
+  if (x > 10)
+    {
+      i = i + 1;
+      y = i * i + 3;
+    }
+  else
+    {
+      y = i * i + 3;
+    }
+  output(x); /* 12 */
+  output(y); /* 19 */
+  y = i * i + 3;
+  output(y); /* 19 */
+
+  j = 0;
+  x = 0;
+  while (j < 3)
+    {
+      x = x + (i * i + 3);
+      i = i + 1;
+      j = j + 1;
+    }
+  output(x); /* 86 */
+  m[i] = x * 2;
+  output(m[i] + m[i]); /* 344 */
+
+  mix(x + y, x * y, x + y);
+  mix(x * y, x + y, x * y);
+  output(acc); /* 1360 */
+}